@@ -330,6 +330,7 @@ void HeliCanvas::setRecordsTimeSpan(int span) {
 
 	_records = new RingBuffer(recordsTimeSpan());
 	_filteredRecords = new RingBuffer(recordsTimeSpan());
+	_pyramid.clear();
 }
 
 
@@ -469,6 +470,8 @@ void HeliCanvas::render(QPainter &p) {
 	remainingGap = yGap;
 	rowPos = rowHeight;
 
+	_pyramid.update(_filteredRecords);
+
 	for ( int i = 0; i < _rows.size(); ++i, rowPos += rowHeight + heightOfs ) {
 		QColor gapColor = _gaps[i % 2];
 
@@ -484,7 +487,8 @@ void HeliCanvas::render(QPainter &p) {
 			_rows[i].polyline->create(_filteredRecords,
 			                          tw.startTime(), tw.endTime(),
 			                          (double)recordWidth / (double)_rowTimeSpan,
-			                          _amplitudeRange[0], _amplitudeRange[1], ofs, rowHeight);
+			                          _amplitudeRange[0], _amplitudeRange[1], ofs, rowHeight,
+			                          NULL, NULL, true, &_pyramid);
 			_rows[i].polyline->translate(_labelMargin, 0);
 			_rows[i].dirty = false;
 		}
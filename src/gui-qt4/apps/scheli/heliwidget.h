@@ -84,6 +84,7 @@ class HeliCanvas {
 		Filter                   *_filter;
 		Seiscomp::RecordSequence *_records;
 		Seiscomp::RecordSequence *_filteredRecords;
+		Seiscomp::Gui::RecordPyramid _pyramid;
 		int                       _recordsTimeSpan;
 		int                       _rowTimeSpan;
 		QVector<Row>              _rows;
@@ -31,6 +31,8 @@ class TraceViewApp : public Kicker<Seiscomp::Applications::TraceView::MainWindow
 			_automaticResort = true;
 			_showPicks = true;
 			_inventoryEnabled = true;
+			_incrementalRendering = false;
+			_renderStatistics = false;
 			_maxDelay = 0;
 		}
 
@@ -88,6 +90,16 @@ class TraceViewApp : public Kicker<Seiscomp::Applications::TraceView::MainWindow
 			}
 			catch ( ... ) {}
 
+			try {
+				_incrementalRendering = configGetBool("incrementalRendering");
+			}
+			catch ( ... ) {}
+
+			try {
+				_renderStatistics = configGetBool("renderStatistics");
+			}
+			catch ( ... ) {}
+
 			std::vector<std::string> unnamedOptions;
 			unnamedOptions = commandline().unrecognizedOptions();
 			bool hasPositionals = false;
@@ -168,6 +180,8 @@ class TraceViewApp : public Kicker<Seiscomp::Applications::TraceView::MainWindow
 			w->setAutomaticSortEnabled(_automaticResort);
 			w->setShowPicks(_showPicks);
 			w->setInventoryEnabled(_inventoryEnabled);
+			w->setIncrementalRenderingEnabled(_incrementalRendering);
+			w->setRenderStatisticsVisible(_renderStatistics);
 			w->start();
 			w->setFiltersByName(_filterNames);
 		}
@@ -180,6 +194,8 @@ class TraceViewApp : public Kicker<Seiscomp::Applications::TraceView::MainWindow
 		bool _automaticResort;
 		bool _showPicks;
 		bool _inventoryEnabled;
+		bool _incrementalRendering;
+		bool _renderStatistics;
 		size_t _bufferSize;
 };
 
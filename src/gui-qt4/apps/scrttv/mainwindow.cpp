@@ -396,6 +396,8 @@ MainWindow::MainWindow() : _questionApplyChanges(this) {
 
 	_statusBarSearch->setVisible(false);
 
+	_renderStatistics = NULL;
+
 	_searchBase = _statusBarSearch->palette().color(QPalette::Base);
 	_searchError = Gui::blend(Qt::red, _searchBase, 50);
 
@@ -458,6 +460,7 @@ MainWindow::MainWindow() : _questionApplyChanges(this) {
 
 	_automaticSortEnabled = true;
 	_inventoryEnabled = true;
+	_incrementalRendering = false;
 
 	_switchBack = new QTimer(this);
 	_switchBack->setSingleShot(true);
@@ -655,6 +658,40 @@ void MainWindow::setInventoryEnabled(bool e) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MainWindow::setIncrementalRenderingEnabled(bool e) {
+	_incrementalRendering = e;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MainWindow::setRenderStatisticsVisible(bool e) {
+	if ( !e ) {
+		if ( _renderStatistics ) _renderStatistics->hide();
+		return;
+	}
+
+	if ( _renderStatistics == NULL ) {
+		_renderStatistics = new QLabel(centralWidget());
+		_renderStatistics->setAutoFillBackground(true);
+		_renderStatistics->setAttribute(Qt::WA_TransparentForMouseEvents);
+		QPalette pal = _renderStatistics->palette();
+		pal.setColor(QPalette::Window, QColor(255,255,224));
+		pal.setColor(QPalette::WindowText, Qt::black);
+		_renderStatistics->setPalette(pal);
+	}
+
+	_renderStatistics->show();
+	_renderStatistics->raise();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void MainWindow::setBufferSize(size_t bs) {
 	_bufferSize = bs;
@@ -988,6 +1025,7 @@ void MainWindow::removeTab(int index) {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void MainWindow::setupItem(const Record*, Gui::RecordViewItem* item) {
 	item->label()->setInteractive(false);
+	item->widget()->setIncrementalRenderingEnabled(_incrementalRendering);
 	item->label()->setOrientation(Qt::Horizontal);
 	QFont f(item->label()->font(0));
 	f.setBold(true);
@@ -2136,6 +2174,20 @@ void MainWindow::step() {
 	if ( stepper % 10 == 0 )
 		checkTraceDelay();
 
+	// The timer fires every second so the statistics are per second
+	Gui::RecordWidget::RenderStatistics stats = Gui::RecordWidget::TakeRenderStatistics();
+	if ( _renderStatistics && _renderStatistics->isVisible() ) {
+		_renderStatistics->setText(
+			QString(" %1 repaints/s, %2 ms/repaint, %3 traces created/s, %4 traces appended/s ")
+			.arg(stats.repaints)
+			.arg(stats.repaints ? stats.paintTime*1000 / stats.repaints : 0.0, 0, 'f', 2)
+			.arg(stats.tracesCreated)
+			.arg(stats.tracesAppended));
+		_renderStatistics->adjustSize();
+		_renderStatistics->move(centralWidget()->width() - _renderStatistics->width(), 0);
+		_renderStatistics->raise();
+	}
+
 	++stepper;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
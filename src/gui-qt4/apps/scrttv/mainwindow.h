@@ -145,6 +145,8 @@ class MainWindow : public Seiscomp::Gui::MainWindow {
 		void setShowPicks(bool);
 		void setAutomaticSortEnabled(bool);
 		void setInventoryEnabled(bool);
+		void setIncrementalRenderingEnabled(bool);
+		void setRenderStatisticsVisible(bool);
 
 		void start();
 
@@ -252,6 +254,7 @@ class MainWindow : public Seiscomp::Gui::MainWindow {
 
 		QLabel* _statusBarFile;
 		QLabel* _statusBarFilter;
+		QLabel* _renderStatistics;
 		QLineEdit *_statusBarSearch;
 		Seiscomp::Gui::ProgressBar* _statusBarProg;
 		Seiscomp::Core::Time _endTime;
@@ -262,6 +265,7 @@ class MainWindow : public Seiscomp::Gui::MainWindow {
 
 		bool _automaticSortEnabled;
 		bool _inventoryEnabled;
+		bool _incrementalRendering;
 		int _maxDelay;
 
 		QMap<DataModel::WaveformStreamID, double> _scaleMap;
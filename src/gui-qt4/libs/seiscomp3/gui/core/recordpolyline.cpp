@@ -12,6 +12,7 @@
 
 
 
+#include <algorithm>
 #include <iostream>
 using namespace std;
 
@@ -107,6 +108,60 @@ return; // FIXME doesn't work very well yet
 }
 */
 
+
+// Appends a vertical line starting at the end that is closer to the
+// last point of the polygon
+void appendColumn(QPolygon *poly, int x, int y_top, int y_bottom) {
+	if ( !poly->isEmpty() &&
+	     abs(poly->last().y()-y_bottom) < abs(poly->last().y()-y_top) )
+		std::swap(y_top, y_bottom);
+
+	poly->append(QPoint(x, y_top));
+	if ( y_bottom != y_top )
+		poly->append(QPoint(x, y_bottom));
+}
+
+
+// Appends the envelope of the blocks of a pyramid level that cover the
+// samples [first,first+count) of a record. Blocks starting in the same
+// pixel column are merged.
+void appendEnvelope(QPolygon *poly,
+                    const Seiscomp::Gui::RecordPyramid::Level &level,
+                    int first, int count, float dx, int x0,
+                    int baseline, double yscl, float amplOffset) {
+	int firstBlock = first / level.blockSize;
+	int lastBlock = std::min((first + count - 1) / level.blockSize,
+	                         (int)level.max.size() - 1);
+
+	int x_col = 0, y_top = 0, y_bottom = 0;
+
+	for ( int b = firstBlock; b <= lastBlock; ++b ) {
+		int i = b*level.blockSize - first;
+		if ( i < 0 ) i = 0;
+
+		int x_pos = int(i*dx) - x0;
+		int y_max = int(baseline-yscl*(level.max[b]-amplOffset));
+		int y_min = int(baseline-yscl*(level.min[b]-amplOffset));
+
+		if ( b > firstBlock ) {
+			if ( x_pos == x_col ) {
+				if ( y_max < y_top ) y_top = y_max;
+				if ( y_min > y_bottom ) y_bottom = y_min;
+				continue;
+			}
+
+			appendColumn(poly, x_col, y_top, y_bottom);
+		}
+
+		x_col = x_pos;
+		y_top = y_max;
+		y_bottom = y_min;
+	}
+
+	appendColumn(poly, x_col, y_top, y_bottom);
+}
+
+
 }
 
 
@@ -117,6 +172,13 @@ namespace Gui {
 RecordPolyline::RecordPolyline()
 {
 	_tx = _ty = 0;
+	_baseline = 0;
+	_pixelPerSecond = 0;
+	_yscl = 0;
+	_amplMin = _amplMax = _amplOffset = 0;
+	_optimization = false;
+	_xShift = 0;
+	_createdRecords = _appendedRecords = 0;
 }
 
 void RecordPolyline::translate(int x, int y)
@@ -133,6 +195,8 @@ void RecordPolyline::create(Record const *rec,
                             float amplMin, float amplMax, float amplOffset,
                             int height, float *timingQuality,
                             bool optimization) {
+	_records.clear();
+
 	if (rec == NULL)
 		return;
 
@@ -266,7 +330,35 @@ void RecordPolyline::create(RecordSequence const *records,
                             float amplMin, float amplMax, float amplOffset,
                             int height, float *timingQuality,
                             QVector<QPair<int,int> >* gaps,
-                            bool optimization) {
+                            bool optimization,
+                            const RecordPyramid *pyramid) {
+	createFromSequence(records, pixelPerSecond, amplMin, amplMax, amplOffset,
+	                   height, timingQuality, gaps, optimization, pyramid, false);
+}
+
+
+void RecordPolyline::createAppendable(RecordSequence const *records,
+                                      double pixelPerSecond,
+                                      float amplMin, float amplMax, float amplOffset,
+                                      int height, float *timingQuality,
+                                      QVector<QPair<int,int> >* gaps,
+                                      bool optimization,
+                                      const RecordPyramid *pyramid) {
+	createFromSequence(records, pixelPerSecond, amplMin, amplMax, amplOffset,
+	                   height, timingQuality, gaps, optimization, pyramid, true);
+}
+
+
+void RecordPolyline::createFromSequence(RecordSequence const *records,
+                                        double pixelPerSecond,
+                                        float amplMin, float amplMax, float amplOffset,
+                                        int height, float *timingQuality,
+                                        QVector<QPair<int,int> >* gaps,
+                                        bool optimization,
+                                        const RecordPyramid *pyramid,
+                                        bool appendable) {
+	_records.clear();
+
 	if (records == NULL)
 		return;
 	if (records->size() == 0)
@@ -287,7 +379,7 @@ void RecordPolyline::create(RecordSequence const *records,
 
 	int skipCount = 0;
 	RecordSequence::const_iterator it = records->begin();
-	RecordSequence::const_iterator lastIt = it;
+	const Record *lastRec = NULL;
 
 	/*
 	if ( it != records->end() ) {
@@ -298,153 +390,278 @@ void RecordPolyline::create(RecordSequence const *records,
 
 	clear();
 
-	Seiscomp::Core::Time refTime = (*it)->startTime();
+	_refTime = (*it)->startTime();
+	_pixelPerSecond = pixelPerSecond;
+	_yscl = yscl;
+	_amplMin = amplMin;
+	_amplMax = amplMax;
+	_amplOffset = amplOffset;
+	_optimization = optimization;
+	_xShift = 0;
+	_appendedRecords = 0;
 
-	QPolygon *poly = NULL;
 	int timingQualityRecordCount = 0;
 	if ( timingQuality ) *timingQuality = 0;
 
 	for(; it != records->end(); ++it) {
 		const Record* rec = it->get();
-		const Record* lastRec = lastIt->get();
+
+		if ( appendable ) _records.push_back(*it);
 
 		if ( timingQuality && rec->timingQuality() >= 0 ) {
 			*timingQuality += rec->timingQuality();
 			++timingQualityRecordCount;
 		}
 
-		int nsamp = rec->sampleCount();
-		double tolerance = records->tolerance()/rec->samplingFrequency();
-		double diff;
+		if ( rec->sampleCount() == 0 ) continue;
 
-		if ( nsamp == 0 ) continue;
+		const RecordPyramid::Level *level = NULL;
+		if ( pyramid && optimization )
+			level = pyramid->level(it - records->begin(), rec, rec->samplingFrequency() / pixelPerSecond);
+
+		appendRecord(rec, lastRec, records->tolerance()/rec->samplingFrequency(), level);
+		lastRec = rec;
+	}
+
+	_createdRecords = records->size();
+
+	if ( !empty() ) {
+		if ( skipCount )
+			front().remove(0, skipCount);
+
+		if ( gaps ) {
+			for ( size_t i = 1; i < size(); ++i )
+				gaps->append(QPair<int,int>((*this)[i-1].last().x(), (*this)[i].first().x()));
+		}
+	}
+
+	_tx = _ty = 0;
+
+	if ( timingQuality ) {
+		if ( timingQualityRecordCount )
+			*timingQuality /= timingQualityRecordCount;
+		else
+			*timingQuality = -1;
+	}
+}
+
+
+bool RecordPolyline::append(RecordSequence const *records, bool checkRange,
+                            const RecordPyramid *pyramid) {
+	if ( records == NULL || records->empty() || _records.empty() )
+		return false;
+
+	// Find the records that have been removed from the front and check
+	// that all others are still in place
+	size_t dropped = 0;
+	while ( dropped < _records.size() && _records[dropped] != records->front() )
+		++dropped;
 
+	size_t kept = _records.size() - dropped;
+	if ( kept == 0 || kept > records->size() )
+		return false;
+
+	for ( size_t i = 0; i < kept; ++i ) {
+		if ( _records[dropped+i] != (*records)[i] )
+			return false;
+	}
+
+	size_t added = records->size() - kept;
+
+	// Recreate the polyline once as many records have been appended as
+	// it has been created with to let the amplitude range follow the data
+	if ( _appendedRecords + added > _createdRecords )
+		return false;
+
+	if ( checkRange ) {
+		for ( size_t i = kept; i < records->size(); ++i ) {
+			const Record *rec = (*records)[i].get();
+			const FloatArray *arr = (const FloatArray*)rec->data();
+			if ( arr == NULL ) continue;
+
+			const float *f = arr->typedData();
+			int nsamp = std::min(rec->sampleCount(), arr->size());
+
+			for ( int j = 0; j < nsamp; ++j ) {
+				float v = f[j]-_amplOffset;
+				if ( v < _amplMin || v > _amplMax )
+					return false;
+			}
+		}
+	}
+
+	if ( dropped > 0 ) {
+		_records.erase(_records.begin(), _records.begin() + dropped);
+
+		// Move the origin to the start of the new first record and remove
+		// the points left of it
+		int shift = int(_pixelPerSecond*double(records->front()->startTime()-_refTime));
+		int dx = shift - _xShift;
+		_xShift = shift;
+
+		if ( dx != 0 ) {
+			for ( iterator it = begin(); it != end(); ++it )
+				it->translate(-dx, 0);
+		}
+
+		while ( !empty() && (front().isEmpty() || front().last().x() < 0) )
+			erase(begin());
+
+		if ( !empty() ) {
+			int n = 0;
+			while ( n < front().size() && front()[n].x() < 0 ) ++n;
+			if ( n > 0 ) front().remove(0, n);
+		}
+	}
+
+	const Record *lastRec = NULL;
+	for ( std::deque<RecordCPtr>::reverse_iterator it = _records.rbegin();
+	      it != _records.rend(); ++it ) {
+		if ( (*it)->sampleCount() > 0 ) {
+			lastRec = it->get();
+			break;
+		}
+	}
+
+	for ( size_t i = kept; i < records->size(); ++i ) {
+		const Record *rec = (*records)[i].get();
+
+		_records.push_back((*records)[i]);
+		++_appendedRecords;
+
+		if ( rec->sampleCount() == 0 ) continue;
+
+		const RecordPyramid::Level *level = NULL;
+		if ( pyramid && _optimization )
+			level = pyramid->level(i, rec, rec->samplingFrequency() / _pixelPerSecond);
+
+		appendRecord(rec, lastRec, records->tolerance()/rec->samplingFrequency(), level);
+		lastRec = rec;
+	}
+
+	return true;
+}
+
+
+void RecordPolyline::appendRecord(const Record *rec, const Record *lastRec,
+                                  double tolerance,
+                                  const RecordPyramid::Level *level) {
+	int nsamp = rec->sampleCount();
+	double diff;
+
+	if ( lastRec == NULL )
+		diff = tolerance*2;
+	else {
 		try {
 			diff = abs(double(rec->startTime() - lastRec->endTime()));
 		}
 		catch ( ... ) {
 			diff = tolerance*2;
 		}
+	}
 
-		if ( diff > tolerance || poly == NULL ) {
-			push_back(QPolygon());
-			poly = &back();
-		}
-
-		const FloatArray *arr = (const FloatArray*)rec->data();
-
-		float *f = (float*)arr->data();
-		int x0 = int(pixelPerSecond*double(/*referenceTime*/refTime-rec->startTime()));
-		float dx = pixelPerSecond / rec->samplingFrequency();
+	if ( diff > tolerance || empty() )
+		push_back(QPolygon());
 
-		int x_prev = -x0;
-		int y_prev = int(_baseline-yscl*(f[0]-amplOffset));
-		int y_min = y_prev;
-		int y_max = y_prev;
+	QPolygon *poly = &back();
 
-		int x_out = x_prev;
-		int y_out = y_prev;
+	const FloatArray *arr = (const FloatArray*)rec->data();
 
-		poly->append(QPoint(x_prev, y_prev));
+	float *f = (float*)arr->data();
+	int x0 = int(_pixelPerSecond*double(/*referenceTime*/_refTime-rec->startTime())) + _xShift;
+	float dx = _pixelPerSecond / rec->samplingFrequency();
 
-		if ( optimization ) {
-			for (int i = 1; i<nsamp; i++) {
-				int x_pos = int(i*dx) - x0;
-				int y_pos = int(_baseline-yscl*(f[i]-amplOffset));
+	if ( level ) {
+		appendEnvelope(poly, *level, 0, nsamp, dx, x0, _baseline, _yscl, _amplOffset);
+		return;
+	}
 
-				if ( y_pos != y_out ) {
-					// last output differs from the last sample?
-					if ( x_out != x_prev  ) {
-						x_out = x_prev;
-						poly->append(QPoint(x_out, y_out));
-					}
+	int x_prev = -x0;
+	int y_prev = int(_baseline-_yscl*(f[0]-_amplOffset));
+	int y_min = y_prev;
+	int y_max = y_prev;
 
-					// last output differs from the current draw position?
-					if ( x_out != x_pos ) {
-						if ( y_min != y_out ) {
-							y_out = y_min;
-							poly->append(QPoint(x_out, y_out));
-						}
-						if ( y_max != y_out ) {
-							y_out = y_max;
-							poly->append(QPoint(x_out, y_out));
-						}
-						if ( y_prev != y_out ) {
-							y_out = y_prev;
-							poly->append(QPoint(x_out, y_out));
-						}
+	int x_out = x_prev;
+	int y_out = y_prev;
 
-						x_out = x_pos;
+	poly->append(QPoint(x_prev, y_prev));
 
-						if ( y_pos != y_out ) {
-							y_out = y_pos;
-							poly->append(QPoint(x_out, y_pos));
-						}
+	if ( _optimization ) {
+		for (int i = 1; i<nsamp; i++) {
+			int x_pos = int(i*dx) - x0;
+			int y_pos = int(_baseline-_yscl*(f[i]-_amplOffset));
 
-						y_min = y_max = y_out;
-					}
-					else {
-						// update y min/max range
-						if ( y_pos < y_min ) y_min = y_pos;
-						else if ( y_pos > y_max ) y_max = y_pos;
-					}
+			if ( y_pos != y_out ) {
+				// last output differs from the last sample?
+				if ( x_out != x_prev  ) {
+					x_out = x_prev;
+					poly->append(QPoint(x_out, y_out));
 				}
-				else {
+
+				// last output differs from the current draw position?
+				if ( x_out != x_pos ) {
 					if ( y_min != y_out ) {
 						y_out = y_min;
 						poly->append(QPoint(x_out, y_out));
-						y_min = y_out;
 					}
 					if ( y_max != y_out ) {
 						y_out = y_max;
 						poly->append(QPoint(x_out, y_out));
-						y_max = y_out;
 					}
 					if ( y_prev != y_out ) {
-						y_out = y_min = y_max = y_prev;
+						y_out = y_prev;
 						poly->append(QPoint(x_out, y_out));
 					}
-				}
 
-				x_prev = x_pos;
-				y_prev = y_pos;
-			}
+					x_out = x_pos;
 
-			if ( x_out != x_prev )
-				poly->append(QPoint(x_prev, y_prev));
-		}
-		else {
-			for (int i = 1; i<nsamp; i++) {
-				int x_pos = int(i*dx) - x0;
-				int y_pos = int(_baseline-yscl*(f[i]-amplOffset));
-				poly->append(QPoint(x_pos, y_pos));
+					if ( y_pos != y_out ) {
+						y_out = y_pos;
+						poly->append(QPoint(x_out, y_pos));
+					}
+
+					y_min = y_max = y_out;
+				}
+				else {
+					// update y min/max range
+					if ( y_pos < y_min ) y_min = y_pos;
+					else if ( y_pos > y_max ) y_max = y_pos;
+				}
+			}
+			else {
+				if ( y_min != y_out ) {
+					y_out = y_min;
+					poly->append(QPoint(x_out, y_out));
+					y_min = y_out;
+				}
+				if ( y_max != y_out ) {
+					y_out = y_max;
+					poly->append(QPoint(x_out, y_out));
+					y_max = y_out;
+				}
+				if ( y_prev != y_out ) {
+					y_out = y_min = y_max = y_prev;
+					poly->append(QPoint(x_out, y_out));
+				}
 			}
-		}
 
-		if ( poly->isEmpty() )
-			pop_back();
+			x_prev = x_pos;
+			y_prev = y_pos;
+		}
 
-		lastIt = it;
+		if ( x_out != x_prev )
+			poly->append(QPoint(x_prev, y_prev));
 	}
-
-	if ( !empty() ) {
-		if ( skipCount )
-			front().remove(0, skipCount);
-
-		if ( gaps ) {
-			for ( size_t i = 1; i < size(); ++i )
-				gaps->append(QPair<int,int>((*this)[i-1].last().x(), (*this)[i].first().x()));
+	else {
+		for (int i = 1; i<nsamp; i++) {
+			int x_pos = int(i*dx) - x0;
+			int y_pos = int(_baseline-_yscl*(f[i]-_amplOffset));
+			poly->append(QPoint(x_pos, y_pos));
 		}
 	}
 
-	_tx = _ty = 0;
-
-	if ( timingQuality ) {
-		if ( timingQualityRecordCount )
-			*timingQuality /= timingQualityRecordCount;
-		else
-			*timingQuality = -1;
-	}
+	if ( poly->isEmpty() )
+		pop_back();
 }
 
 
@@ -455,8 +672,10 @@ void RecordPolyline::create(RecordSequence const *records,
                             float amplMin, float amplMax, float amplOffset,
                             int height, float *timingQuality,
                             QVector<QPair<int,int> >* gaps,
-                            bool optimization) {
+                            bool optimization,
+                            const RecordPyramid *pyramid) {
 	clear();
+	_records.clear();
 
 	if ( records == NULL )
 		return;
@@ -525,10 +744,11 @@ void RecordPolyline::create(RecordSequence const *records,
 		float *f = (float*)arr->data();
 		double startOfs = double(start-rec->startTime());
 		double endOfs = double(rec->endTime()-end);
+		int sampleOfs = 0;
 
 		// Cut front samples
 		if ( startOfs > 0 ) {
-			int sampleOfs = (int)(startOfs * rec->samplingFrequency());
+			sampleOfs = (int)(startOfs * rec->samplingFrequency());
 			if ( sampleOfs >= nsamp ) continue;
 			f += sampleOfs;
 			nsamp -= sampleOfs;
@@ -544,6 +764,16 @@ void RecordPolyline::create(RecordSequence const *records,
 		int x0 = int(pixelPerSecond*startOfs);
 		float dx = pixelPerSecond / rec->samplingFrequency();
 
+		const RecordPyramid::Level *level = NULL;
+		if ( pyramid && optimization )
+			level = pyramid->level(it - records->begin(), rec, rec->samplingFrequency() / pixelPerSecond);
+
+		if ( level ) {
+			appendEnvelope(poly, *level, sampleOfs, nsamp, dx, x0, _baseline, yscl, amplOffset);
+			lastIt = it;
+			continue;
+		}
+
 		int x_prev = -x0;
 		int y_prev = int(_baseline-yscl*(f[0]-amplOffset));
 		int y_min = y_prev;
@@ -697,6 +927,7 @@ void RecordPolyline::createStepFunction(RecordSequence const *records, double pi
                                         float amplMin, float amplMax, float amplOffset,
                                         int height, float multiplier) {
 	clear();
+	_records.clear();
 
 	if (records == NULL) return;
 	if (records->size() == 0) return;
@@ -765,6 +996,7 @@ void RecordPolyline::createSteps(RecordSequence const *records, double pixelPerS
                                  float amplMin, float amplMax, float amplOffset,
                                  int height, QVector<QPair<int,int> >* gaps) {
 	clear();
+	_records.clear();
 
 	if (records == NULL) return;
 	if (records->size() == 0) return;
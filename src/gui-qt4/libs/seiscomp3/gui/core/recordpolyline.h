@@ -15,6 +15,7 @@
 #ifndef _RECORDPOLYLINE_H_
 #define _RECORDPOLYLINE_H_
 
+#include <deque>
 #include <vector>
 
 #include <QPen>
@@ -27,6 +28,7 @@
 #include <seiscomp3/core/recordsequence.h>
 #endif
 #include <seiscomp3/gui/qt4.h>
+#include <seiscomp3/gui/core/recordpyramid.h>
 
 
 namespace Seiscomp {
@@ -52,12 +54,35 @@ class SC_GUI_API RecordPolyline : public std::vector<QPolygon>
 	            bool optimization = true);
 
 	//! creates the record polyline and returns the virtual height
-	//! of that polyline
+	//! of that polyline. If a pyramid synchronized with the sequence
+	//! is passed and optimization is enabled, records with more than
+	//! one sample per pixel are drawn from their min/max envelopes.
 	void create(RecordSequence const *, double pixelPerSecond,
 	            float amplMin, float amplMax, float amplOffset,
 	            int height, float *timingQuality = NULL,
 	            QVector<QPair<int,int> >* gaps = NULL,
-	            bool optimization = true);
+	            bool optimization = true,
+	            const RecordPyramid *pyramid = NULL);
+
+	//! creates the record polyline like create() but keeps references
+	//! to the records of the sequence so that append() can extend it
+	//! later. Records removed from the sequence stay referenced until the
+	//! next call to append() or create().
+	void createAppendable(RecordSequence const *, double pixelPerSecond,
+	                      float amplMin, float amplMax, float amplOffset,
+	                      int height, float *timingQuality = NULL,
+	                      QVector<QPair<int,int> >* gaps = NULL,
+	                      bool optimization = true,
+	                      const RecordPyramid *pyramid = NULL);
+
+	//! appends the records fed to the sequence since the polyline has
+	//! been created from it with createAppendable().
+	//! Records removed from the front are cut from the polyline. If
+	//! checkRange is set and a new sample exceeds the amplitude range,
+	//! nothing is changed. Returns false if the polyline needs to be
+	//! created again.
+	bool append(RecordSequence const *, bool checkRange = true,
+	            const RecordPyramid *pyramid = NULL);
 
 	void create(RecordSequence const *,
 	            const Core::Time &start,
@@ -66,7 +91,8 @@ class SC_GUI_API RecordPolyline : public std::vector<QPolygon>
 	            float amplMin, float amplMax, float amplOffset,
 	            int height, float *timingQuality = NULL,
 	            QVector<QPair<int,int> >* gaps = NULL,
-	            bool optimization = true);
+	            bool optimization = true,
+	            const RecordPyramid *pyramid = NULL);
 
 	void createStepFunction(RecordSequence const *, double pixelPerSecond,
 	                        float amplMin, float amplMax, float amplOffset,
@@ -82,9 +108,34 @@ class SC_GUI_API RecordPolyline : public std::vector<QPolygon>
 
 	int baseline() const;
 
+  private:
+	void createFromSequence(RecordSequence const *, double pixelPerSecond,
+	                        float amplMin, float amplMax, float amplOffset,
+	                        int height, float *timingQuality,
+	                        QVector<QPair<int,int> >* gaps,
+	                        bool optimization,
+	                        const RecordPyramid *pyramid,
+	                        bool appendable);
+
+	void appendRecord(const Record *rec, const Record *lastRec, double tolerance,
+	                  const RecordPyramid::Level *level);
+
   private:
 	int _tx, _ty;
 	int _baseline;
+
+	// State of the last createAppendable call used by append
+	std::deque<RecordCPtr> _records;
+	Core::Time             _refTime;
+	double                 _pixelPerSecond;
+	double                 _yscl;
+	float                  _amplMin;
+	float                  _amplMax;
+	float                  _amplOffset;
+	bool                   _optimization;
+	int                    _xShift;
+	size_t                 _createdRecords;
+	size_t                 _appendedRecords;
 };
 
 
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+
+#include <algorithm>
+#include <map>
+
+#include <seiscomp3/core/typedarray.h>
+
+#include "recordpyramid.h"
+
+
+namespace Seiscomp {
+namespace Gui {
+
+
+RecordPyramid::RecordPyramid() {}
+
+
+void RecordPyramid::update(const RecordSequence *seq) {
+	if ( seq == NULL || seq->empty() ) {
+		clear();
+		return;
+	}
+
+	// Ring and time window buffers remove records from the front and
+	// usually append new records at the back. Check if the entries
+	// starting with the first record of the sequence are still a prefix
+	// of it.
+	size_t front = 0;
+	while ( front < _entries.size() && _entries[front].record != seq->front() )
+		++front;
+
+	bool prefix = front < _entries.size() || _entries.empty();
+	size_t kept = _entries.size() - front;
+
+	if ( kept > seq->size() ) prefix = false;
+
+	for ( size_t i = 0; prefix && i < kept; ++i ) {
+		if ( _entries[front+i].record != (*seq)[i] )
+			prefix = false;
+	}
+
+	if ( prefix ) {
+		_entries.erase(_entries.begin(), _entries.begin() + front);
+
+		for ( size_t i = kept; i < seq->size(); ++i ) {
+			_entries.push_back(Entry());
+			_entries.back().record = (*seq)[i];
+			build(_entries.back());
+		}
+
+		return;
+	}
+
+	// A record has been inserted in between or the sequence has been
+	// replaced: rebuild the entries but keep the levels already computed
+	std::map<const Record*, size_t> index;
+	for ( size_t i = 0; i < _entries.size(); ++i )
+		index[_entries[i].record.get()] = i;
+
+	Entries entries;
+	for ( RecordSequence::const_iterator it = seq->begin(); it != seq->end(); ++it ) {
+		entries.push_back(Entry());
+		Entry &entry = entries.back();
+		entry.record = *it;
+
+		std::map<const Record*, size_t>::iterator idx = index.find(it->get());
+		if ( idx != index.end() )
+			entry.levels.swap(_entries[idx->second].levels);
+		else
+			build(entry);
+	}
+
+	_entries.swap(entries);
+}
+
+
+void RecordPyramid::clear() {
+	_entries.clear();
+}
+
+
+const RecordPyramid::Level *
+RecordPyramid::level(size_t index, const Record *rec, double samplesPerPixel) const {
+	if ( index >= _entries.size() ) return NULL;
+
+	const Entry &entry = _entries[index];
+	if ( entry.record.get() != rec ) return NULL;
+
+	for ( std::vector<Level>::const_reverse_iterator it = entry.levels.rbegin();
+	      it != entry.levels.rend(); ++it ) {
+		if ( it->blockSize*2 <= samplesPerPixel )
+			return &*it;
+	}
+
+	return NULL;
+}
+
+
+void RecordPyramid::build(Entry &entry) {
+	const Record *rec = entry.record.get();
+	const Array *data = rec->data();
+
+	entry.levels.clear();
+
+	if ( data == NULL || data->dataType() != Array::FLOAT ) return;
+
+	const FloatArray *arr = static_cast<const FloatArray*>(data);
+	int nsamp = std::min(rec->sampleCount(), arr->size());
+
+	// Short records are cheaper to draw sample by sample
+	if ( nsamp < BaseBlockSize*2 ) return;
+
+	const float *f = arr->typedData();
+	int blocks = (nsamp + BaseBlockSize - 1) / BaseBlockSize;
+
+	int levelCount = 1;
+	for ( int n = blocks; n > 1; n = (n + Factor - 1) / Factor )
+		++levelCount;
+
+	entry.levels.reserve(levelCount);
+	entry.levels.push_back(Level());
+	Level *level = &entry.levels.back();
+	level->blockSize = BaseBlockSize;
+	level->min.resize(blocks);
+	level->max.resize(blocks);
+
+	for ( int b = 0; b < blocks; ++b ) {
+		int i = b*BaseBlockSize;
+		int end = std::min(i + (int)BaseBlockSize, nsamp);
+		float vmin = f[i], vmax = f[i];
+
+		for ( ++i; i < end; ++i ) {
+			if ( f[i] < vmin ) vmin = f[i];
+			else if ( f[i] > vmax ) vmax = f[i];
+		}
+
+		level->min[b] = vmin;
+		level->max[b] = vmax;
+	}
+
+	while ( blocks > 1 ) {
+		int coarseBlocks = (blocks + Factor - 1) / Factor;
+
+		entry.levels.push_back(Level());
+		const Level &fine = entry.levels[entry.levels.size()-2];
+		level = &entry.levels.back();
+		level->blockSize = fine.blockSize*Factor;
+		level->min.resize(coarseBlocks);
+		level->max.resize(coarseBlocks);
+
+		for ( int b = 0; b < coarseBlocks; ++b ) {
+			int i = b*Factor;
+			int end = std::min(i + (int)Factor, blocks);
+			float vmin = fine.min[i], vmax = fine.max[i];
+
+			for ( ++i; i < end; ++i ) {
+				if ( fine.min[i] < vmin ) vmin = fine.min[i];
+				if ( fine.max[i] > vmax ) vmax = fine.max[i];
+			}
+
+			level->min[b] = vmin;
+			level->max[b] = vmax;
+		}
+
+		blocks = coarseBlocks;
+	}
+}
+
+
+}
+}
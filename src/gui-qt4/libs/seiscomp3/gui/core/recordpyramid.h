@@ -0,0 +1,100 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+
+#ifndef _RECORDPYRAMID_H_
+#define _RECORDPYRAMID_H_
+
+#include <deque>
+#include <vector>
+
+#ifndef Q_MOC_RUN
+#include <seiscomp3/core/record.h>
+#include <seiscomp3/core/recordsequence.h>
+#endif
+#include <seiscomp3/gui/qt4.h>
+
+
+namespace Seiscomp {
+namespace Gui {
+
+
+/**
+ * \brief Min/max envelopes of the records of a RecordSequence
+ *
+ * For each record the minimum and maximum of blocks of BaseBlockSize
+ * samples are stored. Each further level combines Factor blocks of the
+ * previous level until a single block covers the whole record. The
+ * envelopes of a record are computed once when update() sees it for the
+ * first time, records removed from the sequence are dropped.
+ *
+ * The pyramid only holds references to the records. update() must be
+ * called with the sequence before it is passed to RecordPolyline::create
+ * otherwise the levels are ignored.
+ */
+class SC_GUI_API RecordPyramid {
+	public:
+		enum {
+			BaseBlockSize = 16,
+			Factor = 8
+		};
+
+		struct Level {
+			int                blockSize;
+			std::vector<float> min;
+			std::vector<float> max;
+		};
+
+
+	public:
+		RecordPyramid();
+
+		//! Synchronizes the pyramid with a sequence
+		void update(const RecordSequence *seq);
+
+		//! Removes all entries
+		void clear();
+
+		//! Returns the number of records covered
+		size_t size() const { return _entries.size(); }
+
+		/**
+		 * Returns the coarsest level of the record at index whose blocks
+		 * are not larger than half of samplesPerPixel. NULL is returned if
+		 * no such level exists or if the entry does not belong to rec.
+		 */
+		const Level *level(size_t index, const Record *rec,
+		                   double samplesPerPixel) const;
+
+
+	private:
+		struct Entry {
+			RecordCPtr         record;
+			std::vector<Level> levels;
+		};
+
+		typedef std::deque<Entry> Entries;
+
+		static void build(Entry &entry);
+
+
+	private:
+		Entries _entries;
+};
+
+
+}
+}
+
+
+# endif
@@ -20,6 +20,7 @@
 #include <seiscomp3/logging/log.h>
 #include <seiscomp3/math/math.h>
 #include <seiscomp3/math/filter/butterworth.h>
+#include <seiscomp3/utils/timer.h>
 #include <seiscomp3/gui/core/application.h>
 
 using namespace std;
@@ -607,10 +608,12 @@ RecordWidgetDecorator::RecordWidgetDecorator(QObject *parent)
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 static int StreamCount = 0;
 static int RecordWidgetCount = 0;
+static RecordWidget::RenderStatistics RenderStats;
 
 RecordWidget::Stream::Stream(bool owner) {
 	records[0] = records[1] = NULL;
 	traces[0].dirty = traces[1].dirty = false;
+	traces[0].recreate = traces[1].recreate = true;
 	traces[0].timingQuality = traces[1].timingQuality = -1;
 	traces[0].timingQualityCount = traces[1].timingQualityCount = 0;
 	filter = NULL;
@@ -650,6 +653,8 @@ void RecordWidget::Stream::setDirty() {
 
 	traces[Stream::Raw].dirty = true;
 	traces[Stream::Filtered].dirty = true;
+	traces[Stream::Raw].recreate = true;
+	traces[Stream::Filtered].recreate = true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -668,6 +673,9 @@ void RecordWidget::Stream::free() {
 	traces[0].poly.clear();
 	traces[1].poly.clear();
 
+	pyramids[0].clear();
+	pyramids[1].clear();
+
 	traces[0].timingQuality = -1;
 	traces[0].timingQualityCount = 0;
 
@@ -747,6 +755,7 @@ void RecordWidget::init() {
 	_showAllRecords = false;
 	_showScaledValues = false;
 	_autoMaxScale = false;
+	_incrementalRendering = false;
 	_useGlobalOffset = false;
 
 	_activeMarker = NULL;
@@ -1761,6 +1770,8 @@ void RecordWidget::drawRecords(Stream *s, int slot, int h) {
 	//Core::TimeWindow tw(leftTime(), rightTime());
 	float magnify = 1; // or 0.2 etc.
 
+	++RenderStats.tracesCreated;
+
 	if ( _amplScale > 0 )
 		magnify = 1.0/_amplScale;
 
@@ -1801,6 +1812,7 @@ void RecordWidget::drawRecords(Stream *s, int slot, int h) {
 		trace->yMin = int(trace->poly.baseline() * (1-_amplScale));
 		trace->yMax = trace->yMin + int(h * _amplScale);
 		trace->dirty = false;
+		trace->recreate = false;
 	}
 	else {
 		trace->fyMin = -1;
@@ -1842,6 +1854,7 @@ void RecordWidget::drawRecords(Stream *s, int slot, int h) {
 		trace->yMin = int(trace->poly.baseline() * (1-_amplScale));
 		trace->yMax = trace->yMin + int(h * _amplScale);
 		trace->dirty = false;
+		trace->recreate = false;
 	}
 	else {
 		trace->fyMin = -1;
@@ -1881,15 +1894,78 @@ void RecordWidget::drawRecords(Stream *s, int slot, int h) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+// Appends the records fed since the last drawRecords call to the dirty
+// traces. Returns false if the traces need to be drawn again.
+bool RecordWidget::appendRecords(Stream *s) {
+	if ( !_incrementalRendering || s->stepFunction ) return false;
+
+	bool shown[2];
+	shown[Stream::Raw] = !s->filtering || _showAllRecords;
+	shown[Stream::Filtered] = s->filtering || _showAllRecords;
+
+	bool appended[2] = {false, false};
+
+	for ( int i = 0; i < 2; ++i ) {
+		Trace *trace = &s->traces[i];
+		RecordSequence *seq = s->records[i];
+		if ( seq == NULL || !shown[i] || !trace->dirty ) continue;
+		// Scale, size or amplitude range changed since the last draw
+		if ( trace->recreate ) return false;
+
+		RecordPyramid *pyramid = NULL;
+		if ( s->optimize ) {
+			pyramid = &s->pyramids[i];
+			pyramid->update(seq);
+		}
+
+		if ( !trace->poly.append(seq, !_useFixedAmplitudeRange, pyramid) )
+			return false;
+
+		appended[i] = true;
+	}
+
+	if ( !appended[0] && !appended[1] ) return false;
+
+	for ( int i = 0; i < 2; ++i )
+		if ( appended[i] ) s->traces[i].dirty = false;
+
+	++RenderStats.tracesAppended;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void RecordWidget::createPolyline(int slot, RecordPolyline &polyline,
                                   RecordSequence const *seq, double pixelPerSecond,
                                   float amplMin, float amplMax, float amplOffset,
                                   int height, bool optimization) {
-	if ( _streams[slot]->stepFunction )
+	Stream *s = _streams[slot];
+
+	if ( s->stepFunction ) {
 		polyline.createSteps(seq, pixelPerSecond, amplMin, amplMax, amplOffset, height);
+		return;
+	}
+
+	// The pyramid of a sequence is updated lazily with the records
+	// that arrived since the last call
+	RecordPyramid *pyramid = NULL;
+	if ( optimization ) {
+		if ( seq == s->records[Stream::Raw] )
+			pyramid = &s->pyramids[Stream::Raw];
+		else if ( seq == s->records[Stream::Filtered] )
+			pyramid = &s->pyramids[Stream::Filtered];
+
+		if ( pyramid ) pyramid->update(seq);
+	}
+
+	if ( _incrementalRendering )
+		polyline.createAppendable(seq, pixelPerSecond, amplMin, amplMax, amplOffset, height, NULL, NULL, optimization, pyramid);
 	else
-		polyline.create(seq, pixelPerSecond, amplMin, amplMax, amplOffset, height, NULL, NULL, optimization);
+		polyline.create(seq, pixelPerSecond, amplMin, amplMax, amplOffset, height, NULL, NULL, optimization, pyramid);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -2064,6 +2140,7 @@ void RecordWidget::paintEvent(QPaintEvent *event) {
 	if ( h == 0 || w == 0 )
 		return; // actually this must never happen
 
+	Util::StopWatch paintTimer;
 	QPainter painter(this);
 
 	QRect rect = event->rect();
@@ -2131,8 +2208,10 @@ void RecordWidget::paintEvent(QPaintEvent *event) {
 
 				if ( (stream->records[Stream::Filtered] && (stream->filtering || _showAllRecords) && stream->traces[Stream::Filtered].dirty) ||
 					(stream->records[Stream::Raw] && (!stream->filtering || _showAllRecords) && stream->traces[Stream::Raw].dirty) ) {
-					prepareRecords(stream);
-					drawRecords(stream, _currentSlot, stream->height);
+					if ( !appendRecords(stream) ) {
+						prepareRecords(stream);
+						drawRecords(stream, _currentSlot, stream->height);
+					}
 					emitUpdated = true;
 				}
 			}
@@ -2168,8 +2247,10 @@ void RecordWidget::paintEvent(QPaintEvent *event) {
 
 				if ( (stream->records[Stream::Filtered] && (stream->filtering || _showAllRecords) && stream->traces[Stream::Filtered].dirty) ||
 					(stream->records[Stream::Raw] && (!stream->filtering || _showAllRecords) && stream->traces[Stream::Raw].dirty) ) {
-					prepareRecords(stream);
-					drawRecords(stream, slot, stream->height);
+					if ( !appendRecords(stream) ) {
+						prepareRecords(stream);
+						drawRecords(stream, slot, stream->height);
+					}
 					emitUpdated = true;
 				}
 
@@ -2879,6 +2960,9 @@ void RecordWidget::paintEvent(QPaintEvent *event) {
 
 	if ( _decorator ) _decorator->drawDecoration(&painter, this);
 
+	++RenderStats.repaints;
+	RenderStats.paintTime += (double)paintTimer.elapsed();
+
 	if ( emitUpdated ) emit traceUpdated(this);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -3298,6 +3382,29 @@ void RecordWidget::setAutoMaxScale(bool e) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void RecordWidget::setIncrementalRenderingEnabled(bool enable) {
+	if ( _incrementalRendering == enable ) return;
+	_incrementalRendering = enable;
+	setDirty();
+	update();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+RecordWidget::RenderStatistics RecordWidget::TakeRenderStatistics() {
+	RenderStatistics stats = RenderStats;
+	RenderStats = RenderStatistics();
+	return stats;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void RecordWidget::setNormalizationWindow(const Seiscomp::Core::TimeWindow &tw) {
 	_normalizationWindow = tw;
@@ -3399,6 +3506,7 @@ void RecordWidget::filterRecords(Stream *s) {
 		if ( rec ) {
 			s->records[Stream::Filtered]->feed(rec.get());
 			s->traces[Stream::Filtered].dirty = true;
+			s->traces[Stream::Filtered].recreate = true;
 			lastRec = rec;
 		}
 	}
@@ -226,6 +226,9 @@ class SC_GUI_API RecordWidget : public QWidget
 			float          timingQuality;
 			int            timingQualityCount;
 			bool           dirty;
+			//! Set if the view changed and the polyline must be created
+			//! again instead of appending new records
+			bool           recreate;
 			bool           visible;
 			RecordPolyline poly;
 
@@ -237,6 +240,17 @@ class SC_GUI_API RecordWidget : public QWidget
 			}
 		};
 
+		//! Paint statistics of all record widgets
+		struct RenderStatistics {
+			RenderStatistics()
+			: repaints(0), paintTime(0), tracesCreated(0), tracesAppended(0) {}
+
+			int    repaints;
+			double paintTime; //!< Accumulated time in paintEvent in seconds
+			int    tracesCreated;
+			int    tracesAppended;
+		};
+
 	public:
 		RecordWidget(QWidget *parent=0);
 		RecordWidget(const DataModel::WaveformStreamID& streamID, QWidget *parent=0);
@@ -292,6 +306,16 @@ class SC_GUI_API RecordWidget : public QWidget
 		void setDrawRecordID(bool f);
 		bool drawRecordID() const { return _drawRecordID; }
 
+		//! Appends new records to the trace polylines instead of creating
+		//! them again as long as the amplitude range holds. Only used with
+		//! the draw modes Single and InRows.
+		void setIncrementalRenderingEnabled(bool enable);
+		bool isIncrementalRenderingEnabled() const { return _incrementalRendering; }
+
+		//! Returns the statistics collected since the last call and
+		//! resets them
+		static RenderStatistics TakeRenderStatistics();
+
 		void setValuePrecision(int p);
 		int valuePrecision() const { return _valuePrecision; }
 
@@ -619,6 +643,7 @@ class SC_GUI_API RecordWidget : public QWidget
 
 			RecordSequence *records[2];
 			Trace           traces[2];
+			RecordPyramid   pyramids[2];
 			bool            ownRawRecords;
 			bool            ownFilteredRecords;
 			bool            visible;
@@ -657,6 +682,7 @@ class SC_GUI_API RecordWidget : public QWidget
 
 		void prepareRecords(Stream *s);
 		void drawRecords(Stream *s, int slot, int h);
+		bool appendRecords(Stream *s);
 		void centerLine(int l, int h);
 
 
@@ -689,6 +715,7 @@ class SC_GUI_API RecordWidget : public QWidget
 		bool    _drawOffset;
 		bool    _showAllRecords;
 		bool    _autoMaxScale;
+		bool    _incrementalRendering;
 		bool    _enabled;
 		bool    _useGlobalOffset;
 
@@ -27,6 +27,10 @@ using namespace Utilities;
 // CircularBuffer
 //*****************************************************************************
 
+// Every element is stored twice, at its position and one buffer size
+// behind it, so that any range of up to "size" elements starting at a
+// read position is contiguous in memory (see CBIterator::window()).
+
 template<class T>
 class CircularBuffer;
 
@@ -98,6 +102,14 @@ class CBIterator: public iterator<input_iterator_tag, const T>
         rdp = (rdp + n) & mask;
         return *this;
       }
+
+    // Returns the elements starting at the current position as a
+    // contiguous array of at most buffer size elements
+    pointer window() const
+      {
+        if(dataptr == NULL) invalid_iterator(__FILE__, __LINE__);
+        return (dataptr + rdp);
+      }
   };
 
 template<class T>
@@ -115,7 +127,7 @@ class CircularBuffer
     
     CircularBuffer(int size)
       {
-        dataptr = new T[1 << size];
+        dataptr = new T[2 << size];
         mask = (1 << size) - 1;
         wrp = 0;
       }
@@ -143,6 +155,7 @@ class CircularBuffer
     void write(T val)
       {
         dataptr[wrp] = val;
+        dataptr[wrp + mask + 1] = val;
         wrp = (wrp + 1) & mask;
       }
   };
@@ -604,6 +604,8 @@ class Module(TemplateModule):
         self._set_default("connections", "500", False)
         self._set_default("connections_per_ip", "20", False)
         self._set_default("bytespersec", "0", False)
+        self._set_default("io_backend", "select", False)
+        self._set_default("plugin_shm", "false", False)
 
         ## Expand the @Variables@
         if hasSystem:
@@ -662,6 +664,11 @@ class Module(TemplateModule):
         else:
             self._set("window_extraction_trusted", "disabled", False)
 
+        if self._get("plugin_shm", False).lower() == "true":
+            self._set("plugin_shm", "enabled", False)
+        else:
+            self._set("plugin_shm", "disabled", False)
+
         if self._get("request_log", False).lower() == "true":
             self._set("request_log", "enabled", False)
         else:
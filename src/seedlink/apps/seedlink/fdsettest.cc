@@ -0,0 +1,225 @@
+/*****************************************************************************
+ * fdsettest.cc
+ *
+ * Test and benchmark of the select and epoll backends of IOSystem::Fdset
+ *
+ * Usage: testfdset [connections] [active] [rounds]
+ *
+ * Checks read and write readiness, write throttling and descriptor reuse
+ * with both backends. Then polls "connections" socket pairs of which
+ * "active" become readable per round and reports the time per round. The
+ * select backend visits every descriptor after each wakeup like the
+ * connection manager does, the epoll backend only the ready ones. The
+ * select backend is skipped if the descriptors exceed FD_SETSIZE.
+ *
+ * (c) GFZ Potsdam
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any later
+ * version. For more information, see http://www.gnu.org/
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include "libslink.h"
+#include "iosystem.h"
+
+using namespace std;
+using namespace IOSystem;
+
+namespace {
+
+int errors = 0;
+
+void check(bool cond, const char *backend, const char *what)
+  {
+    if(!cond)
+      {
+        cerr << backend << ": " << what << " failed" << endl;
+        ++errors;
+      }
+  }
+
+double now()
+  {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+  }
+
+bool init(Fdset &fds, bool epoll)
+  {
+    if(epoll && !fds.use_epoll())
+      {
+        cerr << "epoll is not available" << endl;
+        return false;
+      }
+
+    return true;
+  }
+
+void test_semantics(bool epoll)
+  {
+    const char *backend = epoll? "epoll": "select";
+    Fdset fds;
+    if(!init(fds, epoll)) return;
+
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+
+    timeval tv = {0, 100000};
+    fds.set_read(sv[0]);
+    fds.set_write(sv[0]);
+    fds.select(&tv);
+    check(!fds.isactive_read(sv[0]), backend, "idle read");
+    check(fds.isactive_write(sv[0]), backend, "write");
+
+    // Throttled descriptors are not polled for writing until sync()
+    write(sv[1], "x", 1);
+    fds.clear_write2(sv[0]);
+    tv.tv_sec = 0; tv.tv_usec = 100000;
+    fds.select(&tv);
+    check(fds.isactive_read(sv[0]), backend, "read");
+    check(!fds.isactive_write(sv[0]), backend, "throttled write");
+
+    fds.sync();
+    tv.tv_sec = 0; tv.tv_usec = 100000;
+    fds.select(&tv);
+    check(fds.isactive_write(sv[0]), backend, "write after sync");
+
+    // A closed descriptor that is reused must be polled again
+    fds.clear_read(sv[0]);
+    fds.clear_write(sv[0]);
+    close(sv[0]);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    fds.set_write(fd);
+    tv.tv_sec = 0; tv.tv_usec = 100000;
+    fds.select(&tv);
+    check(fds.isactive_write(fd), backend, "reused descriptor");
+
+    fds.clear_write(fd);
+    close(fd);
+    close(sv[1]);
+  }
+
+void benchmark(bool epoll, int connections, int active, int rounds)
+  {
+    const char *backend = epoll? "epoll": "select";
+    Fdset fds;
+    if(!init(fds, epoll)) return;
+
+    vector<int> rd, wr;
+    for(int i = 0; i < connections; ++i)
+      {
+        int sv[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+          {
+            cerr << backend << ": " << i << " socket pairs created" << endl;
+            break;
+          }
+
+        rd.push_back(sv[0]);
+        wr.push_back(sv[1]);
+      }
+
+    int maxfd = 0;
+    for(unsigned int i = 0; i < rd.size(); ++i)
+      {
+        if(wr[i] > maxfd) maxfd = wr[i];
+      }
+
+    if(!epoll && maxfd >= FD_SETSIZE)
+      {
+        printf("%-6s %6d connections: skipped, FD_SETSIZE exceeded\n",
+          backend, (int)rd.size());
+      }
+    else
+      {
+        for(unsigned int i = 0; i < rd.size(); ++i)
+            fds.set_read(rd[i]);
+
+        int seen = 0;
+        double start = now();
+
+        for(int r = 0; r < rounds; ++r)
+          {
+            for(int a = 0; a < active; ++a)
+                write(wr[(r * active + a * 7919) % wr.size()], "x", 1);
+
+            int ready = 0;
+            while(ready < active)
+              {
+                timeval tv = {1, 0};
+                if(fds.select(&tv) <= 0) break;
+
+                char c;
+                if(epoll)
+                  {
+                    const vector<int> &act = fds.active_fds();
+                    for(vector<int>::const_iterator i = act.begin(); i != act.end(); ++i)
+                      {
+                        if(fds.isactive_read(*i) && read(*i, &c, 1) == 1) ++ready;
+                      }
+                  }
+                else
+                  {
+                    for(unsigned int i = 0; i < rd.size(); ++i)
+                      {
+                        if(fds.isactive_read(rd[i]) && read(rd[i], &c, 1) == 1) ++ready;
+                      }
+                  }
+              }
+
+            seen += ready;
+          }
+
+        double elapsed = now() - start;
+        check(seen == rounds * active, backend, "benchmark reads");
+        printf("%-6s %6d connections, %d active: %.2f us/round\n", backend,
+          (int)rd.size(), active, elapsed * 1e6 / rounds);
+
+        for(unsigned int i = 0; i < rd.size(); ++i)
+            fds.clear_read(rd[i]);
+      }
+
+    for(unsigned int i = 0; i < rd.size(); ++i)
+      {
+        close(rd[i]);
+        close(wr[i]);
+      }
+  }
+
+} // unnamed namespace
+
+int main(int argc, char **argv)
+  {
+    int connections = (argc > 1)? atoi(argv[1]): 500;
+    int active = (argc > 2)? atoi(argv[2]): 10;
+    int rounds = (argc > 3)? atoi(argv[3]): 10000;
+
+    // Each connection needs two descriptors
+    rlimit rl;
+    if(getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+      {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+      }
+
+    test_semantics(false);
+    test_semantics(true);
+
+    benchmark(false, connections, active, rounds);
+    benchmark(true, connections, active, rounds);
+
+    return errors? 1: 0;
+  }
@@ -31,42 +31,67 @@ class FilterImpl: public Filter
     const FilterType type;
     const double gain;
     const double *const points;
+    double *coeffs;
   
   public:
+    // Only the first half of the coefficients is given for zero phase
+    // filters. The gain is applied to the coefficients in advance.
     FilterImpl(const string &name, FilterType type_init, int len_init, int dec,
       double gain_init, const double *points_init):
       Filter(name, dec), type(type_init), gain(gain_init), points(points_init)
       {
         len = len_init;
+
+        int n_points = (type == ZeroPhase)? (len / 2 + len % 2): len;
+        coeffs = new double[n_points];
+        for(int i = 0; i < n_points; ++i)
+            coeffs[i] = points[i] * gain;
       }
 
     ~FilterImpl()
       {
         delete[] points;
+        delete[] coeffs;
       }
     
     double apply(CircularBuffer<double>::iterator p)
       {
-        double acc = 0;
+        const double *x = p.window();
+        double acc0 = 0, acc1 = 0;
         
         if(type == ZeroPhase)
           {
-            for(int i = 0; i < len / 2; ++i)
-                acc += *(p++) * points[i] * gain;
+            // Symmetric taps are folded, which halves the multiplications
+            const double *y = x + len - 1;
+            int i = 0;
+
+            for(; i + 1 < len / 2; i += 2)
+              {
+                acc0 += (x[i] + y[-i]) * coeffs[i];
+                acc1 += (x[i + 1] + y[-i - 1]) * coeffs[i + 1];
+              }
 
-            if (len % 2) 
-                acc += *(p++) * points[len/2] * gain;
+            for(; i < len / 2; ++i)
+                acc0 += (x[i] + y[-i]) * coeffs[i];
 
-            for(int i = len / 2 - 1; i >= 0; --i)
-                acc += *(p++) * points[i] * gain;
+            if(len % 2)
+                acc1 += x[len / 2] * coeffs[len / 2];
           }
         else
           {
-            for(int i = 0; i < len; ++i)
-                acc += *(p++) * points[i] * gain;
+            int i = 0;
+
+            for(; i + 1 < len; i += 2)
+              {
+                acc0 += x[i] * coeffs[i];
+                acc1 += x[i + 1] * coeffs[i + 1];
+              }
+
+            for(; i < len; ++i)
+                acc0 += x[i] * coeffs[i];
           }
 
-        return acc;
+        return acc0 + acc1;
       }
 
     double shift()
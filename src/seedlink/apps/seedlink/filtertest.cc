@@ -0,0 +1,186 @@
+/*****************************************************************************
+ * filtertest.cc
+ *
+ * Test and benchmark of the FIR filters of the stream processors
+ *
+ * Usage: testfilter [samples]
+ *
+ * Filters random input with zero phase and minimum phase FilterImpl
+ * instances of several lengths and compares every output with a direct
+ * convolution through the CircularBuffer iterator, which is how the
+ * filters were evaluated before. Reports the largest difference relative
+ * to the sum of the absolute products and the time per output of both.
+ *
+ * (c) GFZ Potsdam
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any later
+ * version. For more information, see http://www.gnu.org/
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+#include <sys/time.h>
+
+#include "filterimpl.h"
+
+using namespace std;
+using namespace SProc_private;
+
+namespace {
+
+// Largest accepted difference relative to the sum of the absolute products
+const double MAX_ERROR = 1e-12;
+
+// Buffer size in powers of two, must hold the longest filter
+const int CBUF_SIZE = 10;
+
+double now()
+  {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+  }
+
+// Direct convolution with the full set of taps
+double convolve(CircularBuffer<double>::iterator p, const vector<double> &taps)
+  {
+    double acc = 0;
+
+    for(unsigned int i = 0; i < taps.size(); ++i, ++p)
+        acc += *p * taps[i];
+
+    return acc;
+  }
+
+// Sum of the absolute products, which bounds the rounding error
+double error_scale(CircularBuffer<double>::iterator p, const vector<double> &taps)
+  {
+    double scale = 0;
+
+    for(unsigned int i = 0; i < taps.size(); ++i, ++p)
+        scale += fabs(*p * taps[i]);
+
+    return scale;
+  }
+
+// Returns false if FilterImpl differs from the direct convolution
+bool run(FilterImpl::FilterType type, int len, int dec, int samples)
+  {
+    const char *name = (type == FilterImpl::ZeroPhase)? "zero": "minimum";
+    const double gain = 1.7;
+
+    int n_points = (type == FilterImpl::ZeroPhase)? (len / 2 + len % 2): len;
+    double *points = new double[n_points];
+    for(int i = 0; i < n_points; ++i)
+        points[i] = drand48() - 0.5;
+
+    vector<double> taps(len);
+    for(int i = 0; i < len; ++i)
+      {
+        int j = (type == FilterImpl::ZeroPhase && i >= n_points)? (len - 1 - i): i;
+        taps[i] = points[j] * gain;
+      }
+
+    // FilterImpl takes the ownership of the points
+    FilterImpl filter("test", type, len, dec, gain, points);
+
+    vector<double> input(samples);
+    for(int n = 0; n < samples; ++n)
+        input[n] = (drand48() - 0.5) * 1e6;
+
+    double max_error = 0, sink = 0;
+    int outputs = 0;
+
+    // Comparison pass
+      {
+        CircularBuffer<double> cbuf(CBUF_SIZE);
+        CircularBuffer<double>::iterator p = cbuf.read_ptr();
+
+        for(int n = 0; n < samples; ++n)
+          {
+            cbuf.write(input[n]);
+            if(cbuf.used(p) < len) continue;
+
+            double expected = convolve(p, taps);
+            double scale = error_scale(p, taps);
+            double result = filter.apply(p);
+            ++outputs;
+
+            if(scale > 0)
+                max_error = max(max_error, fabs(result - expected) / scale);
+
+            p += dec;
+          }
+      }
+
+    // Timing passes over the same input
+    double t_direct = now();
+      {
+        CircularBuffer<double> cbuf(CBUF_SIZE);
+        CircularBuffer<double>::iterator p = cbuf.read_ptr();
+
+        for(int n = 0; n < samples; ++n)
+          {
+            cbuf.write(input[n]);
+            if(cbuf.used(p) < len) continue;
+
+            sink += convolve(p, taps);
+            p += dec;
+          }
+      }
+    t_direct = now() - t_direct;
+
+    double t_filter = now();
+      {
+        CircularBuffer<double> cbuf(CBUF_SIZE);
+        CircularBuffer<double>::iterator p = cbuf.read_ptr();
+
+        for(int n = 0; n < samples; ++n)
+          {
+            cbuf.write(input[n]);
+            if(cbuf.used(p) < len) continue;
+
+            sink += filter.apply(p);
+            p += dec;
+          }
+      }
+    t_filter = now() - t_filter;
+
+    bool ok = (max_error <= MAX_ERROR);
+
+    printf("%-7s %4d taps: max. error %.1e, direct %7.3f us, "
+      "FilterImpl %7.3f us%s\n", name, len, max_error,
+      t_direct * 1e6 / outputs, t_filter * 1e6 / outputs,
+      ok? "": "  FAILED");
+
+    // Keeps the compiler from dropping the computations
+    if(sink == 1.2345) cerr << sink << endl;
+
+    return ok;
+  }
+
+} // unnamed namespace
+
+int main(int argc, char **argv)
+  {
+    int samples = (argc > 1)? atoi(argv[1]): 20000;
+    int lengths[] = { 1, 2, 3, 7, 8, 48, 97, 400, 1000 };
+    int errors = 0;
+
+    srand48(1);
+
+    for(unsigned int i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i)
+      {
+        if(!run(FilterImpl::ZeroPhase, lengths[i], 2, samples)) ++errors;
+        if(!run(FilterImpl::MinimumPhase, lengths[i], 2, samples)) ++errors;
+      }
+
+    return errors? 1: 0;
+  }
+
@@ -32,6 +32,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
@@ -157,7 +158,7 @@ inline int xsocket(int domain, int type, int protocol)
     if((fd = socket(domain, type, protocol)) >= 0)
         fcntl(fd, F_SETFD, FD_CLOEXEC);
 
-    if(fd >= FD_SETSIZE)
+    if(fd >= FD_SETSIZE && !fds.epoll())
         throw FDSetsizeExceeded(fd);
     
     return fd;
@@ -173,7 +174,7 @@ inline int xaccept(int s, struct sockaddr *addr, socklen_t *addrlen)
     if((fd = accept(s, addr, addrlen)) >= 0)
         fcntl(fd, F_SETFD, FD_CLOEXEC);
 
-    if(fd >= FD_SETSIZE)
+    if(fd >= FD_SETSIZE && !fds.epoll())
         throw FDSetsizeExceeded(fd);
     
     return fd;
@@ -270,6 +271,14 @@ istream &operator>>(istream &s, Sequence &x)
   }
 #endif
 
+// SeedLink packet header ("SL" followed by the sequence number)
+const int         SLHEADER_SIZE     = 2 + Sequence::size;
+
+inline void format_header(char *p, Sequence seq)
+  {
+    snprintf(p, SLHEADER_SIZE + 1, "%s%06X", SIGNATURE, int(seq));
+  }
+
 //*****************************************************************************
 // BufferImpl
 //*****************************************************************************
@@ -282,6 +291,15 @@ class BufferImpl: public Buffer
     BufferImpl *nextptr;
     void *dataptr;
     Sequence seq;
+    char headerbuf[SLHEADER_SIZE + 1];
+
+    // The header is encoded once per packet and then sent to all
+    // clients from here
+    void set_sequence(Sequence seq_init)
+      {
+        seq = seq_init;
+        format_header(headerbuf, seq);
+      }
 
     ~BufferImpl()
       {
@@ -292,6 +310,7 @@ class BufferImpl: public Buffer
     BufferImpl(int size): Buffer(size), prevptr(NULL), nextptr(NULL), dataptr(NULL)
       {
         if((dataptr = malloc(size)) == NULL) throw bad_alloc();
+        headerbuf[0] = 0;
       }
 
     BufferImpl *next() const
@@ -308,6 +327,11 @@ class BufferImpl: public Buffer
       {
         return seq;
       }
+
+    const char *header() const
+      {
+        return headerbuf;
+      }
   };
 
 
@@ -451,7 +475,7 @@ void BufferStoreImpl::queue_buffer(Buffer *buf1)
     BufferImpl *buf = dynamic_cast<BufferImpl *>(buf1);
     internal_check(buf != NULL);
 
-    buf->seq = seq;
+    buf->set_sequence(seq);
     seq.increment();
     if(buf_head == buf) buf_head = buf->nextptr;
     remove_buffer(buf);
@@ -467,7 +491,7 @@ void BufferStoreImpl::next_buffer()
     
     BufferImpl* buf = buf_free;
     buf_free = buf_free->nextptr;
-    buf->seq = seq;
+    buf->set_sequence(seq);
     seq.increment();
     if(buf_head == buf) buf_head = buf->nextptr;
     remove_buffer(buf);
@@ -500,10 +524,45 @@ void BufferStoreImpl::create_blank_buffers(int n)
       }
   }
 
+ssize_t writevn(int fd, struct iovec *iov, int iovcnt)
+  {
+    ssize_t nwritten;
+    size_t n = 0;
+
+    for(int i = 0; i < iovcnt; ++i)
+        n += iov[i].iov_len;
+
+    while (iovcnt > 0)
+      {
+        if ((nwritten = writev(fd, iov, iovcnt)) <= 0)
+            return(nwritten);
+
+        while (iovcnt > 0 && (size_t) nwritten >= iov->iov_len)
+          {
+            nwritten -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+          }
+
+        if (iovcnt > 0)
+          {
+            iov->iov_base = (char *) iov->iov_base + nwritten;
+            iov->iov_len -= nwritten;
+          }
+      }
+
+    return(n);
+  }
+
 //*****************************************************************************
 // FileBuffer
 //*****************************************************************************
 
+// Records are not written to the segment file immediately; store() only
+// queues them and flush() writes all queued records with one writev() call.
+// A queued record still lives in BufferStoreImpl, so it must be flushed
+// before its buffer is recycled.
+
 class FileBuffer
   {
   friend class FileStore;
@@ -511,16 +570,18 @@ class FileBuffer
     FileBuffer *nextptr;
     Sequence seq;
     int writefd, nbuf;
+    vector<BufferImpl *> pending;
 
     ~FileBuffer() {}
+    void store(BufferImpl *buf);
+    void flush();
 
   public:
     const string name;
     
     FileBuffer(const string &name_init):
       nextptr(NULL), writefd(-1), nbuf(0), name(name_init) {}
-    void store(BufferImpl *buf);
-    
+
     FileBuffer *next() const
       {
         return nextptr;
@@ -531,22 +592,62 @@ class FileBuffer
         return seq;
       }
 
+    // Includes the records that are not written yet
     int buffers_stored() const
       {
         return nbuf;
       }
+
+    int buffers_written() const
+      {
+        return nbuf - pending.size();
+      }
+
+    int buffers_pending() const
+      {
+        return pending.size();
+      }
+
+    bool is_pending(const BufferImpl *buf) const
+      {
+        return (!pending.empty() && pending.front() == buf);
+      }
   };
       
 void FileBuffer::store(BufferImpl *buf)
   {
     internal_check(writefd >=0);
-    if(write(writefd, buf->data(), buf->size) < buf->size)
-        throw CannotWriteFile(name);
+    pending.push_back(buf);
 
     if(!nbuf) seq = buf->sequence();
     ++nbuf;
   }
 
+void FileBuffer::flush()
+  {
+    struct iovec iov[64];
+    vector<BufferImpl *>::iterator p = pending.begin();
+
+    while(p != pending.end())
+      {
+        int iovcnt = 0;
+        ssize_t size = 0;
+        while(p != pending.end() && iovcnt < 64)
+          {
+            iov[iovcnt].iov_base = (*p)->data();
+            iov[iovcnt].iov_len = (*p)->size;
+            size += (*p)->size;
+            ++iovcnt;
+            ++p;
+          }
+
+        if(writevn(writefd, iov, iovcnt) < size)
+            throw CannotWriteFile(name);
+      }
+
+    pending.clear();
+  }
+
 //*****************************************************************************
 // FileStore
 //*****************************************************************************
@@ -555,26 +656,56 @@ class FileStorePartner
   {
   public:
     virtual void delete_oldest_segment(FileBuffer *buf) =0;
+    virtual void segment_flushed(int nrec, int usec) =0;
     virtual ~FileStorePartner() {};
   };
 
+// FileStores that have records queued for writing register themselves in
+// the WriteQueue, which is flushed once per iteration of the main loop.
+// This way all records that arrived in one iteration are written to a
+// segment with a single system call.
+
+class FileStore;
+
+class WriteQueue
+  {
+  private:
+    vector<FileStore *> queued;
+
+  public:
+    void add(FileStore *fs)
+      {
+        queued.push_back(fs);
+      }
+
+    void flush();
+  };
+
 class FileStore
   {
   private:
     FileStorePartner &partner;
+    WriteQueue &wq;
     FileBuffer *buf_head, *buf_tail;
     const int bufsize;
     const string segments_dir;
     const int maxfiles;
+    const int filesize;
     int nfiles;
+    bool queued;
     FileBuffer *get_file_helper(const string &filename);
+    void preallocate(int fd, int nbuf);
+    void flush_segment(FileBuffer *fb);
 
   public:
-    FileStore(FileStorePartner &partner_init, int bufsize_init,
-      const string &segments_dir_init, int maxfiles_init);
+    FileStore(FileStorePartner &partner_init, WriteQueue &wq_init,
+      int bufsize_init, const string &segments_dir_init, int maxfiles_init,
+      int filesize_init);
     ~FileStore();
     FileBuffer *get_file(LONG seq_long);
     void release_file(FileBuffer *fb);
+    void store(FileBuffer *fb, BufferImpl *buf);
+    void flush();
     LONG restore_state();
 
     FileBuffer *first()
@@ -636,10 +767,12 @@ FileBuffer *FileStore::get_file_helper(const string &filename)
     return buf_tail;
   }
 
-FileStore::FileStore(FileStorePartner &partner_init, int bufsize_init,
-  const string &segments_dir_init, int maxfiles_init):
-  partner(partner_init), buf_head(NULL), buf_tail(NULL), bufsize(bufsize_init), 
-  segments_dir(segments_dir_init), maxfiles(maxfiles_init), nfiles(0) {}
+FileStore::FileStore(FileStorePartner &partner_init, WriteQueue &wq_init,
+  int bufsize_init, const string &segments_dir_init, int maxfiles_init,
+  int filesize_init):
+  partner(partner_init), wq(wq_init), buf_head(NULL), buf_tail(NULL),
+  bufsize(bufsize_init), segments_dir(segments_dir_init),
+  maxfiles(maxfiles_init), filesize(filesize_init), nfiles(0), queued(false) {}
   
 FileStore::~FileStore()
   {
@@ -669,15 +802,75 @@ FileBuffer *FileStore::get_file(LONG seq_long)
     if((p->writefd = xcreat(p->name.c_str(), 0644)) < 0)
         throw CannotCreateFile(p->name);
     
+    preallocate(p->writefd, filesize);
     return p;
   }
     
 void FileStore::release_file(FileBuffer *fb)
   {
+    if(fb->buffers_pending()) flush_segment(fb);
+
     xclose(fb->writefd);
     fb->writefd = -1;
   }
 
+// Reserves the disk space of a segment without changing the file size,
+// which is used by restore_state() to count the records.
+
+void FileStore::preallocate(int fd, int nbuf)
+  {
+#ifdef FALLOC_FL_KEEP_SIZE
+    if(nbuf > 0 && fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, off_t(nbuf) * bufsize) < 0)
+        DEBUG_MSG("fallocate: " << strerror(errno) << endl);
+#endif
+  }
+
+// Writes the queued records of a segment and reports the number of records
+// and the wall clock time of the write to the partner.
+
+void FileStore::flush_segment(FileBuffer *fb)
+  {
+    struct timeval t0, t1;
+    int nrec = fb->buffers_pending();
+
+    N(gettimeofday(&t0, NULL));
+    fb->flush();
+    N(gettimeofday(&t1, NULL));
+
+    partner.segment_flushed(nrec, (t1.tv_sec - t0.tv_sec) * 1000000 +
+      (t1.tv_usec - t0.tv_usec));
+  }
+
+void FileStore::store(FileBuffer *fb, BufferImpl *buf)
+  {
+    fb->store(buf);
+
+    if(!queued)
+      {
+        queued = true;
+        wq.add(this);
+      }
+  }
+
+// Only the last segment can have pending records, because release_file()
+// flushes a segment before it is closed.
+
+void FileStore::flush()
+  {
+    queued = false;
+
+    if(buf_tail != NULL && buf_tail->buffers_pending())
+        flush_segment(buf_tail);
+  }
+
+void WriteQueue::flush()
+  {
+    for(vector<FileStore *>::iterator p = queued.begin(); p != queued.end(); ++p)
+        (*p)->flush();
+
+    queued.clear();
+  }
+
 LONG FileStore::restore_state()
   {
     DIR *dir;
@@ -729,6 +922,9 @@ LONG FileStore::restore_state()
     if(p != NULL && (p->writefd = xopen(p->name.c_str(), O_WRONLY | O_APPEND)) < 0)
         throw CannotOpenFile(p->name);
 
+    if(p != NULL)
+        preallocate(p->writefd, filesize);
+
     return seq_long;
   }
         
@@ -1075,6 +1271,9 @@ StationConnection::DeliveryResult StationConnection::do_deliver()
         return Ok;
       }
         
+    const char *header = NULL;
+    char header_buf[SLHEADER_SIZE + 1];
+
     if(sx.bufpos == 0)
       {
         sx.monitor->check_seq(sx.seq);
@@ -1082,12 +1281,15 @@ StationConnection::DeliveryResult StationConnection::do_deliver()
           {
             sx.monitor->count_packet();
             
-            ostringstream sseqstr;
-            sseqstr << SIGNATURE << sx.seq;
-        
-            string seqstr = sseqstr.str();
-            if(writen(sx.cx.clientfd, seqstr.c_str(), seqstr.length()) <= 0)
-                return Fail;
+            if(sx.file_queue == NULL)
+              {
+                header = sx.buffer_queue->header();
+              }
+            else
+              {
+                format_header(header_buf, sx.seq);
+                header = header_buf;
+              }
           }
         else
           {
@@ -1101,7 +1303,22 @@ StationConnection::DeliveryResult StationConnection::do_deliver()
           }
       }
 
-    if(writen(sx.cx.clientfd, dataptr, size) <= 0) return Fail;
+    // Header and data are sent with a single system call
+    struct iovec iov[2];
+    int iovcnt = 0;
+
+    if(header != NULL)
+      {
+        iov[iovcnt].iov_base = const_cast<char *>(header);
+        iov[iovcnt].iov_len = SLHEADER_SIZE;
+        ++iovcnt;
+      }
+
+    iov[iovcnt].iov_base = dataptr;
+    iov[iovcnt].iov_len = size;
+    ++iovcnt;
+
+    if(writevn(sx.cx.clientfd, iov, iovcnt) <= 0) return Fail;
     fds.clear_write2(sx.cx.clientfd);
 
     sx.bufpos = (sx.bufpos + size) % (1 << MSEED_RECLEN);
@@ -1159,8 +1376,9 @@ class StationIO: private BufferStoreImplPartner, private FileStorePartner,
     void new_buffer(BufferImpl *buf);
     void delete_oldest_buffer(BufferImpl *buf);
 
-    // FileStore callback
+    // FileStore callbacks
     void delete_oldest_segment(FileBuffer *buf);
+    void segment_flushed(int nrec, int usec);
 
     // StationConnection callbacks
     list<StationConnectionState *>::iterator
@@ -1190,7 +1408,7 @@ class StationIO: private BufferStoreImplPartner, private FileStorePartner,
       bool rlog_init, const string &station_dir_init, int nbufs_init,
       int blank_bufs_init, int filesize_init, int nfiles,
       int seq_gap_limit_init, bool load_headers_init,
-      rc_ptr<StationMonitor> monitor_init);
+      rc_ptr<StationMonitor> monitor_init, WriteQueue &wq);
     rc_ptr<StationConnection> connection_instance(ConnectionState &cx);
     void save_state();
     void restore_state();
@@ -1224,7 +1442,7 @@ void StationIO::new_buffer(BufferImpl *buf)
       
     ++seq_long;
     internal_check(curfb != NULL);
-    curfb->store(buf);
+    fils->store(curfb, buf);
 
     monitor->add_packet(buf->sequence(), buf->data(), MAX_HEADER_LEN);
     monitor->set_end_seq(buf->sequence() + 1);
@@ -1268,6 +1486,10 @@ void StationIO::new_buffer(BufferImpl *buf)
 
 void StationIO::delete_oldest_buffer(BufferImpl *buf)
   {
+    // The record must be on disk before the buffer can be reused
+    if(curfb != NULL && curfb->is_pending(buf))
+        fils->flush();
+
     list<StationConnectionState *>::iterator i;
     for(i = attached.begin(); i != attached.end(); ++i)
       {
@@ -1315,6 +1537,14 @@ void StationIO::delete_oldest_segment(FileBuffer *fb)
           }
       }
   }
+
+// Callback from FileStore (through FileStorePartner) to signal the number
+// of records written by the last flush and its duration in microseconds.
+
+void StationIO::segment_flushed(int nrec, int usec)
+  {
+    monitor->set_last_flush(nrec, usec);
+  }
     
 list<StationConnectionState *>::iterator
 StationIO::attach(StationConnectionState *st)
@@ -1628,7 +1858,7 @@ bool StationIO::find_packet_in_filestore(StationConnectionState &sx, Sequence se
     for(FileBuffer* p = fils->first(); p != NULL; p = p->next())
       {
         if(p->sequence() != Sequence::uninitialized &&
-          seq - p->sequence() < p->buffers_stored())
+          seq - p->sequence() < p->buffers_written())
           {
             sx.buffer_queue = bufs->first();
             sx.file_queue = p;
@@ -1720,14 +1950,15 @@ bool StationIO::find_packet(StationConnectionState &sx, Sequence seq)
 StationIO::StationIO(const string &station_key_init, const string &ident_init,
   bool rlog_init, const string &station_dir_init, int nbufs_init,
   int blank_bufs_init, int filesize_init, int nfiles, int seq_gap_limit_init,
-  bool load_headers_init, rc_ptr<StationMonitor> monitor_init):
+  bool load_headers_init, rc_ptr<StationMonitor> monitor_init, WriteQueue &wq):
   ident(ident_init), rlog(rlog_init), station_dir(station_dir_init),
   nbufs(nbufs_init), blank_bufs(blank_bufs_init), filesize(filesize_init),
   seq_gap_limit(seq_gap_limit_init), load_headers(load_headers_init),
   monitor(monitor_init), station_key(station_key_init)
   {
     bufs = new BufferStoreImpl(*this, (1 << MSEED_RECLEN), nbufs);
-    fils = new FileStore(*this, (1 << MSEED_RECLEN), station_dir + "/segments", nfiles);
+    fils = new FileStore(*this, wq, (1 << MSEED_RECLEN), station_dir + "/segments",
+      nfiles, filesize);
   }
 
 rc_ptr<StationConnection> StationIO::connection_instance(ConnectionState &cx)
@@ -1741,6 +1972,8 @@ void StationIO::save_state()
   {
     const string buffer_file = station_dir + "/buffer.xml";
     
+    fils->flush();
+
     logs(LOG_INFO) << "saving disk buffer description to '" << buffer_file <<
       "'" << endl;
 
@@ -1843,7 +2076,7 @@ void StationIO::restore_state()
     for(p = fils->first(); p != NULL; p = p->next())
       {
         if(p->sequence() != Sequence::uninitialized &&
-          seq - p->sequence() < p->buffers_stored())
+          seq - p->sequence() < p->buffers_written())
           {
             if((fd = xopen(p->name.c_str(), O_RDONLY)) < 0)
                 throw CannotOpenFile(p->name);
@@ -1947,6 +2180,11 @@ class Connection
       {
         return cx.host;
       }
+
+    int fd() const
+      {
+        return cx.clientfd;
+      }
     
     bool process();
     void disconnect();
@@ -2263,6 +2501,7 @@ class ConnectionManagerImpl: public ConnectionManager
     struct timeval throttle;
     Timer th_timer;
     map<unsigned int, int> nconn_per_ip;
+    WriteQueue wq;
 
     // It is very important that "default_station" and "stations" are
     // declared after "monitor", because these objects send a callback
@@ -2273,6 +2512,7 @@ class ConnectionManagerImpl: public ConnectionManager
     rc_ptr<StationIO> default_station;
     map<StationDescriptor, rc_ptr<StationIO> > stations;
     list<rc_ptr<Connection> > connections;
+    map<int, list<rc_ptr<Connection> >::iterator> connections_by_fd;
 
     void client_connect();
     void client_disconnect(rc_ptr<Connection> conn);
@@ -2284,7 +2524,7 @@ class ConnectionManagerImpl: public ConnectionManager
       int max_conn_per_ip_init, int trusted_info_level_init,
       int untrusted_info_level_init, bool trusted_window_extraction_init,
       bool untrusted_window_extraction_init, int max_bps, int to_sec,
-      int to_usec);
+      int to_usec, bool use_epoll);
       
     rc_ptr<BufferStore> register_station(const string &station_key,
       const string &station_name, const string &network_id,
@@ -2303,7 +2543,8 @@ ConnectionManagerImpl::ConnectionManagerImpl(const string &daemon_name_init,
   rc_ptr<MasterMonitor> monitor_init, bool rlog_init, int max_conn_init,
   int max_conn_per_ip_init, int trusted_info_level_init,
   int untrusted_info_level_init, bool trusted_window_extraction_init,
-  bool untrusted_window_extraction_init, int max_bps, int to_sec, int to_usec):
+  bool untrusted_window_extraction_init, int max_bps, int to_sec, int to_usec,
+  bool use_epoll):
   daemon_name(daemon_name_init), software_ident(software_ident_init),
   default_network_id(default_network_id_init), rlog(rlog_init),
   max_conn(max_conn_init), max_conn_per_ip(max_conn_per_ip_init),
@@ -2314,6 +2555,9 @@ ConnectionManagerImpl::ConnectionManagerImpl(const string &daemon_name_init,
   listenfd(-1), monitor(monitor_init)
   {
     handler = new ConnectionHandler;
+
+    if(use_epoll && !fds.use_epoll())
+        logs(LOG_WARNING) << "epoll is not available, using select" << endl;
     
     monitor->add_capability("dialup", false);
     monitor->add_capability("multistation", false);
@@ -2455,11 +2699,13 @@ void ConnectionManagerImpl::client_connect()
       clientfd);
 
     connections.push_back(conn);
+    connections_by_fd[clientfd] = --connections.end();
     fds.set_read(clientfd);
   }
     
 void ConnectionManagerImpl::client_disconnect(rc_ptr<Connection> conn)
   {
+    connections_by_fd.erase(conn->fd());
     conn->disconnect();
 
     map<unsigned int, int>::iterator i = nconn_per_ip.find(conn->ip());
@@ -2494,7 +2740,7 @@ rc_ptr<BufferStore> ConnectionManagerImpl::register_station(const string &statio
     rc_ptr<StationIO> stat = new StationIO(station_key,
       software_ident + "\r\n" + description + "\r\n", rlog, station_dir,
       nbufs, blank_bufs, filesize, nfiles, seq_gap_limit,
-      stream_check, statmon);
+      stream_check, statmon, wq);
 
     if(default_station == NULL) default_station = stat;
 
@@ -2540,6 +2786,9 @@ void ConnectionManagerImpl::start(int port)
     
     while((*handler)(fds))
       {
+        // Write the records received by the handler to the disk buffer
+        wq.flush();
+
         if(th_timer.expired())
           {
             fds.sync();
@@ -2559,6 +2808,29 @@ void ConnectionManagerImpl::start(int port)
 
         if(fds.isactive_read(listenfd)) client_connect();
     
+        if(fds.epoll())
+          {
+            // Only visit the connections that are ready
+            const vector<int> &active = fds.active_fds();
+            for(vector<int>::const_iterator a = active.begin(); a != active.end(); ++a)
+              {
+                map<int, list<rc_ptr<Connection> >::iterator>::iterator c =
+                  connections_by_fd.find(*a);
+
+                if(c == connections_by_fd.end()) continue;
+
+                list<rc_ptr<Connection> >::iterator i = c->second;
+                if((*i)->process())
+                  {
+                    client_disconnect(*i);
+                    connections.erase(i);
+                    break;
+                  }
+              }
+
+            continue;
+          }
+
         list<rc_ptr<Connection> >::iterator i;
         for(i = connections.begin(); i != connections.end(); ++i)
           {
@@ -2606,12 +2878,12 @@ rc_ptr<ConnectionManager> make_conn_manager(const string &daemon_name,
   rc_ptr<MasterMonitor> monitor, bool rlog, int max_conn,
   int max_conn_per_ip, int trusted_info_level, int untrusted_info_level,
   bool trusted_window_extraction, bool untrusted_window_extraction,
-  int max_bps, int to_sec, int to_usec)
+  int max_bps, int to_sec, int to_usec, bool use_epoll)
   {
     return new ConnectionManagerImpl(daemon_name, software_ident,
       default_network_id, monitor, rlog, max_conn, max_conn_per_ip,
       trusted_info_level, untrusted_info_level, trusted_window_extraction,
-      untrusted_window_extraction, max_bps, to_sec, to_usec);
+      untrusted_window_extraction, max_bps, to_sec, to_usec, use_epoll);
   }
 
 } // namespace IOSystem_private
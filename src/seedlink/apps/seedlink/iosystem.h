@@ -15,13 +15,21 @@
 #define IOSYSTEM_H
 
 #include <string>
+#include <vector>
 #include <cstring>
 #include <cerrno>
 #include <cstdlib>
 
+#include <unistd.h>
+#include <fcntl.h>
 #include <sys/types.h>
 #include <sys/time.h>
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#define IOSYSTEM_EPOLL
+#endif
+
 // fix broken FD_ZERO
 #ifdef FD_ZERO_BUG
 #include <cstdlib>
@@ -147,12 +155,44 @@ class FDSetsizeExceeded: public Error
 // Fdset
 //*****************************************************************************
 
+// Write interest is kept twice: write_set2 holds what the connections
+// want and write_set what is actually polled. clear_write2() suspends
+// polling of a descriptor until the next sync(), which is used to
+// throttle the clients.
+//
+// By default the sets are polled with select(). After use_epoll() the
+// same interface is backed by a (level-triggered) epoll instance, which
+// is not limited by FD_SETSIZE and reports the ready descriptors
+// directly, see active_fds().
+
 class Fdset
   {
   private:
     fd_set read_set, write_set, write_set2, read_active, write_active;
     int select_status;
 
+    enum
+      {
+        F_READ        = 0x001,    // read interest
+        F_WRITE       = 0x002,    // write interest (write_set)
+        F_WRITE2      = 0x004,    // write interest (write_set2)
+        F_REG_READ    = 0x008,    // registered with EPOLLIN
+        F_REG_WRITE   = 0x010,    // registered with EPOLLOUT
+        F_ACT_READ    = 0x020,
+        F_ACT_WRITE   = 0x040,
+        F_CHANGED     = 0x080,    // registration needs to be updated
+        F_PENDING     = 0x100     // F_WRITE is restored by sync()
+      };
+
+    int epfd;
+    vector<unsigned short> state;
+    vector<int> changed;
+    vector<int> pending;
+    vector<int> active;
+#ifdef IOSYSTEM_EPOLL
+    vector<epoll_event> events;
+#endif
+
     void check_fd(int fd, const char *file, int line) const
       {
         if(fd >= FD_SETSIZE)
@@ -162,8 +202,141 @@ class Fdset
           }
       }
 
+    unsigned short &fd_state(int fd)
+      {
+        if(fd >= (int)state.size()) state.resize(fd + 1, 0);
+        return state[fd];
+      }
+
+    void fd_changed(int fd)
+      {
+        unsigned short &st = fd_state(fd);
+
+        // A descriptor that is not polled anymore is removed right away,
+        // because it is usually closed next and the kernel would then
+        // drop it from the epoll set by itself.
+        if(!(st & (F_READ | F_WRITE)))
+          {
+            update(fd);
+            return;
+          }
+
+        if(st & F_CHANGED) return;
+        st |= F_CHANGED;
+        changed.push_back(fd);
+      }
+
+    void fd_pending(int fd)
+      {
+        unsigned short &st = fd_state(fd);
+        if(st & F_PENDING) return;
+        st |= F_PENDING;
+        pending.push_back(fd);
+      }
+
+    void update(int fd)
+      {
+#ifdef IOSYSTEM_EPOLL
+        unsigned short &st = state[fd];
+        st &= ~F_CHANGED;
+
+        unsigned int want = ((st & F_READ)? EPOLLIN: 0) | ((st & F_WRITE)? EPOLLOUT: 0);
+        unsigned int have = ((st & F_REG_READ)? EPOLLIN: 0) | ((st & F_REG_WRITE)? EPOLLOUT: 0);
+
+        if(want == have) return;
+
+        st &= ~(F_REG_READ | F_REG_WRITE);
+
+        if(want == 0)
+          {
+            // fails if the descriptor has been closed already
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+            return;
+          }
+
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = want;
+        ev.data.fd = fd;
+
+        int r;
+        if(have == 0)
+          {
+            if((r = epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev)) < 0 && errno == EEXIST)
+                r = epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+          }
+        else
+          {
+            // the descriptor has been closed and reused in the meantime
+            if((r = epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev)) < 0 && errno == ENOENT)
+                r = epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+          }
+
+        if(r < 0)
+          {
+            clog << "epoll_ctl(" << fd << "): " << strerror(errno) << endl;
+            return;
+          }
+
+        if(want & EPOLLIN) st |= F_REG_READ;
+        if(want & EPOLLOUT) st |= F_REG_WRITE;
+#endif
+      }
+
+    int epoll_select(timeval *ptv)
+      {
+#ifdef IOSYSTEM_EPOLL
+        for(vector<int>::iterator i = changed.begin(); i != changed.end(); ++i)
+            update(*i);
+
+        changed.clear();
+
+        for(vector<int>::iterator i = active.begin(); i != active.end(); ++i)
+            state[*i] &= ~(F_ACT_READ | F_ACT_WRITE);
+
+        active.clear();
+
+        int timeout = -1;
+        if(ptv != NULL)
+            timeout = ptv->tv_sec * 1000 + (ptv->tv_usec + 999) / 1000;
+
+        if(events.size() < 64) events.resize(64);
+
+        int n = epoll_wait(epfd, &events[0], events.size(), timeout);
+        if(n <= 0) return n;
+
+        for(int i = 0; i < n; ++i)
+          {
+            int fd = events[i].data.fd;
+            if(fd >= (int)state.size()) continue;
+
+            unsigned short &st = state[fd];
+            unsigned int ev = events[i].events;
+
+            // like select(), errors and hangups make the descriptor
+            // readable and writable
+            if((st & F_READ) && (ev & (EPOLLIN | EPOLLERR | EPOLLHUP)))
+                st |= F_ACT_READ;
+
+            if((st & F_WRITE) && (ev & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
+                st |= F_ACT_WRITE;
+
+            if(st & (F_ACT_READ | F_ACT_WRITE))
+                active.push_back(fd);
+          }
+
+        // More descriptors might have been ready
+        if(n == (int)events.size()) events.resize(events.size() * 2);
+
+        return active.size();
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+      }
+
   public:
-    Fdset(): select_status(0)
+    Fdset(): select_status(0), epfd(-1)
       {
         FD_ZERO(&read_set);
         FD_ZERO(&write_set);
@@ -172,14 +345,63 @@ class Fdset
         FD_ZERO(&write_active);
       }
 
+    ~Fdset()
+      {
+        if(epfd >= 0) close(epfd);
+      }
+
+    // Switches to the epoll backend, must be called before any descriptor
+    // has been added. Returns false if epoll is not available.
+    bool use_epoll()
+      {
+#ifdef IOSYSTEM_EPOLL
+        if(epfd >= 0) return true;
+        if((epfd = epoll_create(1024)) < 0) return false;
+        fcntl(epfd, F_SETFD, FD_CLOEXEC);
+        return true;
+#else
+        return false;
+#endif
+      }
+
+    bool epoll() const
+      {
+        return epfd >= 0;
+      }
+
+    // Returns the descriptors that became ready in the last call of
+    // select(), only maintained by the epoll backend
+    const vector<int> &active_fds() const
+      {
+        return active;
+      }
+
     void set_read(int fd)
       {
+        if(epfd >= 0)
+          {
+            unsigned short &st = fd_state(fd);
+            if(st & F_READ) return;
+            st |= F_READ;
+            fd_changed(fd);
+            return;
+          }
+
         check_fd(fd, __FILE__, __LINE__);
         FD_SET(fd, &read_set);
       }
 
     void set_write(int fd)
       {
+        if(epfd >= 0)
+          {
+            unsigned short &st = fd_state(fd);
+            if((st & (F_WRITE | F_WRITE2)) == (F_WRITE | F_WRITE2)) return;
+            st |= F_WRITE | F_WRITE2;
+            fd_changed(fd);
+            return;
+          }
+
         check_fd(fd, __FILE__, __LINE__);
         FD_SET(fd, &write_set);
         FD_SET(fd, &write_set2);
@@ -187,18 +409,44 @@ class Fdset
 
     void set_write2(int fd)
       {
+        if(epfd >= 0)
+          {
+            unsigned short &st = fd_state(fd);
+            st |= F_WRITE2;
+            if(!(st & F_WRITE)) fd_pending(fd);
+            return;
+          }
+
         check_fd(fd, __FILE__, __LINE__);
         FD_SET(fd, &write_set2);
       }
 
     void clear_read(int fd)
       {
+        if(epfd >= 0)
+          {
+            unsigned short &st = fd_state(fd);
+            if(!(st & F_READ)) return;
+            st &= ~F_READ;
+            fd_changed(fd);
+            return;
+          }
+
         check_fd(fd, __FILE__, __LINE__);
         FD_CLR(fd, &read_set);
       }
 
     void clear_write(int fd)
       {
+        if(epfd >= 0)
+          {
+            unsigned short &st = fd_state(fd);
+            if(!(st & (F_WRITE | F_WRITE2))) return;
+            st &= ~(F_WRITE | F_WRITE2);
+            fd_changed(fd);
+            return;
+          }
+
         check_fd(fd, __FILE__, __LINE__);
         FD_CLR(fd, &write_set);
         FD_CLR(fd, &write_set2);
@@ -206,29 +454,69 @@ class Fdset
 
     void clear_write2(int fd)
       {
+        if(epfd >= 0)
+          {
+            unsigned short &st = fd_state(fd);
+            if(!(st & F_WRITE)) return;
+            st &= ~F_WRITE;  // NB: F_WRITE, not F_WRITE2
+            fd_changed(fd);
+            fd_pending(fd);
+            return;
+          }
+
         check_fd(fd, __FILE__, __LINE__);
         FD_CLR(fd, &write_set);  // NB: write_set, not write_set2
       }
 
     void sync()
       {
+        if(epfd >= 0)
+          {
+            for(vector<int>::iterator i = pending.begin(); i != pending.end(); ++i)
+              {
+                unsigned short &st = state[*i];
+                st &= ~F_PENDING;
+
+                if((st & F_WRITE2) && !(st & F_WRITE))
+                  {
+                    st |= F_WRITE;
+                    fd_changed(*i);
+                  }
+              }
+
+            pending.clear();
+            return;
+          }
+
         write_set = write_set2;
       }
 
     bool isactive_read(int fd) const
       {
+        if(epfd >= 0)
+            return fd < (int)state.size() && (state[fd] & F_ACT_READ);
+
         check_fd(fd, __FILE__, __LINE__);
         return FD_ISSET(fd, &read_active);
       }
 
     bool isactive_write(int fd) const
       {
+        if(epfd >= 0)
+            return fd < (int)state.size() && (state[fd] & F_ACT_WRITE);
+
         check_fd(fd, __FILE__, __LINE__);
         return FD_ISSET(fd, &write_active);
       }
 
     int select(timeval *ptv)
       {
+        if(epfd >= 0)
+          {
+            select_status = epoll_select(ptv);
+            return select_status;
+          }
+
         read_active = read_set;
         write_active = write_set;
 
@@ -310,7 +598,7 @@ rc_ptr<ConnectionManager> make_conn_manager(const string &daemon_name,
   rc_ptr<MasterMonitor> monitor, bool rlog, int max_conn,
   int max_conn_per_ip, int trusted_info_level, int untrusted_info_level,
   bool trusted_window_extraction, bool untrusted_window_extraction,
-  int max_bps, int to_sec, int to_usec);
+  int max_bps, int to_sec, int to_usec, bool use_epoll = false);
 
 } // namespace IOSystem_private
 
@@ -1682,6 +1682,8 @@ class StationMonitorImpl: public StationMonitor, private ConnectionMonitorPartne
     const IPACL ip_access;
     int begin_seq;
     int end_seq;
+    int last_flush_records;
+    int last_flush_usec;
     map<StreamDescriptor, rc_ptr<StreamMonitor> > stream_map;
     int segment_count;
     bool stream_check;
@@ -1703,7 +1705,8 @@ class StationMonitorImpl: public StationMonitor, private ConnectionMonitorPartne
       const string &name_init, const string &network_init,
       const string &description_init, const IPACL &ip_access_init):
       name(name_init), network(network_init), description(description_init),
-      ip_access(ip_access_init), begin_seq(0), end_seq(0), segment_count(1),
+      ip_access(ip_access_init), begin_seq(0), end_seq(0),
+      last_flush_records(0), last_flush_usec(0), segment_count(1),
       stream_check(false), gap_check_rx_initialized(false),
       partner(partner_init)
       {
@@ -1740,6 +1743,14 @@ class StationMonitorImpl: public StationMonitor, private ConnectionMonitorPartne
         end_seq = (seq & SEQ_MASK);
       }
 
+    // Records written to the disk buffer by the last flush and its
+    // wall clock time
+    void set_last_flush(int nrec, int usec)
+      {
+        last_flush_records = nrec;
+        last_flush_usec = usec;
+      }
+
     void reset()
       {
         begin_seq = 0;
@@ -1956,6 +1967,12 @@ void StationMonitorImpl::getinfo(xmlNodePtr parent, int info_level,
     snprintf(buf, 8, "%06X", end_seq);
     xml_new_prop(child, "end_seq", buf);
 
+    snprintf(buf, 10, "%d", last_flush_records);
+    xml_new_prop(child, "last_flush_records", buf);
+
+    snprintf(buf, 10, "%d", last_flush_usec);
+    xml_new_prop(child, "last_flush_usec", buf);
+
     xml_new_prop(child, "stream_check", (stream_check ? "enabled": "disabled"));
 
     if(((info_level >= StreamInfo && info_level <= GapInfo) ||
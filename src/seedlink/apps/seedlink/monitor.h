@@ -198,6 +198,7 @@ class StationMonitor
   public:
     virtual void set_begin_seq(int seq) =0;
     virtual void set_end_seq(int seq) =0;
+    virtual void set_last_flush(int nrec, int usec) =0;
     virtual void configure_stream_check(bool enabled, const string &regex,
       int treshold) =0;
     virtual void add_packet(int seq, const void *head, int size) =0;
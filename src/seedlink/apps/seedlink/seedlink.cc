@@ -33,6 +33,7 @@
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <sys/resource.h>
+#include <sys/mman.h>
 
 #if defined(__GNU_LIBRARY__) || defined(__GLIBC__)
 #include <getopt.h>
@@ -56,6 +57,7 @@
 #include "steim2.h"
 #include "filterimpl.h"
 #include "plugin.h"
+#include "plugin_shm.h"
 #include "diag.h"
 
 #define MYVERSION "3.2 (2014.071)"
@@ -134,6 +136,7 @@ int untrusted_info_level = 1;
 int plugin_timeout = 0;
 int plugin_start_retry = 0;
 int plugin_shutdown_wait = 0;
+bool plugin_shm = false;
 double backfill_capacity = 0;
 int proc_gap_warn_default = 2;
 int proc_gap_flush_default = 0;
@@ -147,6 +150,7 @@ string gap_check_pattern;
 int gap_treshold = 10000;
 bool trusted_window_extraction = false;
 bool untrusted_window_extraction = false;
+bool io_epoll = false;
 
 string daemon_name;
 int verbosity = 0;
@@ -268,8 +272,11 @@ class Plugin
   {
   private:
     const string cmdline;
+    const bool use_shm;
     pid_t pid;
     int parent_fd;
+    int shm_fd;
+    PluginShmRing *ring;
     bool child_active;
     bool sigterm_sent;
     bool sigkill_sent;
@@ -289,6 +296,11 @@ class Plugin
      
     bool check_child();
     bool read_helper();
+    int data_size(const PluginPacketHeader &head);
+    void ring_create();
+    void ring_destroy();
+    bool ring_read(PluginPacketHeader &head, void *data);
+    bool ring_wait();
 
     void kill_plugin()
       {
@@ -303,8 +315,9 @@ class Plugin
     const string name;
   
     Plugin(const string name_init, const string &cmdline_init, int read_timeout,
-      int start_retry, int shutdown_wait):
-      cmdline(cmdline_init), pid(0), parent_fd(-1), child_active(true),
+      int start_retry, int shutdown_wait, bool use_shm_init):
+      cmdline(cmdline_init), use_shm(use_shm_init), pid(0), parent_fd(-1),
+      shm_fd(-1), ring(NULL), child_active(true),
       sigterm_sent(false), sigkill_sent(false), data_available(false),
       shutdown_requested(false), restart_requested(false), read_timer(read_timeout, 0),
       start_retry_timer(start_retry, 0), shutdown_timer(shutdown_wait, 0),
@@ -314,6 +327,7 @@ class Plugin
     ~Plugin()
       {
         if(parent_fd >= 0) close(parent_fd);
+        ring_destroy();
       }
         
     void start();
@@ -364,11 +378,16 @@ void Plugin::start()
         close(pipe_fd[1]);
       }
 
+    ring_create();
+
     N(pid = fork());
 
     if(pid) 
       {
         close(pipe_fd[1]);
+        if(shm_fd >= 0) close(shm_fd);
+        shm_fd = -1;
+
         parent_fd = pipe_fd[0];
         N(fcntl(parent_fd, F_SETFD, FD_CLOEXEC));
         N(fcntl(parent_fd, F_SETFL, O_NONBLOCK));
@@ -390,6 +409,16 @@ void Plugin::start()
         close(pipe_fd[1]);
       }
 
+    if(shm_fd == PLUGIN_SHM_FD)
+      {
+        N(fcntl(shm_fd, F_SETFD, 0));
+      }
+    else if(shm_fd >= 0)
+      {
+        N(dup2(shm_fd, PLUGIN_SHM_FD));
+        close(shm_fd);
+      }
+
     logs(LOG_INFO) << "[" << name << "] starting shell" << endl;
     
     execl(SHELL, SHELL, "-c", (cmdline + " " + name).c_str(), NULL);
@@ -483,21 +512,8 @@ bool Plugin::read_helper()
 
     if(read_state == ReadHeader && nleft == 0)
       {
-        if(header_buf.packtype == PluginRawDataTimePacket ||
-          header_buf.packtype == PluginRawDataPacket)
-            data_bytes = header_buf.data_size << 2;
-        else if(header_buf.packtype == PluginLogPacket ||
-          header_buf.packtype == PluginMSEEDPacket)
-            data_bytes = header_buf.data_size;
-        else
-            data_bytes = 0;
-
-        if(data_bytes > PLUGIN_MAX_DATA_BYTES || data_bytes < 0)
-          {
-            logs(LOG_ERR) << "[" << name << "] invalid data size (" <<
-              header_buf.data_size << ")" << endl;
+        if((data_bytes = data_size(header_buf)) < 0)
             return false;
-          }
 
         nleft = data_bytes;
         ptr = data_buf;
@@ -513,8 +529,147 @@ bool Plugin::read_helper()
     return true;
   }
 
+int Plugin::data_size(const PluginPacketHeader &head)
+  {
+    int bytes;
+    
+    if(head.packtype == PluginRawDataTimePacket ||
+      head.packtype == PluginRawDataPacket)
+        bytes = head.data_size << 2;
+    else if(head.packtype == PluginLogPacket ||
+      head.packtype == PluginMSEEDPacket)
+        bytes = head.data_size;
+    else
+        bytes = 0;
+
+    if(bytes > PLUGIN_MAX_DATA_BYTES || bytes < 0)
+      {
+        logs(LOG_ERR) << "[" << name << "] invalid data size (" <<
+          head.data_size << ")" << endl;
+        return -1;
+      }
+
+    return bytes;
+  }
+
+// Creates the shared memory ring that is passed to the plugin as
+// PLUGIN_SHM_FD (see plugin_shm.h). The object is unlinked immediately,
+// so it disappears when both sides have closed it.
+
+void Plugin::ring_create()
+  {
+    static int count = 0;
+    char shm_name[64];
+    void *p;
+
+    ring_destroy();
+    if(!use_shm) return;
+    
+    snprintf(shm_name, sizeof(shm_name), "/seedlink.%d.%d", int(getpid()), ++count);
+
+    if((shm_fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600)) < 0)
+      {
+        logs(LOG_WARNING) << "[" << name << "] cannot create shared memory "
+          "(" << strerror(errno) << "), using pipe" << endl;
+        return;
+      }
+
+    shm_unlink(shm_name);
+    N(fcntl(shm_fd, F_SETFD, FD_CLOEXEC));
+
+    if(ftruncate(shm_fd, sizeof(PluginShmRing)) < 0 ||
+      (p = mmap(NULL, sizeof(PluginShmRing), PROT_READ | PROT_WRITE,
+      MAP_SHARED, shm_fd, 0)) == MAP_FAILED)
+      {
+        logs(LOG_WARNING) << "[" << name << "] cannot map shared memory "
+          "(" << strerror(errno) << "), using pipe" << endl;
+        close(shm_fd);
+        shm_fd = -1;
+        return;
+      }
+
+    ring = static_cast<PluginShmRing *>(p);
+    ring->magic = PLUGIN_SHM_MAGIC;
+    ring->version = PLUGIN_SHM_VERSION;
+    ring->nslots = PLUGIN_SHM_SLOTS;
+    ring->slot_size = sizeof(PluginShmSlot);
+  }
+
+void Plugin::ring_destroy()
+  {
+    if(ring != NULL) munmap(ring, sizeof(PluginShmRing));
+    ring = NULL;
+
+    if(shm_fd >= 0) close(shm_fd);
+    shm_fd = -1;
+  }
+
+bool Plugin::ring_read(PluginPacketHeader &head, void *data)
+  {
+    if(ring == NULL) return false;
+
+    uint32_t tail = ring->tail;
+    if(ring->head == tail) return false;
+
+    __sync_synchronize();
+
+    PluginShmSlot &slot = ring->slots[tail & (PLUGIN_SHM_SLOTS - 1)];
+    int bytes = data_size(slot.head);
+
+    if(bytes >= 0)
+      {
+        head = slot.head;
+        memcpy(data, slot.data, bytes);
+      }
+
+    __sync_synchronize();
+    ring->tail = tail + 1;
+
+    if(bytes < 0)
+      {
+        shutdown();
+        return false;
+      }
+
+    if(!data_available)
+      {
+        logs(LOG_INFO) << "[" << name << "] data is available (shared memory)" << endl;
+        data_available = true;
+      }
+
+    return true;
+  }
+
+// Asks the plugin to send a wakeup packet through the pipe when the next
+// packet is put into the ring. Returns true if the ring is not empty. The
+// flag is also set before the plugin has claimed the ring, so its first
+// packets wake us up as well.
+
+bool Plugin::ring_wait()
+  {
+    if(ring == NULL) return false;
+
+    ring->waiting = 1;
+    __sync_synchronize();
+
+    if(ring->head != ring->tail)
+      {
+        ring->waiting = 0;
+        return true;
+      }
+
+    return false;
+  }
+
 bool Plugin::read(PluginPacketHeader &head, void *data)
   {
+    // Packets left in the ring by a terminated plugin are still delivered
+    if(ring_read(head, data))
+      {
+        read_timer.reset();
+        return true;
+      }
+
     if(!child_active)
       {
         if(pid <= 0)
@@ -539,11 +694,23 @@ bool Plugin::read(PluginPacketHeader &head, void *data)
     
         if(nleft == 0)
           {
+            if(header_buf.packtype == PluginWakeupPacket)
+              {
+                if(ring_read(head, data)) return true;
+                continue;
+              }
+
             head = header_buf;
             memcpy(data, data_buf, data_bytes);
             return true;
           }
       }
+
+    if(ring_wait() && ring_read(head, data))
+      {
+        read_timer.reset();
+        return true;
+      }
     
     if(shutdown_requested)
       {
@@ -1254,7 +1421,8 @@ void PluginDef::end_attributes(ostream &cfglog)
         return;
       }
     
-    plugins.push_back(new Plugin(plugin_name, cmd, timeout, start_retry, shutdown_wait));
+    plugins.push_back(new Plugin(plugin_name, cmd, timeout, start_retry, shutdown_wait,
+      plugin_shm));
     plugins_defined.insert(plugin_name);
   }
 
@@ -1414,7 +1582,7 @@ try
           ::network_id, monitor, ::request_log, max_connections,
           max_connections_per_ip, trusted_info_level, untrusted_info_level,
           trusted_window_extraction, untrusted_window_extraction, bytespersec,
-          0, 100000);
+          0, 100000, io_epoll);
       }
     
     rc_ptr<BufferStore> bufs = connectionManager->register_station(station_key,
@@ -1686,6 +1854,7 @@ rc_ptr<CfgAttributeMap> SeedlinkDef::start_attributes(ostream &cfglog,
     atts->add_item(IntAttribute("plugin_timeout", plugin_timeout, 0, IntAttribute::lower_bound));
     atts->add_item(IntAttribute("plugin_start_retry", plugin_start_retry, 0, IntAttribute::lower_bound));
     atts->add_item(IntAttribute("plugin_shutdown_wait", plugin_shutdown_wait, 0, IntAttribute::lower_bound));
+    atts->add_item(BoolAttribute("plugin_shm", plugin_shm, "enabled", "disabled"));
     atts->add_item(StringAttribute("network", network_id));
     atts->add_item(StringAttribute("organization", organization));
     atts->add_item(StringAttribute("encoding", seed_encoding));
@@ -1703,6 +1872,7 @@ rc_ptr<CfgAttributeMap> SeedlinkDef::start_attributes(ostream &cfglog,
     atts->add_item(InfoLevelAttribute("info_trusted", trusted_info_level));
     atts->add_item(BoolAttribute("window_extraction", untrusted_window_extraction, "enabled", "disabled"));
     atts->add_item(BoolAttribute("window_extraction_trusted", trusted_window_extraction, "enabled", "disabled"));
+    atts->add_item(BoolAttribute("io_backend", io_epoll, "epoll", "select"));
 
     return atts;
   }
@@ -16,15 +16,28 @@
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include "plugin.h"
+#include "plugin_shm.h"
 
 static int send_log_helper(const char *station, const struct ptime *pt,
   const char *fmt, va_list argptr);
 static int send_packet(const struct PluginPacketHeader *head,
   const void *dataptr, int data_bytes);
+static int send_shm(const struct PluginPacketHeader *head,
+  const void *dataptr, int data_bytes);
+static int send_wakeup(int force);
+static void shm_attach(void);
+static void shm_detach(void);
 static ssize_t writen(int fd, const void *vptr, size_t n);
 
+/* 0: not checked yet, 1: ring is used, -1: pipe is used */
+static int shm_state = 0;
+static struct PluginShmRing *shm_ring = NULL;
+
 int send_raw3(const char *station, const char *channel, const struct ptime *pt,
   int usec_correction, int timing_quality, const int32_t *dataptr,
   int number_of_samples)
@@ -271,6 +284,12 @@ int send_packet(const struct PluginPacketHeader *head, const void *dataptr,
   {
     int r;
     
+    if(shm_state == 0)
+        shm_attach();
+
+    if(shm_state > 0)
+        return send_shm(head, dataptr, data_bytes);
+
     if((r = writen(PLUGIN_FD, head, sizeof(struct PluginPacketHeader))) <= 0)
         return r;
     
@@ -280,6 +299,110 @@ int send_packet(const struct PluginPacketHeader *head, const void *dataptr,
     return data_bytes;
   }
 
+/* Claims the ring passed by SeedLink, if any */
+void shm_attach(void)
+  {
+    struct stat st;
+    struct PluginShmRing *ring;
+    void *p;
+
+    shm_state = -1;
+    
+    if(fstat(PLUGIN_SHM_FD, &st) < 0 || !S_ISREG(st.st_mode) ||
+      st.st_size < (off_t) sizeof(struct PluginShmRing))
+        return;
+
+    if((p = mmap(NULL, sizeof(struct PluginShmRing), PROT_READ | PROT_WRITE,
+      MAP_SHARED, PLUGIN_SHM_FD, 0)) == MAP_FAILED)
+        return;
+
+    ring = (struct PluginShmRing *) p;
+    
+    if(ring->magic != PLUGIN_SHM_MAGIC || ring->version != PLUGIN_SHM_VERSION ||
+      ring->nslots != PLUGIN_SHM_SLOTS ||
+      ring->slot_size != sizeof(struct PluginShmSlot) ||
+      !__sync_bool_compare_and_swap(&ring->owner, 0, (int32_t) getpid()))
+      {
+        munmap(p, sizeof(struct PluginShmRing));
+        return;
+      }
+
+    /* The mapping stays valid; children must not inherit the ring */
+    close(PLUGIN_SHM_FD);
+    pthread_atfork(NULL, NULL, shm_detach);
+
+    shm_ring = ring;
+    shm_state = 1;
+  }
+
+/* Called in the child after fork(), which must use the pipe */
+void shm_detach(void)
+  {
+    shm_ring = NULL;
+    shm_state = -1;
+  }
+
+int send_shm(const struct PluginPacketHeader *head, const void *dataptr,
+  int data_bytes)
+  {
+    struct PluginShmRing *ring = shm_ring;
+    struct PluginShmSlot *slot;
+    uint32_t h = ring->head;
+    useconds_t delay = 100;
+    useconds_t slept = 0;
+
+    /* Wait until SeedLink releases a slot, doubling the delay up to
+     * 10 ms. A wakeup packet is forced about once per second, so we
+     * notice if SeedLink is gone. */
+    while(h - ring->tail >= PLUGIN_SHM_SLOTS)
+      {
+        if(send_wakeup(slept >= 1000000) < 0)
+            return -1;
+
+        if(slept >= 1000000)
+            slept = 0;
+
+        usleep(delay);
+        slept += delay;
+
+        if(delay < 10000)
+            delay *= 2;
+      }
+
+    __sync_synchronize();
+
+    slot = &ring->slots[h & (PLUGIN_SHM_SLOTS - 1)];
+    slot->head = *head;
+    if(dataptr != NULL)
+        memcpy(slot->data, dataptr, data_bytes);
+
+    __sync_synchronize();
+    ring->head = h + 1;
+    __sync_synchronize();
+
+    if(send_wakeup(0) < 0)
+        return -1;
+
+    return data_bytes;
+  }
+
+int send_wakeup(int force)
+  {
+    struct PluginPacketHeader head;
+
+    if(!force && !(shm_ring->waiting &&
+      __sync_lock_test_and_set(&shm_ring->waiting, 0)))
+        return 0;
+
+    memset(&head, 0, sizeof(struct PluginPacketHeader));
+    head.packtype = PluginWakeupPacket;
+
+    if(writen(PLUGIN_FD, &head, sizeof(struct PluginPacketHeader)) <= 0)
+        return -1;
+
+    return 0;
+  }
+
 ssize_t writen(int fd, const void *vptr, size_t n)
   {
     ssize_t nwritten;
@@ -35,7 +35,8 @@ enum PluginPacketType
     PluginRawDataGapPacket,
     PluginRawDataFlushPacket,
     PluginLogPacket,
-    PluginMSEEDPacket
+    PluginMSEEDPacket,
+    PluginWakeupPacket      /* see plugin_shm.h */
   };
 
 struct ptime
@@ -0,0 +1,63 @@
+/*****************************************************************************
+ * plugin_shm.h
+ *
+ * Shared memory transport between SeedLink and plugins
+ *
+ * (c) 2026 GFZ Potsdam
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any later
+ * version. For more information, see http://www.gnu.org/
+ *****************************************************************************/
+
+/*
+ * If enabled, SeedLink passes a shared memory object to the plugin as
+ * PLUGIN_SHM_FD in addition to the pipe on PLUGIN_FD. The object contains
+ * a single-producer single-consumer ring of packet slots. The first
+ * process that sends a packet claims the ring by storing its pid in
+ * "owner"; all other processes (eg., children of chain_plugin) and plugins
+ * that do not know about the ring keep using the pipe, which SeedLink
+ * always reads as well.
+ *
+ * The producer fills the slot at "head" and publishes it by incrementing
+ * "head". The consumer releases a slot by incrementing "tail". Before the
+ * consumer waits for the pipe, it sets "waiting"; a producer that finds
+ * "waiting" set clears it and writes a PluginWakeupPacket to the pipe.
+ */
+
+#ifndef PLUGIN_SHM_H
+#define PLUGIN_SHM_H
+
+#include <stdint.h>
+
+#include "plugin.h"
+
+#define PLUGIN_SHM_FD             (PLUGIN_FD - 3)  /* 61 and 62 are used by chain_plugin */
+#define PLUGIN_SHM_MAGIC          0x534c5348       /* "SLSH" */
+#define PLUGIN_SHM_VERSION        1
+#define PLUGIN_SHM_SLOTS          128              /* must be a power of 2 */
+
+struct PluginShmSlot
+  {
+    struct PluginPacketHeader head;
+    char data[PLUGIN_MAX_DATA_BYTES];
+  };
+
+struct PluginShmRing
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nslots;
+    uint32_t slot_size;
+    volatile int32_t owner;
+    volatile int32_t waiting;
+    char pad1[40];
+    volatile uint32_t head;    /* written by the plugin */
+    char pad2[60];
+    volatile uint32_t tail;    /* written by SeedLink */
+    char pad3[60];
+    struct PluginShmSlot slots[PLUGIN_SHM_SLOTS];
+  };
+
+#endif /* PLUGIN_SHM_H */
@@ -0,0 +1,305 @@
+/*****************************************************************************
+ * shmtest.cc
+ *
+ * Test and benchmark of the plugin transports (pipe and shared memory)
+ *
+ * Usage: testpluginshm [packets]
+ *
+ * Forks a producer that sends numbered Mini-SEED packets with send_mseed(),
+ * once through the pipe only and once with a shared memory ring. The
+ * consumer reads them like SeedLink does: it drains the ring, sets the
+ * waiting flag before sleeping on the pipe and handles wakeup packets.
+ * Checks that all packets arrive in order and reports the wall clock time
+ * and the CPU time of producer plus consumer for both transports.
+ *
+ * (c) GFZ Potsdam
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any later
+ * version. For more information, see http://www.gnu.org/
+ *****************************************************************************/
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "plugin.h"
+#include "plugin_shm.h"
+
+using namespace std;
+
+namespace {
+
+double seconds(const timeval &tv)
+  {
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+  }
+
+double now()
+  {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return seconds(tv);
+  }
+
+double cpu_time(int who)
+  {
+    rusage ru;
+    getrusage(who, &ru);
+    return seconds(ru.ru_utime) + seconds(ru.ru_stime);
+  }
+
+bool readn(int fd, void *buf, size_t n)
+  {
+    char *p = static_cast<char *>(buf);
+
+    while(n > 0)
+      {
+        ssize_t r = read(fd, p, n);
+        if(r <= 0) return false;
+        p += r;
+        n -= r;
+      }
+
+    return true;
+  }
+
+PluginShmRing *ring_create(int &fd)
+  {
+    char name[64];
+    snprintf(name, sizeof(name), "/testpluginshm.%d", int(getpid()));
+
+    if((fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600)) < 0)
+        return NULL;
+
+    shm_unlink(name);
+
+    void *p;
+    if(ftruncate(fd, sizeof(PluginShmRing)) < 0 ||
+      (p = mmap(NULL, sizeof(PluginShmRing), PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0)) == MAP_FAILED)
+      {
+        close(fd);
+        return NULL;
+      }
+
+    PluginShmRing *ring = static_cast<PluginShmRing *>(p);
+    ring->magic = PLUGIN_SHM_MAGIC;
+    ring->version = PLUGIN_SHM_VERSION;
+    ring->nslots = PLUGIN_SHM_SLOTS;
+    ring->slot_size = sizeof(PluginShmSlot);
+    return ring;
+  }
+
+// Same protocol as Plugin::ring_read() in seedlink.cc
+bool ring_read(PluginShmRing *ring, int &seq)
+  {
+    if(ring == NULL) return false;
+
+    uint32_t tail = ring->tail;
+    if(ring->head == tail) return false;
+
+    __sync_synchronize();
+    memcpy(&seq, ring->slots[tail & (PLUGIN_SHM_SLOTS - 1)].data, sizeof(int));
+    __sync_synchronize();
+    ring->tail = tail + 1;
+    return true;
+  }
+
+// Same protocol as Plugin::ring_wait() in seedlink.cc
+bool ring_wait(PluginShmRing *ring)
+  {
+    if(ring == NULL) return false;
+
+    ring->waiting = 1;
+    __sync_synchronize();
+
+    if(ring->head != ring->tail)
+      {
+        ring->waiting = 0;
+        return true;
+      }
+
+    return false;
+  }
+
+void produce(int packets)
+  {
+    char rec[PLUGIN_MSEED_SIZE];
+    memset(rec, 0, sizeof(rec));
+
+    for(int i = 0; i < packets; ++i)
+      {
+        memcpy(rec, &i, sizeof(int));
+        if(send_mseed("TEST", rec, sizeof(rec)) != int(sizeof(rec)))
+            _exit(1);
+      }
+
+    _exit(0);
+  }
+
+// Returns false if packets are lost or out of order
+bool run(bool use_shm, int packets)
+  {
+    const char *name = use_shm? "shm": "pipe";
+
+    int pfd[2];
+    if(pipe(pfd) < 0)
+      {
+        perror("pipe");
+        return false;
+      }
+
+    int shm_fd = -1;
+    PluginShmRing *ring = NULL;
+    if(use_shm && (ring = ring_create(shm_fd)) == NULL)
+      {
+        perror("shm_open");
+        return false;
+      }
+
+    double cpu_self = cpu_time(RUSAGE_SELF);
+    double cpu_children = cpu_time(RUSAGE_CHILDREN);
+    double start = now();
+
+    pid_t pid = fork();
+    if(pid < 0)
+      {
+        perror("fork");
+        return false;
+      }
+
+    if(pid == 0)
+      {
+        close(pfd[0]);
+        dup2(pfd[1], PLUGIN_FD);
+        if(shm_fd >= 0) dup2(shm_fd, PLUGIN_SHM_FD);
+        produce(packets);
+      }
+
+    close(pfd[1]);
+    if(shm_fd >= 0) close(shm_fd);
+
+    int expected = 0, from_ring = 0, wakeups = 0;
+    bool ok = true;
+
+    while(ok && expected < packets)
+      {
+        int seq;
+
+        if(!ring_read(ring, seq))
+          {
+            if(!ring_wait(ring))
+              {
+                fd_set rfds;
+                FD_ZERO(&rfds);
+                FD_SET(pfd[0], &rfds);
+                timeval tv = {5, 0};
+                if(select(pfd[0] + 1, &rfds, NULL, NULL, &tv) <= 0)
+                  {
+                    cerr << name << ": timeout after " << expected << " packets" << endl;
+                    ok = false;
+                    break;
+                  }
+              }
+
+            // Handles the pipe the same way whether or not select() was called
+            if(ring_read(ring, seq))
+              {
+                ++from_ring;
+              }
+            else
+              {
+                PluginPacketHeader head;
+                char data[PLUGIN_MAX_DATA_BYTES];
+
+                if(!readn(pfd[0], &head, sizeof(head)))
+                  {
+                    cerr << name << ": producer terminated after " << expected << " packets" << endl;
+                    ok = false;
+                    break;
+                  }
+
+                if(head.packtype == PluginWakeupPacket)
+                  {
+                    ++wakeups;
+                    continue;
+                  }
+
+                if(head.data_size < int(sizeof(int)) ||
+                  head.data_size > PLUGIN_MAX_DATA_BYTES ||
+                  !readn(pfd[0], data, head.data_size))
+                  {
+                    cerr << name << ": bad packet" << endl;
+                    ok = false;
+                    break;
+                  }
+
+                memcpy(&seq, data, sizeof(int));
+              }
+          }
+        else
+          {
+            ++from_ring;
+          }
+
+        if(seq != expected)
+          {
+            cerr << name << ": packet " << seq << " received, " << expected << " expected" << endl;
+            ok = false;
+          }
+
+        ++expected;
+      }
+
+    int status;
+    if(!ok) kill(pid, SIGKILL);
+    waitpid(pid, &status, 0);
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      {
+        cerr << name << ": producer failed" << endl;
+        ok = false;
+      }
+
+    double wall = now() - start;
+    double cpu = (cpu_time(RUSAGE_SELF) - cpu_self) +
+      (cpu_time(RUSAGE_CHILDREN) - cpu_children);
+
+    if(use_shm && ok && from_ring != packets)
+      {
+        cerr << name << ": only " << from_ring << " packets came through the ring" << endl;
+        ok = false;
+      }
+
+    printf("%-4s %d packets: wall %.3f s, cpu %.3f s, %d wakeups%s\n", name,
+      packets, wall, cpu, wakeups, ok? "": "  FAILED");
+
+    close(pfd[0]);
+    if(ring != NULL) munmap(ring, sizeof(PluginShmRing));
+    return ok;
+  }
+
+} // unnamed namespace
+
+int main(int argc, char **argv)
+  {
+    int packets = (argc > 1)? atoi(argv[1]): 200000;
+    int errors = 0;
+
+    if(!run(false, packets)) ++errors;
+    if(!run(true, packets)) ++errors;
+
+    return errors? 1: 0;
+  }
+
@@ -46,6 +46,7 @@
 #include "cppstreams.h"
 #include "utils.h"
 #include "plugin.h"
+#include "plugin_shm.h"
 #include "plugin_exceptions.h"
 #include "descriptor.h"
 #include "diag.h"
@@ -1787,6 +1788,10 @@ void Extension::start()
         close(command_pipe[1]);
       }
 
+    // The shared memory ring of SeedLink (if not claimed yet) belongs to
+    // chain_plugin; extensions send their data through the pipe.
+    close(PLUGIN_SHM_FD);
+
     logs(LOG_INFO) << "[" << name << "] starting shell" << endl;
     
     execl(SHELL, SHELL, "-c", (cmdline + " " + name).c_str(), NULL);
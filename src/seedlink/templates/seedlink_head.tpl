@@ -92,6 +92,9 @@ connections_per_ip = "$connections_per_ip"
 * Maximum speed per connection (0: throttle disabled)
 bytespersec = "$bytespersec"
 
+* Method used to wait for client connections (select or epoll)
+io_backend = "$io_backend"
+
 * Defaults for all plugins. All of these parameters take value in seconds;
 * zero disables the corresponding feature.
 * 
@@ -108,3 +111,8 @@ plugin_timeout = 0
 plugin_start_retry = 60
 plugin_shutdown_wait = 10
 
+* Pass packets from plugins through a shared memory ring instead of the
+* pipe (enabled or disabled). Plugins built with an older plugin library
+* keep using the pipe.
+plugin_shm = "$plugin_shm"
+
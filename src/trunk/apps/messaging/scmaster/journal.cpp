@@ -0,0 +1,489 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT MASTER_COM_MODULE
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/utils/files.h>
+
+#include <algorithm>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "journal.h"
+
+
+namespace Seiscomp {
+namespace Communication {
+
+
+namespace {
+
+
+const uint32_t RecordMagic = 0x524a4353; // "SCJR"
+const char *SegmentSuffix = ".jnl";
+
+
+// Followed by destination, private sender group and data. Records are
+// padded to a multiple of 8 bytes.
+struct RecordHeader {
+	uint32_t magic;
+	uint32_t size;
+	int32_t  type;
+	int32_t  seqNum;
+	int64_t  timestamp;
+	uint32_t destinationLength;
+	uint32_t senderLength;
+	uint32_t dataLength;
+	uint32_t messageSize;
+};
+
+
+inline size_t align8(size_t size) {
+	return (size + 7) & ~size_t(7);
+}
+
+
+inline const RecordHeader *header(const char *data, size_t offset) {
+	return reinterpret_cast<const RecordHeader*>(data + offset);
+}
+
+
+// Returns whether a complete record is stored at offset. A segment
+// ends with the first invalid record.
+bool validRecord(const char *data, size_t capacity, size_t offset) {
+	if ( offset + sizeof(RecordHeader) > capacity ) return false;
+
+	const RecordHeader *h = header(data, offset);
+	if ( h->magic != RecordMagic ) return false;
+	if ( h->size < sizeof(RecordHeader) || offset + h->size > capacity ) return false;
+
+	return sizeof(RecordHeader) + (size_t)h->destinationLength +
+	       h->senderLength + h->dataLength <= h->size;
+}
+
+
+// Segments are named after the position of their first record. The
+// zero padding lets a lexical sort restore the order.
+std::string segmentName(uint64_t firstRecord) {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%020llu", (unsigned long long)firstRecord);
+	return std::string(buf) + SegmentSuffix;
+}
+
+
+}
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+MessageJournal::MessageJournal()
+: _segmentSize(0), _maxSize(0), _maxAge(0), _firstRecord(0), _size(0) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+MessageJournal::~MessageJournal() {
+	close();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MessageJournal::open(const std::string &directory, size_t segmentSize,
+                          size_t maxSize, int maxAge) {
+	close();
+
+	if ( !Util::pathExists(directory) && !Util::createPath(directory) ) {
+		SEISCOMP_ERROR("journal: could not create directory %s", directory.c_str());
+		return false;
+	}
+
+	DIR *dir = opendir(directory.c_str());
+	if ( dir == NULL ) {
+		SEISCOMP_ERROR("journal: could not open directory %s: %s",
+		               directory.c_str(), strerror(errno));
+		return false;
+	}
+
+	std::vector<std::string> names;
+	struct dirent *entry;
+	size_t suffixLength = strlen(SegmentSuffix);
+	while ( (entry = readdir(dir)) != NULL ) {
+		std::string name = entry->d_name;
+		if ( name.size() > suffixLength &&
+		     name.compare(name.size()-suffixLength, suffixLength, SegmentSuffix) == 0 )
+			names.push_back(name);
+	}
+	closedir(dir);
+
+	std::sort(names.begin(), names.end());
+
+	_directory = directory;
+	_segmentSize = segmentSize;
+	_maxSize = maxSize;
+	_maxAge = maxAge;
+
+	for ( size_t i = 0; i < names.size(); ++i ) {
+		uint64_t first = strtoull(names[i].c_str(), NULL, 10);
+
+		// Positions must be contiguous, start over after a gap
+		if ( _segments.empty() || first != end() ) {
+			if ( !_segments.empty() )
+				SEISCOMP_WARNING("journal: gap in front of segment %s, "
+				                 "dropping older segments", names[i].c_str());
+			while ( !_segments.empty() ) removeOldest();
+			_firstRecord = first;
+		}
+
+		loadSegment(_directory + "/" + names[i], first);
+	}
+
+	trim(time(NULL));
+
+	SEISCOMP_INFO("journal: opened %s with %d messages in %d segments",
+	              _directory.c_str(), (int)_records.size(), (int)_segments.size());
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MessageJournal::close() {
+	for ( size_t i = 0; i < _segments.size(); ++i )
+		unmapSegment(_segments[i]);
+
+	_segments.clear();
+	_records.clear();
+	_index.clear();
+	_firstRecord = 0;
+	_size = 0;
+	_directory.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MessageJournal::append(const NetworkMessage *msg) {
+	if ( _directory.empty() ) return false;
+
+	const std::string &destination = msg->destination();
+	const std::string &sender = msg->privateSenderGroup();
+	const std::string &data = msg->data();
+
+	size_t size = align8(sizeof(RecordHeader) + destination.size() +
+	                     sender.size() + data.size());
+
+	// Segments loaded from disk are never written to
+	Segment *segment = _segments.empty() ? NULL : _segments.back();
+	if ( segment == NULL || segment->fd < 0 || segment->used + size > segment->capacity ) {
+		if ( !addSegment(size) ) return false;
+		segment = _segments.back();
+	}
+
+	size_t offset = segment->used;
+	char *p = segment->data + offset + sizeof(RecordHeader);
+	memcpy(p, destination.data(), destination.size());
+	p += destination.size();
+	memcpy(p, sender.data(), sender.size());
+	p += sender.size();
+	memcpy(p, data.data(), data.size());
+
+	// Write the header last so that an interrupted write leaves an
+	// invalid record that terminates the segment
+	RecordHeader h;
+	h.magic = RecordMagic;
+	h.size = (uint32_t)size;
+	h.type = msg->type();
+	h.seqNum = msg->seqNum();
+	h.timestamp = (int64_t)msg->timestamp();
+	h.destinationLength = (uint32_t)destination.size();
+	h.senderLength = (uint32_t)sender.size();
+	h.dataLength = (uint32_t)data.size();
+	h.messageSize = msg->size();
+	memcpy(segment->data + offset, &h, sizeof(h));
+
+	segment->used += size;
+	_size += size;
+	addRecord(segment, offset);
+
+	trim(msg->timestamp());
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MessageJournal::find(int seqNum, time_t timestamp, uint64_t &position) const {
+	Index::const_iterator it = _index.find(Key(seqNum, timestamp));
+	if ( it == _index.end() ) return false;
+	position = it->second;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+uint64_t MessageJournal::end() const {
+	return _firstRecord + _records.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t MessageJournal::read(uint64_t &position, uint64_t last, size_t count,
+                            std::vector<NetworkMessage*> &msgs) const {
+	if ( position < _firstRecord ) position = _firstRecord;
+	if ( last > end() ) last = end();
+
+	size_t n = 0;
+	while ( position < last && n < count ) {
+		const Record &r = _records[position - _firstRecord];
+		const RecordHeader *h = header(r.segment->data, r.offset);
+		const char *p = r.segment->data + r.offset + sizeof(RecordHeader);
+
+		NetworkMessage *msg = new NetworkMessage;
+		msg->setType(h->type);
+		msg->setDestination(std::string(p, h->destinationLength));
+		p += h->destinationLength;
+		msg->setPrivateSenderGroup(std::string(p, h->senderLength));
+		p += h->senderLength;
+		msg->setData(std::string(p, h->dataLength));
+		msg->setSize(h->messageSize);
+		msg->tag(h->seqNum, (time_t)h->timestamp);
+
+		msgs.push_back(msg);
+		++position;
+		++n;
+	}
+
+	return n;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t MessageJournal::messageCount() const {
+	return _records.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t MessageJournal::size() const {
+	return _size;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+MessageJournal::Segment *
+MessageJournal::mapSegment(const std::string &path, size_t capacity, bool create) {
+	int fd = ::open(path.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+	if ( fd < 0 ) {
+		SEISCOMP_ERROR("journal: could not open %s: %s", path.c_str(), strerror(errno));
+		return NULL;
+	}
+
+	// Reserve the disk space up front. Writing to a sparse mapping raises
+	// SIGBUS if the disk is full.
+	if ( create ) {
+		int err = posix_fallocate(fd, 0, capacity);
+		if ( err != 0 ) {
+			SEISCOMP_ERROR("journal: could not allocate %lu bytes for %s: %s",
+			               (unsigned long)capacity, path.c_str(), strerror(err));
+			::close(fd);
+			unlink(path.c_str());
+			return NULL;
+		}
+	}
+
+	void *data = mmap(NULL, capacity, create ? PROT_READ | PROT_WRITE : PROT_READ,
+	                  MAP_SHARED, fd, 0);
+	if ( data == MAP_FAILED ) {
+		SEISCOMP_ERROR("journal: could not map %s: %s", path.c_str(), strerror(errno));
+		::close(fd);
+		if ( create ) unlink(path.c_str());
+		return NULL;
+	}
+
+	Segment *segment = new Segment;
+	segment->path = path;
+	segment->data = static_cast<char*>(data);
+	segment->capacity = capacity;
+
+	// Only segments that are written to keep their descriptor
+	if ( create )
+		segment->fd = fd;
+	else
+		::close(fd);
+
+	return segment;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MessageJournal::unmapSegment(Segment *segment) {
+	munmap(segment->data, segment->capacity);
+	if ( segment->fd >= 0 ) ::close(segment->fd);
+	delete segment;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MessageJournal::loadSegment(const std::string &path, uint64_t firstRecord) {
+	struct stat st;
+	if ( stat(path.c_str(), &st) != 0 || st.st_size <= 0 ) {
+		unlink(path.c_str());
+		return false;
+	}
+
+	Segment *segment = mapSegment(path, (size_t)st.st_size, false);
+	if ( segment == NULL ) return false;
+
+	segment->firstRecord = firstRecord;
+	_segments.push_back(segment);
+
+	size_t offset = 0;
+	while ( validRecord(segment->data, segment->capacity, offset) ) {
+		addRecord(segment, offset);
+		offset += header(segment->data, offset)->size;
+	}
+
+	segment->used = offset;
+	_size += segment->used;
+
+	if ( segment->recordCount == 0 ) {
+		_segments.pop_back();
+		unmapSegment(segment);
+		unlink(path.c_str());
+		return false;
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MessageJournal::addSegment(size_t minCapacity) {
+	size_t capacity = std::max(_segmentSize, align8(minCapacity));
+	uint64_t first = end();
+
+	Segment *segment = mapSegment(_directory + "/" + segmentName(first), capacity, true);
+	if ( segment == NULL ) return false;
+
+	segment->firstRecord = first;
+	_segments.push_back(segment);
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MessageJournal::removeOldest() {
+	Segment *segment = _segments.front();
+
+	for ( size_t i = 0; i < segment->recordCount; ++i ) {
+		const RecordHeader *h = header(segment->data, _records.front().offset);
+		Index::iterator it = _index.find(Key(h->seqNum, (time_t)h->timestamp));
+		if ( it != _index.end() && it->second == _firstRecord )
+			_index.erase(it);
+
+		_records.pop_front();
+		++_firstRecord;
+	}
+
+	_size -= segment->used;
+	_segments.pop_front();
+
+	std::string path = segment->path;
+	unmapSegment(segment);
+	unlink(path.c_str());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MessageJournal::trim(time_t now) {
+	// The newest segment is kept in any case
+	while ( _segments.size() > 1 ) {
+		const Segment *oldest = _segments.front();
+		bool tooLarge = _maxSize > 0 && _size > _maxSize;
+		bool tooOld = _maxAge > 0 && oldest->lastTimestamp + _maxAge < now;
+		if ( !tooLarge && !tooOld ) break;
+		removeOldest();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MessageJournal::addRecord(Segment *segment, size_t offset) {
+	const RecordHeader *h = header(segment->data, offset);
+
+	_index[Key(h->seqNum, (time_t)h->timestamp)] = end();
+	_records.push_back(Record(segment, offset));
+
+	++segment->recordCount;
+	if ( (time_t)h->timestamp > segment->lastTimestamp )
+		segment->lastTimestamp = (time_t)h->timestamp;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+}
+}
@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __COM_JOURNAL_H__
+#define __COM_JOURNAL_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <seiscomp3/communication/systemmessages.h>
+
+
+namespace Seiscomp {
+namespace Communication {
+
+
+/**
+ * \brief Append only message journal on disk
+ *
+ * Messages are appended to segment files of a fixed size which are
+ * memory mapped. When a segment is full a new one is started. The oldest
+ * segments are removed when the journal exceeds its size budget or when
+ * all their messages are older than the configured maximum age.
+ *
+ * Every message gets a position that increases monotonically over the
+ * lifetime of the journal, also across restarts. Positions are looked up
+ * by the sequence number and timestamp of a message which is what clients
+ * send with an archive request.
+ *
+ * The class is not thread safe.
+ */
+class MessageJournal {
+	// ----------------------------------------------------------------------
+	//  X'struction
+	// ----------------------------------------------------------------------
+	public:
+		MessageJournal();
+		~MessageJournal();
+
+
+	// ----------------------------------------------------------------------
+	//  Public interface
+	// ----------------------------------------------------------------------
+	public:
+		/**
+		 * Opens a journal directory and loads the segments stored there.
+		 * @param directory The directory, created if it does not exist
+		 * @param segmentSize The size of a segment file in bytes
+		 * @param maxSize The maximum size of all segments in bytes
+		 * @param maxAge The maximum age of messages in seconds, 0 disables
+		 *               the age limit
+		 */
+		bool open(const std::string &directory, size_t segmentSize,
+		          size_t maxSize, int maxAge);
+
+		void close();
+
+		/**
+		 * Appends a tagged message.
+		 * @return False if no segment could be created for the message,
+		 *         e.g. because the disk is full
+		 */
+		bool append(const NetworkMessage *msg);
+
+		//! Looks up the position of a message
+		bool find(int seqNum, time_t timestamp, uint64_t &position) const;
+
+		//! Returns the position behind the last message
+		uint64_t end() const;
+
+		/**
+		 * Reads up to count messages starting at position and stopping
+		 * before last. Position is advanced behind the last read message.
+		 * If position has been removed already reading starts with the
+		 * oldest message. The caller takes ownership of the messages.
+		 * @return The number of messages read
+		 */
+		size_t read(uint64_t &position, uint64_t last, size_t count,
+		            std::vector<NetworkMessage*> &msgs) const;
+
+		//! Returns the number of messages in the journal
+		size_t messageCount() const;
+
+		//! Returns the number of bytes used by all segments
+		size_t size() const;
+
+
+	// ----------------------------------------------------------------------
+	//  Private interface
+	// ----------------------------------------------------------------------
+	private:
+		struct Segment {
+			Segment() : fd(-1), data(NULL), capacity(0), used(0),
+			            firstRecord(0), recordCount(0), lastTimestamp(0) {}
+
+			std::string path;
+			// Only set for the segment that is written to
+			int         fd;
+			char       *data;
+			size_t      capacity;
+			size_t      used;
+			uint64_t    firstRecord;
+			size_t      recordCount;
+			time_t      lastTimestamp;
+		};
+
+		struct Record {
+			Record() : segment(NULL), offset(0) {}
+			Record(Segment *s, size_t o) : segment(s), offset(o) {}
+
+			Segment *segment;
+			size_t   offset;
+		};
+
+		typedef std::pair<int, time_t> Key;
+		typedef std::map<Key, uint64_t> Index;
+
+		Segment *mapSegment(const std::string &path, size_t capacity, bool create);
+		void unmapSegment(Segment *segment);
+
+		bool loadSegment(const std::string &path, uint64_t firstRecord);
+		bool addSegment(size_t minCapacity);
+		void removeOldest();
+		void trim(time_t now);
+
+		void addRecord(Segment *segment, size_t offset);
+
+
+	// ----------------------------------------------------------------------
+	//  Private members
+	// ----------------------------------------------------------------------
+	private:
+		std::string           _directory;
+		size_t                _segmentSize;
+		size_t                _maxSize;
+		int                   _maxAge;
+
+		std::deque<Segment*>  _segments;
+		std::deque<Record>    _records;
+		uint64_t              _firstRecord;
+		size_t                _size;
+		Index                 _index;
+};
+
+
+}
+}
+
+
+#endif
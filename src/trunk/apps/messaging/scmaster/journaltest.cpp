@@ -0,0 +1,253 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+// Appends more messages than the in-memory archive holds to a journal
+// with small segments, replays them from a sequence number, reopens the
+// journal, trims it by size and checks that the disk space of the segments
+// is allocated and that a segment that cannot be allocated makes append
+// fail without leaving a file behind.
+// Usage: testmessagejournal [messages]
+
+
+#include <seiscomp3/communication/protocol.h>
+#include <seiscomp3/communication/systemmessages.h>
+#include <seiscomp3/core/strings.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "journal.h"
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::Communication;
+
+
+namespace {
+
+
+const size_t SegmentSize = 256*1024;
+const time_t StartTime = 1420070400;
+
+
+NetworkMessage *createMessage(int i) {
+	NetworkMessage *msg = new NetworkMessage;
+	msg->setType(i % 3);
+	msg->setDestination(i % 2 ? "PICK" : "LOCATION");
+	msg->setPrivateSenderGroup("#test#" + Core::toString(i % 7));
+	msg->setData(string(100 + i % 200, 'a' + i % 26));
+	msg->setSize(msg->data().size());
+	msg->tag(i, StartTime + i / 100);
+	return msg;
+}
+
+
+bool sameMessage(const NetworkMessage *msg, int i) {
+	NetworkMessage *expected = createMessage(i);
+	bool same = msg->type() == expected->type() &&
+	            msg->destination() == expected->destination() &&
+	            msg->privateSenderGroup() == expected->privateSenderGroup() &&
+	            msg->data() == expected->data() &&
+	            msg->size() == expected->size() &&
+	            msg->seqNum() == expected->seqNum() &&
+	            msg->timestamp() == expected->timestamp();
+	delete expected;
+	return same;
+}
+
+
+// Returns the number of segment files and optionally the number of
+// segments whose disk space has not been allocated completely
+int segmentFiles(const string &directory, int *sparse = NULL) {
+	DIR *dir = opendir(directory.c_str());
+	if ( dir == NULL ) return -1;
+
+	int n = 0;
+	if ( sparse ) *sparse = 0;
+
+	struct dirent *entry;
+	while ( (entry = readdir(dir)) != NULL ) {
+		string name = entry->d_name;
+		if ( name.size() <= 4 || name.compare(name.size()-4, 4, ".jnl") != 0 )
+			continue;
+
+		++n;
+
+		struct stat st;
+		if ( sparse && stat((directory + "/" + name).c_str(), &st) == 0 &&
+		     (off_t)st.st_blocks * 512 < st.st_size )
+			++*sparse;
+	}
+
+	closedir(dir);
+	return n;
+}
+
+
+// Replays all messages behind message first and checks them
+bool replay(const MessageJournal &journal, int first, int messages) {
+	uint64_t position;
+	if ( !journal.find(first, StartTime + first / 100, position) ) {
+		fprintf(stderr, "message %d not found\n", first);
+		return false;
+	}
+
+	int next = first;
+	vector<NetworkMessage*> msgs;
+	bool ok = true;
+
+	while ( ok && journal.read(position, journal.end(), 100, msgs) > 0 ) {
+		for ( size_t i = 0; i < msgs.size(); ++i, ++next ) {
+			if ( ok && !sameMessage(msgs[i], next) ) {
+				fprintf(stderr, "message %d differs\n", next);
+				ok = false;
+			}
+			delete msgs[i];
+		}
+		msgs.clear();
+	}
+
+	if ( ok && next != messages ) {
+		fprintf(stderr, "replay from %d ended at %d instead of %d\n",
+		        first, next, messages);
+		ok = false;
+	}
+
+	return ok;
+}
+
+
+}
+
+
+int main(int argc, char **argv) {
+	int messages = argc > 1 ? atoi(argv[1]) : 2*Protocol::MASTER_ARCHIVE_SIZE + 500;
+	int errors = 0;
+
+	char tmpl[] = "/tmp/testmessagejournal.XXXXXX";
+	if ( mkdtemp(tmpl) == NULL ) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	string directory = tmpl;
+
+	{
+		MessageJournal journal;
+		if ( !journal.open(directory, SegmentSize, 64*1024*1024, 0) ) {
+			fprintf(stderr, "could not open the journal in %s\n", directory.c_str());
+			return 1;
+		}
+
+		for ( int i = 0; i < messages; ++i ) {
+			NetworkMessage *msg = createMessage(i);
+			if ( !journal.append(msg) ) {
+				fprintf(stderr, "could not append message %d\n", i);
+				++errors;
+			}
+			delete msg;
+		}
+
+		int sparse;
+		int segments = segmentFiles(directory, &sparse);
+		printf("appended %d messages, %lu bytes in %d segments\n",
+		       (int)journal.messageCount(), (unsigned long)journal.size(), segments);
+
+		if ( (int)journal.messageCount() != messages || segments < 2 ) {
+			fprintf(stderr, "expected %d messages in several segments\n", messages);
+			++errors;
+		}
+
+		// Writing to a sparse segment raises SIGBUS if the disk is full
+		if ( sparse > 0 ) {
+			fprintf(stderr, "%d segments are sparse\n", sparse);
+			++errors;
+		}
+
+		if ( !replay(journal, 100, messages) ) ++errors;
+	}
+
+	// Reopen with a size limit that keeps the newer segments only
+	{
+		MessageJournal journal;
+		size_t maxSize = 4*SegmentSize;
+		if ( !journal.open(directory, SegmentSize, maxSize, 0) ) {
+			fprintf(stderr, "could not reopen the journal\n");
+			return 1;
+		}
+
+		int first = messages - (int)journal.messageCount();
+		printf("reopened with %d messages in %d segments, first is %d\n",
+		       (int)journal.messageCount(), segmentFiles(directory), first);
+
+		uint64_t position;
+		if ( journal.find(0, StartTime, position) || journal.size() > maxSize ||
+		     first <= 0 ) {
+			fprintf(stderr, "journal has not been trimmed\n");
+			++errors;
+		}
+
+		if ( !replay(journal, first, messages) ) ++errors;
+	}
+
+	system(("rm -rf " + directory).c_str());
+
+	// A file size limit below the segment size makes the allocation of
+	// the first segment fail like a full disk
+	char tmpl2[] = "/tmp/testmessagejournal.XXXXXX";
+	if ( mkdtemp(tmpl2) == NULL ) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	directory = tmpl2;
+
+	{
+		signal(SIGXFSZ, SIG_IGN);
+
+		struct rlimit limit, saved;
+		getrlimit(RLIMIT_FSIZE, &saved);
+		limit = saved;
+		limit.rlim_cur = SegmentSize / 2;
+		setrlimit(RLIMIT_FSIZE, &limit);
+
+		MessageJournal journal;
+		journal.open(directory, SegmentSize, 64*1024*1024, 0);
+
+		NetworkMessage *msg = createMessage(0);
+		bool appended = journal.append(msg);
+		delete msg;
+
+		setrlimit(RLIMIT_FSIZE, &saved);
+
+		printf("append without disk space %s, %d segments left\n",
+		       appended ? "succeeded" : "failed", segmentFiles(directory));
+
+		if ( appended || segmentFiles(directory) != 0 ) {
+			fprintf(stderr, "append without disk space should fail and "
+			        "remove the segment\n");
+			++errors;
+		}
+	}
+
+	system(("rm -rf " + directory).c_str());
+
+	return errors ? 1 : 0;
+}
@@ -262,6 +262,42 @@ bool Master::init() {
 		_password = "";
 	}
 
+	std::string journalDirectory;
+	try {
+		journalDirectory = conf.getString("journal.directory");
+	}
+	catch ( const Config::Exception & ) {}
+
+	if ( !journalDirectory.empty() ) {
+		int segmentSize = 64;
+		int maxSize = 1024;
+		int maxAge = 86400;
+
+		try { segmentSize = conf.getInt("journal.segmentSize"); }
+		catch ( const Config::Exception & ) {}
+		try { maxSize = conf.getInt("journal.maxSize"); }
+		catch ( const Config::Exception & ) {}
+		try { maxAge = conf.getInt("journal.maxAge"); }
+		catch ( const Config::Exception & ) {}
+
+		if ( segmentSize <= 0 || maxSize < segmentSize ) {
+			SEISCOMP_ERROR("Invalid journal size: segmentSize = %dMB, maxSize = %dMB",
+			               segmentSize, maxSize);
+			return false;
+		}
+
+		journalDirectory = Environment::Instance()->absolutePath(journalDirectory);
+
+		_journal = std::auto_ptr<MessageJournal>(new MessageJournal);
+		if ( !_journal->open(journalDirectory, (size_t)segmentSize*1024*1024,
+		                     (size_t)maxSize*1024*1024, maxAge) ) {
+			SEISCOMP_ERROR("Could not open message journal in %s", journalDirectory.c_str());
+			return false;
+		}
+
+		SEISCOMP_INFO("Archiving messages in %s", journalDirectory.c_str());
+	}
+
 	readPluginNames(conf, "core.plugins");
 	readPluginNames(conf, "plugins");
 
@@ -831,8 +867,9 @@ int Master::sendAndArchive(NetworkMessage* msg) {
 		return Core::Status::SEISCOMP_FAILURE;
 	}
 
-	// Releasing the message is handled by the message archive
-	archiveMsg(msg);
+	// Releasing the message is handled by the message archive unless
+	// the journal is used which stores a copy
+	bool archived = archiveMsg(msg);
 
 	SEISCOMP_DEBUG("Forwarding message to group: %s ", msg->destination().c_str());
 
@@ -841,6 +878,8 @@ int Master::sendAndArchive(NetworkMessage* msg) {
 	if ( ret != Core::Status::SEISCOMP_SUCCESS )
 		SEISCOMP_WARNING("Error: Could not forward message to %s", msg->destination().c_str());
 
+	if ( !archived ) delete msg;
+
 	return ret;
 }
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
@@ -971,14 +1010,32 @@ void Master::reconnect() {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-void Master::archiveMsg(NetworkMessage* msg) {
+bool Master::archiveMsg(NetworkMessage* msg) {
 	boost::mutex::scoped_lock lock(_archiveMutex);
 
+	// The archive is indexed by sequence number, tag the message now
+	// rather than in sendRaw
+	{
+		boost::mutex::scoped_lock sendLock(_sendMutex);
+		tagMsg(msg);
+	}
+
+	if ( _journal.get() ) {
+		if ( _journal->append(msg) ) return false;
+
+		// Most likely the disk is full. Archive in memory from now on
+		// rather than losing every further message.
+		SEISCOMP_ERROR("Could not write message %d to the journal, archiving "
+		               "messages in memory from now on", msg->seqNum());
+		_journal.reset();
+	}
+
 	int idx = (msg->seqNum() % Protocol::MASTER_ARCHIVE_SIZE);
 	if ( (*_archive) [idx] != NULL )
 		delete (*_archive) [idx];
 
 	(*_archive) [idx] = msg;
+	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -987,11 +1044,60 @@ void Master::archiveMsg(NetworkMessage* msg) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Master::handleArchiveRequest(ServiceMessage* msg) {
-	boost::mutex::scoped_lock lock(_archiveMutex);
-
 	int seqNum = msg->archiveSeqNum();
 	time_t timestamp = msg->archiveTimestamp();
 
+	uint64_t position, last;
+	bool journal, found;
+
+	// The journal is dropped by archiveMsg if writing fails
+	{
+		boost::mutex::scoped_lock lock(_archiveMutex);
+		journal = _journal.get() != NULL;
+		if ( journal ) {
+			found = _journal->find(seqNum, timestamp, position);
+			last = _journal->end();
+		}
+	}
+
+	if ( journal ) {
+		if ( !found ) {
+			SEISCOMP_INFO("Archive message %d/%d not available in the journal",
+			              seqNum, (int)timestamp);
+			NetworkMessagePtr tmpMsg = createMsg(Protocol::INVAlID_ARCHIVE_REQUEST_MSG);
+			tmpMsg->setDestination(msg->privateSenderGroup());
+			send(tmpMsg.get());
+			return;
+		}
+
+		// Messages are read in chunks to not block archiving while they
+		// are sent
+		std::vector<NetworkMessage*> msgs;
+		while ( position < last ) {
+			msgs.clear();
+
+			{
+				boost::mutex::scoped_lock lock(_archiveMutex);
+				if ( _journal.get() == NULL ||
+				     _journal->read(position, last, 100, msgs) == 0 ) break;
+			}
+
+			for ( size_t i = 0; i < msgs.size(); ++i ) {
+				// Ignore service messages
+				if ( msgs[i]->type() >= 0 ) {
+					msgs[i]->setType(Protocol::ARCHIVE_MSG);
+					send(msgs[i]);
+				}
+
+				delete msgs[i];
+			}
+		}
+
+		return;
+	}
+
+	boost::mutex::scoped_lock lock(_archiveMutex);
+
 	int idx = seqNum % Protocol::MASTER_ARCHIVE_SIZE;
 
 	NetworkMessage* archiveMsg = (*_archive) [idx];
@@ -32,6 +32,7 @@
 #include <seiscomp3/utils/timer.h>
 
 #include "clientdb.h"
+#include "journal.h"
 
 
 namespace Seiscomp {
@@ -152,8 +153,12 @@ private:
 	//! Sets a timestamp and a sequenze number.
 	void tagMsg(NetworkMessage* msg);
 
-	//! Archives passed messages
-	void archiveMsg(NetworkMessage* msg);
+	/**
+	 * Archives passed messages.
+	 * @return True if the in-memory archive took the ownership of the
+	 *         message, false if the journal stored a copy
+	 */
+	bool archiveMsg(NetworkMessage* msg);
 
 	/** Sends the requested data to client. The messages which will be send comprise
 	 * all data from the given sequence number to the latest archive index.
@@ -208,6 +213,9 @@ private:
 	//! Archive for the received messages
 	std::auto_ptr<std::vector<NetworkMessage*> > _archive;
 
+	//! Disk backed archive, replaces _archive if configured
+	std::auto_ptr<MessageJournal> _journal;
+
 	//! Stores the data sent by the clients connect call
 	ClientDB _clientDB;
 
@@ -25,6 +25,8 @@
 #include <seiscomp3/core/status.h>
 #include <seiscomp3/core/system.h>
 
+#include <boost/bind.hpp>
+
 
 namespace Seiscomp {
 namespace Communication {
@@ -43,8 +45,41 @@ ADD_SC_PLUGIN(
 )
 
 
+namespace {
+
+
+// The archive observes the destruction of all objects in the process to
+// keep its id cache clean. With a writer thread only objects created by
+// that thread can be part of the cache and notifications from other
+// threads (e.g. the master decoding messages) must not touch it.
+class WriterArchive : public DataModel::DatabaseArchive {
+	public:
+		WriterArchive(IO::DatabaseInterface *db)
+		: DataModel::DatabaseArchive(db) {}
+
+		void setThread(boost::thread::id id) {
+			_thread = id;
+		}
+
+	protected:
+		void onObjectDestroyed(DataModel::Object *object) {
+			if ( _thread == boost::thread::id() ||
+			     _thread == boost::this_thread::get_id() )
+				DataModel::DatabaseArchive::onObjectDestroyed(object);
+		}
+
+	private:
+		boost::thread::id _thread;
+};
+
+
+}
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-DbPlugin::DbPlugin() {}
+DbPlugin::DbPlugin()
+: _queueSize(0), _flushInterval(0), _writer(NULL), _writerRunning(false)
+, _maxQueueDepth(0), _flushes(0), _flushTime(0), _maxFlushTime(0) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -52,6 +87,7 @@ DbPlugin::DbPlugin() {}
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 DbPlugin::~DbPlugin() {
+	stopWriter();
 	disconnectFromDb();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -63,9 +99,105 @@ DbPlugin::~DbPlugin() {
 bool DbPlugin::process(NetworkMessage *nmsg, Core::Message *message) {
 	if ( !message || !nmsg ) return true;
 
-	SEISCOMP_DEBUG("Writing message to database");
+	bool hasNotifiers = false;
+	for ( Core::MessageIterator it = message->iter(); *it != NULL; ++it ) {
+		if ( DataModel::Notifier::Cast(*it) != NULL ) {
+			hasNotifiers = true;
+			break;
+		}
+	}
+
+	if ( !hasNotifiers ) return true;
+
+	if ( _writer == NULL ) {
+		SEISCOMP_DEBUG("Writing message to database");
+		flush(Batch(1, nmsg), message);
+		// For now we return true otherwise the master will stop because
+		// e.g. an erroneous module sends the same notifier twice or more
+		return true;
+	}
+
+	NetworkMessage *copy = nmsg->copy();
+	size_t depth;
+
+	{
+		boost::mutex::scoped_lock lock(_queueMutex);
+		// Block the master if the writer cannot keep up
+		while ( _queue.size() >= _queueSize && _writerRunning )
+			_queueNotFull.wait(lock);
+		_queue.push_back(copy);
+		depth = _queue.size();
+	}
+
+	_queueNotEmpty.notify_one();
+
+	boost::mutex::scoped_lock lock(_statsMutex);
+	if ( depth > _maxQueueDepth ) _maxQueueDepth = depth;
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void DbPlugin::flush(const Batch &batch, Core::Message *decoded) {
+	Util::StopWatch stopWatch;
+	Counters counters;
+	bool success = true;
+
+	_db->start();
+
+	for ( size_t i = 0; i < batch.size(); ++i ) {
+		Core::MessagePtr msg = decoded;
+		if ( !msg ) msg = batch[i]->decode();
+		if ( !write(batch[i], msg.get(), true, counters) ) {
+			success = false;
+			break;
+		}
+	}
+
+	if ( success )
+		_db->commit();
+	else {
+		// A failed statement aborts the whole transaction with some
+		// databases. Write each notifier on its own to skip only the
+		// erroneous ones. The messages are decoded again to not reuse
+		// object ids cached during the rolled back transaction.
+		if ( _db->isConnected() ) _db->rollback();
+
+		SEISCOMP_DEBUG("Transaction of %d message(s) failed, writing notifiers "
+		               "one by one", (int)batch.size());
+
+		counters = Counters();
+		for ( size_t i = 0; i < batch.size(); ++i ) {
+			Core::MessagePtr msg = batch[i]->decode();
+			write(batch[i], msg.get(), false, counters);
+		}
+	}
+
+	double elapsed = (double)stopWatch.elapsed();
+
+	boost::mutex::scoped_lock lock(_statsMutex);
+	_addedObjects += counters.added;
+	_updatedObjects += counters.updated;
+	_removedObjects += counters.removed;
+	_errors += counters.errors;
+	++_flushes;
+	_flushTime += elapsed;
+	if ( elapsed > _maxFlushTime ) _maxFlushTime = elapsed;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool DbPlugin::write(NetworkMessage *nmsg, Core::Message *message,
+                     bool abortOnError, Counters &counters) {
+	if ( message == NULL ) return true;
 
-	int error = 0;
 	for ( Core::MessageIterator it = message->iter(); *it != NULL; ++it ) {
 		DataModel::Notifier* notifier = DataModel::Notifier::Cast(*it);
 		if ( notifier != NULL && notifier->object() != NULL ) {
@@ -73,27 +205,26 @@ bool DbPlugin::process(NetworkMessage *nmsg, Core::Message *message) {
 			while ( !result ) {
 				switch ( notifier->operation() ) {
 					case DataModel::OP_ADD: {
-						++_addedObjects;
+						++counters.added;
 						DataModel::DatabaseObjectWriter writer(*_dbArchive.get());
 						result = writer(notifier->object(), notifier->parentID());
-						if (!result) --error;
 					}
 						break;
 					case DataModel::OP_REMOVE:
-						++_removedObjects;
+						++counters.removed;
 						result = _dbArchive->remove(notifier->object(), notifier->parentID());
-						if (!result) --error;
 						break;
 					case DataModel::OP_UPDATE:
-						++_updatedObjects;
+						++counters.updated;
 						result = _dbArchive->update(notifier->object(), notifier->parentID());
-						if (!result) --error;
 						break;
 					default:
 						break;
 				}
 
 				if ( !result ) {
+					if ( abortOnError ) return false;
+
 					if ( !_db->isConnected() ) {
 						SEISCOMP_ERROR("Lost connection to database: %s", _dbWriteConnection.c_str());
 						while ( !connectToDb() );
@@ -113,7 +244,7 @@ bool DbPlugin::process(NetworkMessage *nmsg, Core::Message *message) {
 
 						// If no client connection error occurred -> go ahead because
 						// wrong queries cannot be fixed here
-						++_errors;
+						++counters.errors;
 						result = true;
 					}
 				}
@@ -121,9 +252,6 @@ bool DbPlugin::process(NetworkMessage *nmsg, Core::Message *message) {
 		}
 	}
 
-	// For now we return true otherwise the master will stop because
-	// e.g. an erroneous module sends the same notifier twice or more
-	//return (error < 0) ? false : true;
 	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -131,25 +259,122 @@ bool DbPlugin::process(NetworkMessage *nmsg, Core::Message *message) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void DbPlugin::startWriter() {
+	boost::mutex::scoped_lock lock(_queueMutex);
+	_writerRunning = true;
+	_writer = new boost::thread(boost::bind(&DbPlugin::writerLoop, this));
+	// The writer waits for the queue lock before touching any object
+	static_cast<WriterArchive*>(_dbArchive.get())->setThread(_writer->get_id());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void DbPlugin::stopWriter() {
+	if ( _writer == NULL ) return;
+
+	{
+		boost::mutex::scoped_lock lock(_queueMutex);
+		_writerRunning = false;
+	}
+
+	_queueNotEmpty.notify_all();
+	_queueNotFull.notify_all();
+
+	// The writer flushes all pending messages before it returns
+	_writer->join();
+	delete _writer;
+	_writer = NULL;
+
+	for ( size_t i = 0; i < _queue.size(); ++i )
+		delete _queue[i];
+	_queue.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void DbPlugin::writerLoop() {
+	// Messages are decoded in this thread, do not register the
+	// objects globally as the master does not either
+	DataModel::PublicObject::SetRegistrationEnabled(false);
+
+	Batch batch;
+
+	while ( true ) {
+		{
+			boost::mutex::scoped_lock lock(_queueMutex);
+			while ( _queue.empty() && _writerRunning )
+				_queueNotEmpty.wait(lock);
+
+			if ( _queue.empty() ) break;
+		}
+
+		// Let more messages queue up to write them in one transaction
+		if ( _flushInterval > 0 )
+			Core::msleep(_flushInterval);
+
+		{
+			boost::mutex::scoped_lock lock(_queueMutex);
+			batch.assign(_queue.begin(), _queue.end());
+			_queue.clear();
+		}
+
+		_queueNotFull.notify_all();
+
+		flush(batch);
+
+		for ( size_t i = 0; i < batch.size(); ++i )
+			delete batch[i];
+		batch.clear();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DbPlugin::printStateOfHealthInformation(std::ostream &os) const {
+	size_t depth;
+	{
+		boost::mutex::scoped_lock lock(_queueMutex);
+		depth = _queue.size();
+	}
+
+	boost::mutex::scoped_lock lock(_statsMutex);
+
 	double elapsed = (double)_stopper.elapsed();
 	if ( elapsed > 0.0 ) {
 		double aa = _addedObjects / elapsed;
 		double au = _updatedObjects / elapsed;
 		double ar = _removedObjects / elapsed;
 		double ae = _errors / elapsed;
+		double fa = _flushes > 0 ? _flushTime * 1000.0 / _flushes : 0.0;
+		double fm = _maxFlushTime * 1000.0;
 
-		SEISCOMP_INFO("DBPLUGIN (aps,ups,dps,errors) %.2f %.2f %.2f %.2f",
-		              aa, au, ar, ae);
+		SEISCOMP_INFO("DBPLUGIN (aps,ups,dps,errors) %.2f %.2f %.2f %.2f, "
+		              "queue %d (max %d), flush avg %.1f ms (max %.1f ms)",
+		              aa, au, ar, ae, (int)depth, (int)_maxQueueDepth, fa, fm);
 
 		_stopper.restart();
 		_addedObjects = _updatedObjects = _removedObjects = _errors = 0;
+		_maxQueueDepth = depth;
+		_flushes = 0;
+		_flushTime = _maxFlushTime = 0;
 
 		os << "dbadds=" << aa << "&"
 		   << "dbupdates=" << au << "&"
 		   << "dbdeletes=" << ar << "&"
-		   << "dberrors=" << ae << "&";
+		   << "dberrors=" << ae << "&"
+		   << "dbqueue=" << depth << "&"
+		   << "dbflushavg=" << fa << "&"
+		   << "dbflushmax=" << fm << "&";
 	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -203,6 +428,17 @@ bool DbPlugin::init(Config::Config& conf, const std::string& configPrefix) {
 		_strictVersionMatch = true;
 	}
 
+	try {
+		int queueSize = conf.getInt(configPrefix + "dbPlugin.queueSize");
+		_queueSize = queueSize > 0 ? (size_t)queueSize : 0;
+	}
+	catch ( Config::Exception& ) {}
+
+	try {
+		_flushInterval = conf.getInt(configPrefix + "dbPlugin.flushInterval");
+	}
+	catch ( Config::Exception& ) {}
+
 	SEISCOMP_DEBUG("Checking database '%s' and trying to connect with '%s'",
 	               _dbDriver.c_str(), _dbWriteConnection.c_str());
 
@@ -218,6 +454,12 @@ bool DbPlugin::init(Config::Config& conf, const std::string& configPrefix) {
 	_stopper.restart();
 	_addedObjects = _updatedObjects = _removedObjects = _errors = 0;
 
+	if ( res && _queueSize > 0 && _dbArchive ) {
+		SEISCOMP_INFO("Writing to database asynchronously with a queue of %d messages",
+		              (int)_queueSize);
+		startWriter();
+	}
+
 	return res;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -227,6 +469,7 @@ bool DbPlugin::init(Config::Config& conf, const std::string& configPrefix) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool DbPlugin::close() {
+	stopWriter();
 	disconnectFromDb();
 	return true;
 }
@@ -254,7 +497,13 @@ bool DbPlugin::connectToDb() {
 
 	SEISCOMP_INFO("Database connection established");
 
-	_dbArchive = new DataModel::DatabaseArchive(_db.get());
+	// Reuse the archive after a reconnect. A new archive would have to
+	// register itself as object observer while other threads destroy
+	// objects.
+	if ( !_dbArchive )
+		_dbArchive = new WriterArchive(_db.get());
+	else
+		_dbArchive->setDriver(_db.get());
 
 	if ( !_dbArchive ) {
 		SEISCOMP_ERROR("DbPlugin: Could not create DBArchive");
@@ -13,8 +13,14 @@
 #ifndef __DBPLUGIN_H__
 #define __DBPLUGIN_H__
 
+#include <deque>
 #include <iostream>
 #include <string>
+#include <vector>
+
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <seiscomp3/utils/timer.h>
 #include <seiscomp3/communication/masterplugininterface.h>
@@ -56,9 +62,35 @@ public:
 	// PRIVATE INTERFACE
 	// --------------------------------------------------------------------------
 private:
+	typedef std::vector<NetworkMessage*> Batch;
+
+	struct Counters {
+		Counters() : added(0), updated(0), removed(0), errors(0) {}
+		size_t added;
+		size_t updated;
+		size_t removed;
+		size_t errors;
+	};
+
 	bool connectToDb();
 	void disconnectFromDb();
 
+	//! Writes the notifiers of a batch of messages in one transaction.
+	//! If the transaction fails it is rolled back and the messages are
+	//! written one by one without transaction.
+	void flush(const Batch &batch, Core::Message *decoded = NULL);
+
+	//! Writes all notifiers of a message. If abortOnError is set the
+	//! first failing notifier stops writing and false is returned,
+	//! otherwise errors are counted and lost connections are
+	//! reestablished.
+	bool write(NetworkMessage *nmsg, Core::Message *msg, bool abortOnError,
+	           Counters &counters);
+
+	void startWriter();
+	void stopWriter();
+	void writerLoop();
+
 
 private:
 	Seiscomp::IO::DatabaseInterfacePtr      _db;
@@ -68,6 +100,24 @@ private:
 	std::string                             _dbReadConnection;
 	bool                                    _strictVersionMatch;
 
+	// Write behind queue. Messages are copied on the master thread and
+	// decoded by the writer thread so that no object is shared between
+	// both threads.
+	size_t                                  _queueSize;
+	int                                     _flushInterval;
+	std::deque<NetworkMessage*>             _queue;
+	mutable boost::mutex                    _queueMutex;
+	boost::condition                        _queueNotEmpty;
+	boost::condition                        _queueNotFull;
+	boost::thread                          *_writer;
+	bool                                    _writerRunning;
+
+	mutable boost::mutex                    _statsMutex;
+	mutable size_t                          _maxQueueDepth;
+	mutable size_t                          _flushes;
+	mutable double                          _flushTime;
+	mutable double                          _maxFlushTime;
+
 	mutable Util::StopWatch                 _stopper;
 
 	mutable size_t                          _addedObjects;
@@ -265,6 +265,7 @@ bool App::initConfiguration() {
 	try { _config.cleanupInterval = configGetDouble("autoloc.cleanupInterval"); } catch (...) {}
 	try { _wakeUpTimout = configGetInt("autoloc.wakeupInterval"); } catch (...) {}
 	try { _config.maxRadiusFactor = configGetDouble("autoloc.gridsearch._maxRadiusFactor"); } catch (...) {}
+	try { _config.nucleatorThreads = configGetInt("autoloc.gridsearch.threads"); } catch (...) {}
 
 	try { _config.publicationIntervalTimeSlope = configGetDouble("autoloc.publicationIntervalTimeSlope"); } catch ( ... ) {}
 	try { _config.publicationIntervalTimeIntercept = configGetDouble("autoloc.publicationIntervalTimeIntercept"); } catch ( ... ) {}
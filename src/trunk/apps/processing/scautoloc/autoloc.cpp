@@ -2788,6 +2788,7 @@ bool Autoloc3::setGridFile(const string &gridfile)
 	if ( ! _nucleator.setGridFile(gridfile))
 		return false;
 	_nucleator._config.maxRadiusFactor = _config.maxRadiusFactor;
+	_nucleator._config.threads = _config.nucleatorThreads;
 	return true;
 }
 
@@ -160,6 +160,10 @@ class Autoloc3 {
 			// EXPERIMENTAL!!!
 			double maxRadiusFactor;
 
+			// Number of threads used by the nucleator to feed a pick
+			// into the grid. 1 means no additional threads.
+			int nucleatorThreads;
+
 			// EXPERIMENTAL!!!
 			NetworkType networkType;
 
@@ -128,6 +128,7 @@ Autoloc3::Config::Config()
 	reportAllPhases = false;
 
 	maxRadiusFactor = 1;
+	nucleatorThreads = 1;
 	networkType = Autoloc::GlobalNetwork;
 
 	publicationIntervalTimeSlope = 0.5;
@@ -171,6 +172,7 @@ void Autoloc3::Config::dump() const
 // This isn't used still so we don't want to confuse the user....
 //	SEISCOMP_INFO("useImportedOrigins               %s",     useImportedOrigins ? "true":"false");
 	SEISCOMP_INFO("locatorProfile                   %s",     locatorProfile.c_str());
+	SEISCOMP_INFO("nucleatorThreads                 %d",     nucleatorThreads);
 
 	if ( ! xxlEnabled) {
 		SEISCOMP_INFO("XXL feature is not enabled");
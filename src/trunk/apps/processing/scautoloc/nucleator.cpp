@@ -24,6 +24,9 @@
 #include <set>
 #include <list>
 #include <math.h>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
 using namespace std;
 
 #include "util.h"
@@ -56,10 +59,112 @@ void Nucleator::setStations(const StationDB *stations)
 		setup();
 }
 
+struct GridSearch::Workers {
+	Workers(Grid &grid, int count)
+	: grid(grid), pick(NULL), cells(NULL), next(0), running(0), generation(0), quit(false) {
+		for ( int i = 0; i < count; ++i )
+			threads.create_thread(boost::bind(&Workers::run, this));
+	}
+
+	~Workers() {
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			quit = true;
+		}
+		wakeUp.notify_all();
+		threads.join_all();
+	}
+
+	// Runs GridPoint::cluster for the given grid points and blocks until
+	// all of them are done. The calling thread takes part in the work.
+	void feed(const Pick *p, const StationCells &c) {
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			pick = p;
+			cells = &c;
+			next = 0;
+			running = threads.size();
+			hits.assign(c.size(), 0);
+			++generation;
+		}
+
+		wakeUp.notify_all();
+		work();
+
+		boost::mutex::scoped_lock lock(mutex);
+		while ( running > 0 )
+			finished.wait(lock);
+	}
+
+	void run() {
+		unsigned int seen = 0;
+
+		while ( true ) {
+			{
+				boost::mutex::scoped_lock lock(mutex);
+				while ( !quit && generation == seen )
+					wakeUp.wait(lock);
+				if ( quit ) return;
+				seen = generation;
+			}
+
+			work();
+
+			boost::mutex::scoped_lock lock(mutex);
+			if ( --running == 0 )
+				finished.notify_all();
+		}
+	}
+
+	// Grid points are handed out in small chunks because their cost
+	// differs a lot, e.g. between the global and a regional fine grid
+	void work() {
+		static const size_t ChunkSize = 32;
+
+		while ( true ) {
+			size_t begin;
+			{
+				boost::mutex::scoped_lock lock(mutex);
+				begin = next;
+				next += ChunkSize;
+			}
+
+			if ( begin >= cells->size() ) break;
+
+			size_t end = std::min(begin + ChunkSize, cells->size());
+			for ( size_t i = begin; i < end; ++i ) {
+				const StationCell &cell = (*cells)[i];
+				hits[i] = grid[cell.index]->cluster(pick, cell.wrapper) ? 1 : 0;
+			}
+		}
+	}
+
+	Grid                &grid;
+	boost::thread_group  threads;
+	boost::mutex         mutex;
+	boost::condition     wakeUp;
+	boost::condition     finished;
+	const Pick          *pick;
+	const StationCells  *cells;
+	size_t               next;
+	int                  running;
+	unsigned int         generation;
+	bool                 quit;
+	std::vector<char>    hits;
+};
+
+
 GridSearch::GridSearch()
 {
 	_stations = 0;
 	_abort = false;
+	_workers = NULL;
+}
+
+
+GridSearch::~GridSearch()
+{
+	delete _workers;
 }
 
 
@@ -84,32 +189,51 @@ int GridSearch::cleanup(const Time& minTime)
 		count += gridpoint->cleanup(minTime);
 	}
 
+	// A projected pick is never later than its pick, so the grid does
+	// not refer to picks older than minTime anymore
+	for (std::set<PickCPtr>::iterator it=_activePicks.begin(); it!=_activePicks.end(); ) {
+		if ((*it)->time < minTime)
+			_activePicks.erase(it++);
+		else
+			++it;
+	}
+
 	return count;
 }
 
-static int _projectedPickCount=0;
+static volatile int _projectedPickCount=0;
+
+// Projected picks are created and destroyed by the grid search workers
+static inline void countProjectedPick(int n)
+{
+#ifdef __GNUC__
+	__sync_add_and_fetch(&_projectedPickCount, n);
+#else
+	_projectedPickCount += n;
+#endif
+}
 
 ProjectedPick::ProjectedPick(const Time &t)
-	: _projectedTime(t)
+	: _projectedTime(t), p(NULL)
 {
-	_projectedPickCount++;
+	countProjectedPick(1);
 }
 
-ProjectedPick::ProjectedPick(PickCPtr p, StationWrapperCPtr w)
+ProjectedPick::ProjectedPick(const Pick *p, StationWrapperCPtr w)
 	: _projectedTime(p->time - w->ttime), p(p), wrapper(w)
 {
-	_projectedPickCount++;
+	countProjectedPick(1);
 }
 
 ProjectedPick::ProjectedPick(const ProjectedPick &other)
 	: _projectedTime(other._projectedTime), p(other.p), wrapper(other.wrapper)
 {
-	_projectedPickCount++;
+	countProjectedPick(1);
 }
 
 ProjectedPick::~ProjectedPick()
 {
-	_projectedPickCount--;
+	countProjectedPick(-1);
 }
 
 int ProjectedPick::count()
@@ -131,6 +255,16 @@ GridPoint::GridPoint(const Origin &origin)
 
 const Origin*
 GridPoint::feed(const Pick* pick)
+{
+	if ( ! cluster(pick))
+		return NULL;
+
+	return origin();
+}
+
+
+bool
+GridPoint::cluster(const Pick* pick)
 {
 	// find the station corresponding to the pick
 	const std::string key = station_key(pick->station());
@@ -139,13 +273,25 @@ GridPoint::feed(const Pick* pick)
 		xit = _wrappers.find(key);
 	if (xit==_wrappers.end())
 		// this grid cell may be out of range for that station
-		return NULL;
-	StationWrapperCPtr wrapper = (*xit).second;
+		return false;
+
+	return cluster(pick, (*xit).second.get());
+}
+
+
+bool
+GridPoint::cluster(const Pick* pick, const StationWrapper *wrapper)
+{
+	// Note that this is called from the grid search worker threads.
+	// It must not modify the reference count of shared objects such as
+	// the picks and stations.
+
 	if ( ! wrapper->station ) {
+		const std::string key = station_key(pick->station());
 		// TODO test in Nucleator::feed() and use logging
 		// TODO at this point probably an exception should be thrown
 		SEISCOMP_ERROR("Nucleator: station '%s' not found", key.c_str());
-		return NULL;
+		return false;
 		
 	}
 
@@ -155,12 +301,12 @@ GridPoint::feed(const Pick* pick)
 
 	// If the station distance exceeds the maximum station distance
 	// configured for the grid point...
-	if ( wrapper->distance > maxStaDist ) return NULL;
+	if ( wrapper->distance > maxStaDist ) return false;
 
 	// If the station distance exceeds the maximum nucleation distance
 	// configured for the station...
 	if ( wrapper->distance > wrapper->station->maxNucDist )
-		return NULL;
+		return false;
 
 	// back-project pick to hypothetical origin time
 	ProjectedPick pp(pick, wrapper);
@@ -180,7 +326,7 @@ GridPoint::feed(const Pick* pick)
 
 	// if the number of picks around the new pick is too low...
 	if (npick < _nmin)
-		return NULL;
+		return false;
 
 	// now take a closer look at how tightly clustered the picks are
 	double dt0 = 4; // XXX
@@ -220,18 +366,18 @@ GridPoint::feed(const Pick* pick)
 	for (int i=0; i<npick; i++)
 		sum += _flg[i];
 	if (sum < _nmin)
-		return NULL;
+		return false;
 
-	std::vector<ProjectedPick> group;
+	_group.clear();
 	int cntmax = 0;
-	Time otime;
+	_otime = Time();
 	for (int i=0; i<npick; i++) {
 		if ( ! _flg[i])
 			continue;
-		group.push_back(pps[i]);
+		_group.push_back(pps[i]);
 		if (_cnt[i] > cntmax) {
 			cntmax = _cnt[i];
-			otime = pps[i].projectedTime();
+			_otime = pps[i].projectedTime();
 		}
 	}
 
@@ -310,6 +456,16 @@ GridPoint::feed(const Pick* pick)
 
 //	double meandev = l1/npick;
 	
+	return true;
+}
+
+
+const Origin*
+GridPoint::origin()
+{
+	const std::vector<ProjectedPick> &group = _group;
+	const Time &otime = _otime;
+
 
 //	Origin* origin = new Origin(lat, lon, dep, otime);
 	_origin->arrivals.clear();
@@ -318,7 +474,7 @@ GridPoint::feed(const Pick* pick)
 	for (unsigned int i=0; i<group.size(); i++) {
 		const ProjectedPick &pp = group[i];
 
-		PickCPtr pick = pp.p;
+		const Pick *pick = pp.p;
 		const std::string key = station_key(pick->station());
 		// avoid duplicate stations XXX ugly without amplitudes
 		if( stations.count(key))
@@ -327,7 +483,7 @@ GridPoint::feed(const Pick* pick)
 
 		StationWrapperCPtr sw( _wrappers[key]);
 
-		Arrival arr(pick.get());
+		Arrival arr(pick);
 		arr.residual = pp.projectedTime() - otime;
 		arr.distance = sw->distance;
 		arr.azimuth  = sw->azimuth;
@@ -373,7 +529,7 @@ void GridPoint::setStations(const StationDB *stations)
 }
 
 
-bool GridPoint::setupStation(const Station *station)
+const StationWrapper *GridPoint::setupStation(const Station *station)
 {
 	double delta=0, az=0, baz=0;
 	delazi(this, station, delta, az, baz);
@@ -382,17 +538,17 @@ bool GridPoint::setupStation(const Station *station)
 	// range for that station - this reduces the memory used by
 	// the grid
 	if ( delta > station->maxNucDist )
-		return false;
+		return NULL;
 
 	TravelTime tt;
 	if ( ! travelTimeP(lat, lon, dep, station->lat, station->lon, 0, delta, tt))
-		return false;
+		return NULL;
 
 	StationWrapperCPtr sw = new StationWrapper(station, tt.phase, delta, az, tt.time, tt.dtdd);
 	std::string key = station_key (sw->station);
 	_wrappers[key] = sw;
 
-	return true;
+	return sw.get();
 }
 
 
@@ -646,23 +802,65 @@ bool GridSearch::feed(const Pick *pick)
 		SEISCOMP_DEBUG_S("GridSearch: setting up station " + net_sta);
 	}
 
+	// The travel time computation is not thread safe, the station
+	// is therefore set up for all grid points before feeding the pick.
+	// Grid points out of range of the station, either by the maximum
+	// nucleation distance of the station or the maximum station
+	// distance of the grid point, will never see a pick of the station
+	// and are not part of its cell list.
+	if (stationSetupNeeded) {
+		StationCells &cells = _stationCells[net_sta];
+		cells.clear();
+		for (size_t i=0; i<_grid.size(); ++i) {
+			GridPoint *gp = _grid[i].get();
+			const StationWrapper *wrapper = gp->setupStation(pick->station());
+			if ( ! wrapper || wrapper->distance > gp->maxStaDist)
+				continue;
+			cells.push_back(StationCell(i, wrapper));
+		}
+
+		SEISCOMP_DEBUG("GridSearch: station %s reaches %lu of %lu grid points",
+		               net_sta.c_str(), (unsigned long)cells.size(),
+		               (unsigned long)_grid.size());
+	}
+
+	StationCellMap::const_iterator cit = _stationCells.find(net_sta);
+	if (cit == _stationCells.end())
+		return false;
+	const StationCells &cells = (*cit).second;
+
+	_activePicks.insert(pick);
+
+	// Feed the new pick into the individual grid points, in parallel
+	// if configured. The candidate origins are then collected in grid
+	// order below, so the result does not depend on the thread count.
+	if (_config.threads > 1) {
+		if ( ! _workers)
+			_workers = new Workers(_grid, _config.threads-1);
+		_workers->feed(pick, cells);
+	}
+	else if (_workers) {
+		delete _workers;
+		_workers = NULL;
+	}
+
 	std::map<PickSet, OriginPtr> pickSetOriginMap;
 
 	// Main loop
 	//
-	// Feed the new pick into the individual grid points
+	// Build the origins of the grid points with a pick cluster
 	// and save all "candidate" origins in originVector
 
 	double maxScore = 0;
-	for (Grid::iterator it=_grid.begin(); it!=_grid.end(); ++it) {
+	for (size_t i=0; i<cells.size(); ++i) {
 
-		GridPoint *gp = it->get();
+		GridPoint *gp = _grid[cells[i].index].get();
 
-		if (stationSetupNeeded) {
-			gp->setupStation(pick->station());
-		}
+		bool hit = _workers ? _workers->hits[i] != 0 : gp->cluster(pick, cells[i].wrapper);
+		if ( ! hit)
+			continue;
 
-		const Origin *origin = gp->feed(pick);
+		const Origin *origin = gp->origin();
 		if ( ! origin)
 			continue;
 
@@ -773,6 +971,9 @@ bool GridSearch::_readGrid(const std::string &gridfile)
 	}
 
 	_grid.clear();
+	// The stations need to be set up again for the new grid
+	_stationCells.clear();
+	_configuredStations.clear();
 	double lat, lon, dep, rad, dmax; int nmin;
 	while ( ! ifile.eof() ) {
 		std::string line;
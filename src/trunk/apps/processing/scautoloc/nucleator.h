@@ -71,11 +71,14 @@ class GridPoint;
 DEFINE_SMARTPOINTER(GridPoint);
 typedef std::vector<GridPointPtr> Grid;
 
+class StationWrapper;
+
 
 class GridSearch : public Nucleator
 {
 	public:
 		GridSearch();
+		~GridSearch();
 
 	public:
 		// Configuration parameters controlling the behaviour of the Nucleator
@@ -97,6 +100,10 @@ class GridSearch : public Nucleator
 			std::string amplitudeType;
 		
 			int verbosity;
+
+			// number of threads feeding a pick into the grid,
+			// values <= 1 select the serial nucleator
+			int threads;
 		
 			Config() {
 				nmin = 5;
@@ -106,6 +113,7 @@ class GridSearch : public Nucleator
 				aminskip = 1;
 				amplitudeType = "snr"; // XXX not yet used
 				verbosity = 0;
+				threads = 1;
 			}
 		};
 
@@ -143,9 +151,36 @@ class GridSearch : public Nucleator
 		bool _readGrid(const std::string &gridfile);
 
 	private:
+		// Pool of threads feeding a pick into a partition of the grid
+		struct Workers;
+
+		// A grid point within nucleation distance of a station
+		struct StationCell {
+			StationCell(size_t index, const StationWrapper *wrapper)
+			: index(index), wrapper(wrapper) {}
+
+			size_t                index; // into _grid
+			const StationWrapper *wrapper;
+		};
+
+		// The reachable grid points per station in grid order
+		typedef std::vector<StationCell> StationCells;
+		typedef std::map<std::string, StationCells> StationCellMap;
+
 		Grid    _grid;
 		Locator _relocator;
 
+		// The grid points keep plain pick pointers to be able to feed
+		// them from several threads, the picks are held here until
+		// they are cleaned up
+		std::set<PickCPtr> _activePicks;
+
+		// Built when a station is set up, a pick is only fed into
+		// the grid points of its station
+		StationCellMap _stationCells;
+
+		Workers *_workers;
+
 		bool _abort;
 
 	public: // FIXME
@@ -189,7 +224,7 @@ public:
 class ProjectedPick {
 public:
 	ProjectedPick(const Time &t);
-	ProjectedPick(PickCPtr p, StationWrapperCPtr w);
+	ProjectedPick(const Pick *p, StationWrapperCPtr w);
 	ProjectedPick(const ProjectedPick&);
 	~ProjectedPick();
 
@@ -204,7 +239,7 @@ public:
 	Time projectedTime() const { return _projectedTime; }
 
 	Time _projectedTime;
-	PickCPtr p;
+	const Pick *p;
 	StationWrapperCPtr wrapper;
 };
 
@@ -227,13 +262,28 @@ class GridPoint : public Hypocenter
 		// feed a new pick and perhaps get a new origin
 		const Origin* feed(const Pick*);
 
+		// The two stages of feed(): cluster() inserts the pick and
+		// looks for a cluster of picks around it. It only touches
+		// this grid point and can be called for different grid points
+		// in parallel. If a cluster was found, origin() creates the
+		// origin from it.
+		bool cluster(const Pick*);
+		const Origin* origin();
+
+		// Same as cluster() but with the station wrapper of the pick
+		// as returned by setupStation()
+		bool cluster(const Pick*, const StationWrapper*);
+
 		// remove all picks older than tmin
 		int cleanup(const Time& minTime);
 
 	public:
 		void setStations(const StationDB *stations);
 
-		bool setupStation(const Station *station);
+		// Sets up the station for this grid point and returns the
+		// wrapper or NULL if the grid point is out of range for the
+		// station
+		const StationWrapper *setupStation(const Station *station);
 
 	public: // private:
 		// config
@@ -248,6 +298,8 @@ class GridPoint : public Hypocenter
 	private:
 		std::map<std::string, StationWrapperCPtr> _wrappers;
 		std::multiset<ProjectedPick>          _picks;
+		std::vector<ProjectedPick>            _group;
+		Time      _otime;
 		OriginPtr _origin;
 };
 
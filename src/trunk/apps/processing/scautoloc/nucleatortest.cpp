@@ -0,0 +1,240 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+
+
+// Feeds the same synthetic pick sequence into a serial and a threaded
+// grid search nucleator, checks that both create the same origins and
+// reports the time per pick of both.
+
+
+#define SEISCOMP_COMPONENT Autoloc
+#include <seiscomp3/logging/log.h>
+#include <seiscomp3/client/application.h>
+#include <seiscomp3/system/environment.h>
+#include <seiscomp3/utils/timer.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <math.h>
+
+#include "util.h"
+#include "sc3adapters.h"
+#include "nucleator.h"
+
+
+using namespace std;
+using namespace Seiscomp;
+
+
+namespace {
+
+
+bool byTime(const ::Autoloc::PickPtr &a, const ::Autoloc::PickPtr &b) {
+	return a->time < b->time;
+}
+
+
+struct Result {
+	size_t pick;
+	double lat, lon, dep, time;
+	size_t arrivals;
+
+	bool operator==(const Result &other) const {
+		return pick == other.pick && lat == other.lat && lon == other.lon &&
+		       dep == other.dep && time == other.time &&
+		       arrivals == other.arrivals;
+	}
+};
+
+
+}
+
+
+class NucleatorTest : public Client::Application {
+	public:
+		NucleatorTest(int argc, char **argv) : Client::Application(argc, argv) {
+			setMessagingEnabled(false);
+			setDatabaseEnabled(false, false);
+
+			_threads = 4;
+			_stationCount = 300;
+			_eventCount = 20;
+			_noisePicks = 2;
+			_locatorProfile = "iasp91";
+		}
+
+	protected:
+		void createCommandLineDescription() {
+			commandline().addGroup("Test");
+			commandline().addOption("Test", "grid", "The grid.conf file to use", &_gridFile, false);
+			commandline().addOption("Test", "threads", "Number of threads of the parallel run", &_threads);
+			commandline().addOption("Test", "stations", "Number of synthetic stations", &_stationCount);
+			commandline().addOption("Test", "events", "Number of synthetic events", &_eventCount);
+			commandline().addOption("Test", "noise", "Number of noise picks per station and event", &_noisePicks);
+			commandline().addOption("Test", "locator-profile", "The LocSAT profile", &_locatorProfile);
+		}
+
+		bool run() {
+			if ( _gridFile.empty() )
+				_gridFile = Environment::Instance()->shareDir() + "/scautoloc/grid.conf";
+
+			createStations();
+			createPicks();
+
+			cerr << _stations.size() << " stations, " << _picks.size()
+			     << " picks" << endl;
+
+			vector<Result> serial, parallel;
+			double serialTime, parallelTime;
+
+			if ( !feed(1, serial, serialTime) ) return false;
+			if ( !feed(_threads, parallel, parallelTime) ) return false;
+
+			printf("threads %2d: %lu origins, %.1f us/pick\n", 1,
+			       (unsigned long)serial.size(), serialTime * 1E6 / _picks.size());
+			printf("threads %2d: %lu origins, %.1f us/pick\n", _threads,
+			       (unsigned long)parallel.size(), parallelTime * 1E6 / _picks.size());
+
+			if ( serial.size() != parallel.size() ||
+			     !equal(serial.begin(), serial.end(), parallel.begin()) ) {
+				cerr << "origins of the serial and the parallel run differ" << endl;
+				return false;
+			}
+
+			return true;
+		}
+
+	private:
+		// Stations are spread evenly over the globe on a Fibonacci
+		// lattice
+		void createStations() {
+			_stations.clear();
+
+			for ( int i = 0; i < _stationCount; ++i ) {
+				double z = 1 - (2*i + 1) / (double)_stationCount;
+				double lat = asin(z) * 180 / M_PI;
+				double lon = fmod(i * 137.50776405, 360) - 180;
+
+				char code[16];
+				snprintf(code, sizeof(code), "S%04d", i);
+
+				::Autoloc::Station *station = new ::Autoloc::Station(code, "XX", lat, lon, 0);
+				_stations["XX." + string(code)] = station;
+			}
+		}
+
+		void createPicks() {
+			srand(1);
+			_picks.clear();
+
+			::Autoloc::Time start = Core::Time(2015, 1, 1);
+			int id = 0;
+
+			for ( int e = 0; e < _eventCount; ++e ) {
+				double lat = rand() / (double)RAND_MAX * 120 - 60;
+				double lon = rand() / (double)RAND_MAX * 360 - 180;
+				double dep = 10;
+				::Autoloc::Time otime = start + e * 600;
+
+				::Autoloc::StationDB::const_iterator it;
+				for ( it = _stations.begin(); it != _stations.end(); ++it ) {
+					const ::Autoloc::Station *station = it->second.get();
+
+					double delta, az, baz;
+					::Autoloc::delazi(lat, lon, station->lat, station->lon, delta, az, baz);
+
+					::Autoloc::TravelTime tt;
+					if ( delta < 95 &&
+					     ::Autoloc::travelTimeP(lat, lon, dep, station->lat,
+					                            station->lon, 0, delta, tt) ) {
+						double noise = rand() / (double)RAND_MAX - 0.5;
+						addPick(++id, station, otime + tt.time + noise);
+					}
+
+					for ( int n = 0; n < _noisePicks; ++n )
+						addPick(++id, station, otime + rand() / (double)RAND_MAX * 600);
+				}
+			}
+
+			sort(_picks.begin(), _picks.end(), byTime);
+		}
+
+		void addPick(int id, const ::Autoloc::Station *station, ::Autoloc::Time time) {
+			char pickID[32];
+			snprintf(pickID, sizeof(pickID), "Pick-%07d", id);
+
+			::Autoloc::PickPtr pick = new ::Autoloc::Pick(pickID, station->net, station->code, time);
+			pick->amp = 1000;
+			pick->per = 1;
+			pick->snr = 10;
+			pick->normamp = 1;
+			pick->setStation(station);
+			_picks.push_back(pick);
+		}
+
+		bool feed(int threads, vector<Result> &results, double &seconds) {
+			::Autoloc::GridSearch nucleator;
+			::Autoloc::GridSearch::Config config = nucleator.config();
+			config.threads = threads;
+			nucleator.setConfig(config);
+
+			// The nucleator takes the ownership of the station list
+			nucleator.setStations(new ::Autoloc::StationDB(_stations));
+			nucleator.setLocatorProfile(_locatorProfile);
+			if ( !nucleator.setGridFile(_gridFile) ) return false;
+
+			Util::StopWatch timer;
+
+			for ( size_t i = 0; i < _picks.size(); ++i ) {
+				const ::Autoloc::Pick *pick = _picks[i].get();
+
+				if ( nucleator.feed(pick) ) {
+					const ::Autoloc::OriginDB &origins = nucleator.newOrigins();
+					for ( size_t o = 0; o < origins.size(); ++o ) {
+						Result r;
+						r.pick = i;
+						r.lat = origins[o]->lat;
+						r.lon = origins[o]->lon;
+						r.dep = origins[o]->dep;
+						r.time = origins[o]->time;
+						r.arrivals = origins[o]->arrivals.size();
+						results.push_back(r);
+					}
+				}
+
+				if ( i % 100 == 99 )
+					nucleator.cleanup(pick->time - 1800);
+			}
+
+			seconds = (double)timer.elapsed();
+			return true;
+		}
+
+	private:
+		std::string                     _gridFile;
+		std::string                     _locatorProfile;
+		int                             _threads;
+		int                             _stationCount;
+		int                             _eventCount;
+		int                             _noisePicks;
+		::Autoloc::StationDB            _stations;
+		std::vector< ::Autoloc::PickPtr > _picks;
+};
+
+
+int main(int argc, char **argv) {
+	NucleatorTest app(argc, argv);
+	return app.exec();
+}
@@ -28,20 +28,23 @@ using namespace Seiscomp::Client;
 
 
 EventInformation::EventInformation(Cache *c, Config *cfg_)
-: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
+: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false)
+, pickSetRevision(1), indexedPickSetRevision(0) {
 }
 
 
 EventInformation::EventInformation(Cache *c, Config *cfg_,
                                    DatabaseQuery *q, const string &eventID)
-: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
+: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false)
+, pickSetRevision(1), indexedPickSetRevision(0) {
 	load(q, eventID);
 }
 
 
 EventInformation::EventInformation(Cache *c, Config *cfg_,
                                    DatabaseQuery *q, EventPtr &event)
-: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false) {
+: cache(c), cfg(cfg_), created(false), aboutToBeRemoved(false), dirtyPickSet(false)
+, pickSetRevision(1), indexedPickSetRevision(0) {
 	load(q, event);
 }
 
@@ -109,7 +112,7 @@ void EventInformation::load(DatabaseQuery *q, EventPtr &e) {
 
 void EventInformation::loadAssocations(DataModel::DatabaseQuery *q) {
 	if ( !q || !event ) return;
-	q->load(event.get());
+	q->loadDescendants(event.get());
 }
 
 
@@ -139,6 +142,7 @@ size_t EventInformation::matchingPicks(DataModel::DatabaseQuery *q,
 		}
 
 		dirtyPickSet = false;
+		++pickSetRevision;
 	}
 
 	typedef pair<PickAssociation::const_iterator, PickAssociation::const_iterator> PickRange;
@@ -228,6 +232,8 @@ bool EventInformation::associate(DataModel::Origin *o) {
 		}
 	}
 
+	++pickSetRevision;
+
 	return true;
 }
 
@@ -93,6 +93,13 @@ struct EventInformation : public Seiscomp::Core::BaseObject {
 
 	bool                                   aboutToBeRemoved;
 	bool                                   dirtyPickSet;
+
+	//! Incremented whenever pickIDs changes
+	size_t                                 pickSetRevision;
+	//! The pick IDs and their revision the event has been registered
+	//! with in the pick index of the event tool
+	std::set<std::string>                  indexedPickIDs;
+	size_t                                 indexedPickSetRevision;
 };
 
 
@@ -698,6 +698,7 @@ void EventTool::cleanUpEventCache() {
 		if ( it->second->aboutToBeRemoved ) {
 			SEISCOMP_DEBUG("... remove event %s from cache",
 			               it->second->event->publicID().c_str());
+			unindexPicks(it->second.get());
 			_events.erase(it++);
 		}
 		else
@@ -2207,8 +2208,44 @@ EventInformationPtr EventTool::findMatchingEvent(Origin *origin) {
 	EventInformationPtr bestInfo = NULL;
 	EventMap::iterator it;
 
+	// Only events that share picks with the origin or whose preferred
+	// origin lies within the time window can match. Matching picks by
+	// time difference compares picks with different IDs and a minimum of
+	// 0 matching picks lets every event match, both need to compare
+	// against all events.
+	bool filter = _config.maxMatchingPicksTimeDiff < 0 && _config.minMatchingPicks > 0;
+	std::set<EventInformation*> pickCandidates;
+
+	if ( filter ) {
+		for ( size_t i = 0; i < origin->arrivalCount(); ++i ) {
+			PickIndex::iterator pit = _pickIndex.find(origin->arrival(i)->pickID());
+			if ( pit != _pickIndex.end() )
+				pickCandidates.insert(pit->second.begin(), pit->second.end());
+		}
+	}
+
 	for ( it = _events.begin(); it != _events.end(); ++it ) {
-		MatchResult res = compare(it->second.get(), origin);
+		EventInformation *info = it->second.get();
+
+		if ( filter ) {
+			bool candidate = info->dirtyPickSet ||
+			                 pickCandidates.find(info) != pickCandidates.end();
+
+			// The pick set changed since it was indexed
+			if ( info->pickSetRevision != info->indexedPickSetRevision ) {
+				indexPicks(info);
+				candidate = true;
+			}
+
+			if ( !candidate && info->preferredOrigin ) {
+				TimeSpan diffTime = info->preferredOrigin->time().value() - origin->time().value();
+				candidate = diffTime.abs() <= _config.maxTimeDiff;
+			}
+
+			if ( !candidate ) continue;
+		}
+
+		MatchResult res = compare(info, origin);
 		if ( res > bestResult ) {
 			bestResult = res;
 			bestInfo = it->second;
@@ -2389,7 +2426,10 @@ void EventTool::cacheEvent(EventInformationPtr info) {
 	               info->event->publicID().c_str());
 
 	// Cache the complete event information
-	_events[info->event->publicID()] = info;
+	EventInformationPtr &entry = _events[info->event->publicID()];
+	if ( entry && entry != info ) unindexPicks(entry.get());
+	entry = info;
+	indexPicks(info.get());
 	// Set the clean-up flag to false
 	info->aboutToBeRemoved = false;
 	// Add the event to the EventParameters
@@ -2438,6 +2478,7 @@ EventInformationPtr EventTool::cachedEvent(const std::string &eventID) {
 bool EventTool::removeCachedEvent(const std::string &eventID) {
 	EventMap::iterator it = _events.find(eventID);
 	if ( it != _events.end() ) {
+		unindexPicks(it->second.get());
 		_events.erase(it);
 		return true;
 	}
@@ -2448,6 +2489,40 @@ bool EventTool::removeCachedEvent(const std::string &eventID) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void EventTool::indexPicks(EventInformation *info) {
+	unindexPicks(info);
+
+	std::set<std::string>::const_iterator it;
+	for ( it = info->pickIDs.begin(); it != info->pickIDs.end(); ++it )
+		_pickIndex[*it].insert(info);
+
+	info->indexedPickIDs = info->pickIDs;
+	info->indexedPickSetRevision = info->pickSetRevision;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void EventTool::unindexPicks(EventInformation *info) {
+	std::set<std::string>::const_iterator it;
+	for ( it = info->indexedPickIDs.begin(); it != info->indexedPickIDs.end(); ++it ) {
+		PickIndex::iterator pit = _pickIndex.find(*it);
+		if ( pit == _pickIndex.end() ) continue;
+		pit->second.erase(info);
+		if ( pit->second.empty() ) _pickIndex.erase(pit);
+	}
+
+	info->indexedPickIDs.clear();
+	info->indexedPickSetRevision = 0;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void EventTool::choosePreferred(EventInformation *info, Origin *origin,
                                 DataModel::Magnitude *triggeredMag,
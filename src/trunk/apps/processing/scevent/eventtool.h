@@ -119,6 +119,9 @@ class EventTool : public Application {
 		DataModel::Event *getEventForFocalMechanism(const std::string &fmID);
 
 		void cacheEvent(EventInformationPtr info);
+		//! Registers the current pick set of an event in the pick index
+		void indexPicks(EventInformation *info);
+		void unindexPicks(EventInformation *info);
 		EventInformationPtr cachedEvent(const std::string &eventID);
 		bool removeCachedEvent(const std::string &eventID);
 		bool isEventCached(const std::string &eventID) const;
@@ -157,6 +160,7 @@ class EventTool : public Application {
 
 		typedef DataModel::PublicObjectTimeSpanBuffer Cache;
 		typedef std::map<std::string, EventInformationPtr> EventMap;
+		typedef std::map<std::string, std::set<EventInformation*> > PickIndex;
 
 		// Bit more complicated class to avoid duplicates and to maintain
 		// the order of incoming requests
@@ -231,6 +235,7 @@ class EventTool : public Application {
 		ScoreProcessorPtr             _score;
 
 		EventMap                      _events;
+		PickIndex                     _pickIndex;
 		DataModel::EventParametersPtr _ep;
 		DataModel::JournalingPtr      _journal;
 
@@ -0,0 +1,207 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+// Replay test of the event association of scevent.
+//
+//   testeventreplay generate [events] [origins] > ep.xml
+//
+// writes event parameters of synthetic events spaced 5 minutes apart.
+// Each event has several origins that share picks.
+//
+//   scevent --ep ep.xml > result.xml
+//   testeventreplay check result.xml
+//
+// checks that every synthetic event ended up in exactly one scevent event
+// and that no scevent event mixes synthetic events. Timing scevent with
+// a large number of events shows the cost of the event association.
+
+
+#include <seiscomp3/io/archive/xmlarchive.h>
+#include <seiscomp3/datamodel/eventparameters_package.h>
+#include <seiscomp3/core/strings.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::DataModel;
+
+
+namespace {
+
+
+const int StationCount = 30;
+const int ArrivalCount = 20;
+
+
+double uniform(double min, double max) {
+	return min + rand() / (double)RAND_MAX * (max - min);
+}
+
+
+int generate(int events, int origins) {
+	EventParametersPtr ep = new EventParameters;
+	Core::Time start = Core::Time(2015, 1, 1);
+
+	srand(1);
+
+	CreationInfo ci;
+	ci.setAgencyID("TEST");
+	ci.setAuthor("testeventreplay");
+
+	for ( int e = 0; e < events; ++e ) {
+		Core::Time otime = start + Core::TimeSpan(e * 300.0);
+		double lat = uniform(-60, 60);
+		double lon = uniform(-180, 180);
+		char id[64];
+
+		vector<PickPtr> picks;
+		for ( int s = 0; s < StationCount; ++s ) {
+			snprintf(id, sizeof(id), "Pick/E%06d/%03d", e, s);
+			PickPtr pick = Pick::Create(id);
+			pick->setTime(otime + Core::TimeSpan(uniform(10, 600)));
+			pick->setWaveformID(WaveformStreamID("XX", "S" + Core::toString(s), "", "BHZ", ""));
+			pick->setEvaluationMode(EvaluationMode(AUTOMATIC));
+			pick->setCreationInfo(ci);
+			ep->add(pick.get());
+			picks.push_back(pick);
+		}
+
+		for ( int o = 0; o < origins; ++o ) {
+			snprintf(id, sizeof(id), "Origin/E%06d/%03d", e, o);
+			OriginPtr origin = Origin::Create(id);
+			origin->setTime(otime + Core::TimeSpan(uniform(-1, 1)));
+			origin->setLatitude(lat + uniform(-0.1, 0.1));
+			origin->setLongitude(lon + uniform(-0.1, 0.1));
+			origin->setDepth(RealQuantity(10));
+			origin->setEvaluationMode(EvaluationMode(AUTOMATIC));
+			ci.setCreationTime(otime + Core::TimeSpan(60.0 + o * 30.0));
+			origin->setCreationInfo(ci);
+
+			// Consecutive origins use overlapping subsets of the picks
+			for ( int a = 0; a < ArrivalCount; ++a ) {
+				ArrivalPtr arrival = new Arrival;
+				arrival->setPickID(picks[(o + a) % StationCount]->publicID());
+				arrival->setPhase(Phase("P"));
+				arrival->setWeight(1.0);
+				origin->add(arrival.get());
+			}
+
+			ep->add(origin.get());
+		}
+	}
+
+	IO::XMLArchive ar;
+	ar.create("-");
+	ar.setFormattedOutput(true);
+	ar << ep;
+	ar.close();
+
+	return 0;
+}
+
+
+// Returns the synthetic event index encoded in an origin ID or -1
+int syntheticEvent(const string &originID) {
+	int e;
+	if ( sscanf(originID.c_str(), "Origin/E%d/", &e) != 1 )
+		return -1;
+	return e;
+}
+
+
+int check(const char *file) {
+	IO::XMLArchive ar;
+	if ( !ar.open(file) ) {
+		cerr << "Failed to open " << file << endl;
+		return 1;
+	}
+
+	EventParametersPtr ep;
+	ar >> ep;
+	ar.close();
+
+	if ( !ep ) {
+		cerr << "No event parameters found in " << file << endl;
+		return 1;
+	}
+
+	// Synthetic event index to the scevent events it ended up in
+	map<int, set<string> > events;
+	int errors = 0;
+
+	for ( size_t i = 0; i < ep->eventCount(); ++i ) {
+		Event *evt = ep->event(i);
+		set<int> synthetic;
+
+		for ( size_t r = 0; r < evt->originReferenceCount(); ++r ) {
+			int e = syntheticEvent(evt->originReference(r)->originID());
+			if ( e < 0 ) continue;
+			synthetic.insert(e);
+			events[e].insert(evt->publicID());
+		}
+
+		if ( synthetic.size() > 1 ) {
+			cerr << evt->publicID() << " mixes " << synthetic.size()
+			     << " synthetic events" << endl;
+			++errors;
+		}
+	}
+
+	for ( size_t i = 0; i < ep->originCount(); ++i ) {
+		int e = syntheticEvent(ep->origin(i)->publicID());
+		if ( e >= 0 && events.find(e) == events.end() ) {
+			cerr << "synthetic event " << e << " has not been associated" << endl;
+			events[e];
+			++errors;
+		}
+	}
+
+	for ( map<int, set<string> >::iterator it = events.begin();
+	      it != events.end(); ++it ) {
+		if ( it->second.size() > 1 ) {
+			cerr << "synthetic event " << it->first << " split into "
+			     << it->second.size() << " events" << endl;
+			++errors;
+		}
+	}
+
+	cout << ep->eventCount() << " events, " << ep->originCount()
+	     << " origins, " << errors << " errors" << endl;
+
+	return errors ? 1 : 0;
+}
+
+
+}
+
+
+int main(int argc, char **argv) {
+	if ( argc > 1 && !strcmp(argv[1], "generate") )
+		return generate(argc > 2 ? atoi(argv[2]) : 1000,
+		                argc > 3 ? atoi(argv[3]) : 5);
+
+	if ( argc > 2 && !strcmp(argv[1], "check") )
+		return check(argv[2]);
+
+	cerr << "Usage: " << argv[0] << " generate [events] [origins]" << endl
+	     << "       " << argv[0] << " check file" << endl;
+	return 1;
+}
@@ -1126,9 +1126,14 @@ bool MagTool::feed(DataModel::Amplitude* ampl, bool update) {
 		}
 		dbit.close();
 
+		// Load the children of all origins at once instead of issuing a
+		// set of queries per origin
+		std::vector<DataModel::PublicObject*> roots;
 		for ( std::list<DataModel::OriginPtr>::iterator it = reloadOrigins.begin();
 		      it != reloadOrigins.end(); ++it )
-			SCCoreApp->query()->load(it->get());
+			roots.push_back(it->get());
+
+		SCCoreApp->query()->loadDescendants(roots);
 
 		// Restore notifier state
 		DataModel::Notifier::SetEnabled(oldState);
@@ -1303,8 +1308,12 @@ bool MagTool::feed(DataModel::Origin *origin) {
 	// Load missing magnitudes
 	if ( origin->magnitudeCount() == 0 && SCCoreApp->query() ) {
 		SCCoreApp->query()->loadMagnitudes(origin);
+
+		std::vector<DataModel::PublicObject*> magnitudes;
 		for ( size_t i = 0; i < origin->magnitudeCount(); ++i )
-			SCCoreApp->query()->load(origin->magnitude(i));
+			magnitudes.push_back(origin->magnitude(i));
+
+		SCCoreApp->query()->loadDescendants(magnitudes);
 	}
 
 	if ( origin->stationMagnitudeCount() == 0 && SCCoreApp->query() )
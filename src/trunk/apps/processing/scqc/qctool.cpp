@@ -429,6 +429,10 @@ void QcTool::initQc(const string& networkCode, const string& stationCode,
 	QcPlugin* qcPlugin;
 
 	const string streamID = networkCode + "." + stationCode  + "." + locationCode  + "." + channelCode;
+
+	// The sample statistics of a record are computed once for all
+	// processors of the stream
+	Processing::QcRecordStatisticsPtr stats = new Processing::QcRecordStatistics;
 	
 	for (map<string,QcConfigPtr>::iterator it = _plugins.begin(); it != _plugins.end(); ++it) {
 		qcPlugin = QcPlugin::Cast(QcPluginFactory::Create(it->first.c_str()));
@@ -443,6 +447,7 @@ void QcTool::initQc(const string& networkCode, const string& stationCode,
 			continue;
 		}
 		
+		qcPlugin->qcProcessor()->setRecordStatistics(stats.get());
 		_qcPluginMap.insert(pair<string, QcPluginCPtr>(streamID, qcPlugin));
 		addProcessor(networkCode, stationCode, locationCode, channelCode, qcPlugin->qcProcessor());
 	}
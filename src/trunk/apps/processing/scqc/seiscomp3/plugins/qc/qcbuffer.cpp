@@ -14,6 +14,9 @@
 #define SEISCOMP_COMPONENT SCQC
 #include <seiscomp3/logging/log.h>
 
+#include <algorithm>
+#include <math.h>
+
 #include "qcbuffer.h"
 
 
@@ -22,11 +25,35 @@ namespace Applications {
 namespace Qc {
 
 
+namespace {
+
+
+bool endsBefore(const QcParameterCPtr &qcp, const Core::Time &time) {
+	return qcp->recordEndTime < time;
+}
+
+
+bool endsAfter(const Core::Time &time, const QcParameterCPtr &qcp) {
+	return time < qcp->recordEndTime;
+}
+
+
+bool value(const QcParameterCPtr &qcp, double &v) {
+	const double *p = boost::any_cast<double>(&qcp->parameter);
+	if ( p == NULL ) return false;
+	v = *p;
+	return true;
+}
+
+
+}
+
+
 IMPLEMENT_SC_CLASS(QcBuffer, "QcBuffer");
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 QcBuffer::QcBuffer()
-	: _maxBufferSize(-1) {
+	: _maxBufferSize(-1), _sumBase(0), _squareBase(0), _removed(0) {
 // buffer size in seconds
 
 // 	lastEvalTime = Core::Time(1970, 01, 01);
@@ -35,7 +62,7 @@ QcBuffer::QcBuffer()
 }
 
 QcBuffer::QcBuffer(double maxBufferSize)
-	: _maxBufferSize(maxBufferSize) {
+	: _maxBufferSize(maxBufferSize), _sumBase(0), _squareBase(0), _removed(0) {
 // buffer size in seconds
 
 // 	lastEvalTime = Core::Time(1970, 01, 01);
@@ -67,18 +94,51 @@ bool QcBuffer::recentlyUsed() const {
 //! older than _maxBufferSize [sec]
 void QcBuffer::push_back(const QcParameter* qcp) {
 
-	BufferBase::push_back(qcp);
+	// Records arrive in order usually, late ones are sorted in and the
+	// running sums are recomputed on demand
+	if (empty() || !(qcp->recordEndTime < back()->recordEndTime)) {
+		bool inSync = _sums.size() == size();
+		double v;
+
+		BufferBase::push_back(qcp);
+
+		if (inSync && value(back(), v)) {
+			_sums.push_back((_sums.empty() ? _sumBase : _sums.back()) + v);
+			_squares.push_back((_squares.empty() ? _squareBase : _squares.back()) + v*v);
+		}
+	}
+	else {
+		insert(std::upper_bound(begin(), end(), qcp->recordEndTime, endsAfter), qcp);
+		_sums.clear();
+		_squares.clear();
+	}
 
 	// buffer size is 'unlimited'
 	if (_maxBufferSize == -1) return;
 
-	iterator qcPar = begin();
-	while(qcPar != end()) {
-		double diff = (double)(back()->recordEndTime - (*qcPar)->recordEndTime);
-		if (fabs(diff) > _maxBufferSize*1.10)
-			qcPar = erase(qcPar);
-		else
-			++qcPar;
+	// The buffer is ordered, outdated parameters are at the front
+	while (!empty()) {
+		double diff = (double)(back()->recordEndTime - front()->recordEndTime);
+		if (diff <= _maxBufferSize*1.10) break;
+		pop_front();
+
+		if (_sums.size() != size()+1) continue;
+
+		_sumBase = _sums.front();
+		_squareBase = _squares.front();
+		_sums.pop_front();
+		_squares.pop_front();
+
+		// Rebasing costs as much as the parameters removed since the
+		// last rebase
+		if (++_removed > _sums.size()) {
+			for (size_t i = 0; i < _sums.size(); ++i) {
+				_sums[i] -= _sumBase;
+				_squares[i] -= _squareBase;
+			}
+			_sumBase = _squareBase = 0;
+			_removed = 0;
+		}
 	}
 
 }
@@ -108,21 +168,148 @@ const QcParameter* QcBuffer::qcParameter(const Core::Time& time) const {
 //! return list of qcParameters for time range
 const QcBuffer* QcBuffer::qcParameter(const Core::Time& startTime, const Core::Time& endTime) const {
 
+	return copy(range(startTime, endTime));
+
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+//! return list of qcParameters for the last n seconds in buffer
+const QcBuffer* QcBuffer::qcParameter(const Core::TimeSpan& lastNSeconds) const {
+
+	return copy(range(lastNSeconds));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcBuffer::Range QcBuffer::range(const Core::Time& startTime, const Core::Time& endTime) const {
+
+	// Only parameters ending in the range can start in it
+	const_iterator first = std::lower_bound(begin(), end(), startTime, endsBefore);
+	const_iterator last = std::upper_bound(first, end(), endTime, endsAfter);
+
+	while (first != last && (*first)->recordStartTime < startTime)
+		++first;
+
+	return Range(first, last);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcBuffer::Range QcBuffer::range(const Core::TimeSpan& lastNSeconds) const {
+
+	if (empty()) return Range(end(), end());
+
+	const_iterator first = std::lower_bound(begin(), end(),
+	                                        back()->recordEndTime - lastNSeconds,
+	                                        endsBefore);
+	return Range(first, end());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcBuffer::Range QcBuffer::range() const {
+
+	return Range(begin(), end());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcBuffer::statistics(const Range& range, Statistics& stats) const {
+
+	syncSums();
+	if (_sums.size() != size()) return false;
+
+	size_t first = range.first - begin();
+	size_t last = range.second - begin();
+
+	stats = Statistics();
+	if (first >= last) return true;
+
+	stats.count = last - first;
+	stats.sum = _sums[last-1] - (first > 0 ? _sums[first-1] : _sumBase);
+	stats.sumSquares = _squares[last-1] - (first > 0 ? _squares[first-1] : _squareBase);
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcBuffer* QcBuffer::copy(const Range& range) const {
+
 	QcBuffer* qcb = new QcBuffer();
+	qcb->BufferBase::insert(qcb->end(), range.first, range.second);
 
-	if (empty()) return qcb;
+	syncSums();
+	if (_sums.size() != size() || range.first == range.second) return qcb;
 
-	int count = 0;
+	size_t first = range.first - begin();
+	size_t last = range.second - begin();
 
-	for (const_iterator qcParameter = begin(); qcParameter != end(); qcParameter++) {
-		if ( (*qcParameter)->recordStartTime >= startTime && (*qcParameter)->recordEndTime <= endTime){
-			qcb->push_back((*qcParameter).get());
-			count++;
+	qcb->_sums.assign(_sums.begin() + first, _sums.begin() + last);
+	qcb->_squares.assign(_squares.begin() + first, _squares.begin() + last);
+	qcb->_sumBase = first > 0 ? _sums[first-1] : _sumBase;
+	qcb->_squareBase = first > 0 ? _squares[first-1] : _squareBase;
+
+	return qcb;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcBuffer::syncSums() const {
+
+	if (_sums.size() == size()) return;
+
+	_sums.clear();
+	_squares.clear();
+	_sumBase = _squareBase = 0;
+	_removed = 0;
+
+	double sum = 0, squares = 0, v;
+	for (const_iterator it = begin(); it != end(); ++it) {
+		// Not a double parameter: the sums stay out of sync
+		if (!value(*it, v)) {
+			_sums.clear();
+			_squares.clear();
+			return;
 		}
+
+		sum += v;
+		squares += v*v;
+		_sums.push_back(sum);
+		_squares.push_back(squares);
 	}
-	
-	return qcb;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double QcBuffer::Statistics::mean() const {
+
+	return count > 0 ? sum / count : 0.0;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -130,36 +317,17 @@ const QcBuffer* QcBuffer::qcParameter(const Core::Time& startTime, const Core::T
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-//! return list of qcParameters for the last n seconds in buffer
-const QcBuffer* QcBuffer::qcParameter(const Core::TimeSpan& lastNSeconds) const {
+bool QcBuffer::Statistics::stdDev(double m, double& value) const {
 
-	QcBuffer* qcb = new QcBuffer();
-	
-	if (empty()) return qcb;
-
-	const_reverse_iterator Start = rbegin();
-	const_reverse_iterator End = rbegin();
-
-	for (const_reverse_iterator qcPar = rbegin(); qcPar != rend(); qcPar++) {
-		
-		if (!(*qcPar)) continue;
-		
-		Core::TimeSpan diff = back()->recordEndTime - (*qcPar)->recordEndTime;
-		
-		Start = qcPar;
-
-		if ( diff > lastNSeconds )
-			break;
-		
-	}
-	
+	value = 0.0;
+	if (count < 2) return true;
 
-	if (Start != End) {
-		qcb->insert(qcb->begin(), End, Start);
-		qcb->reverse();
-	}
+	// sum((x-m)^2) expanded, it cancels out if the spread is small
+	double ss = sumSquares - 2*m*sum + count*m*m;
+	if (ss <= sumSquares * 1E-8) return false;
 
-	return qcb;
+	value = sqrt(ss / (count - 1));
+	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
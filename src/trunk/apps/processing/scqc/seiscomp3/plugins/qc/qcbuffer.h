@@ -15,6 +15,8 @@
 #define __SEISCOMP_QC_QCBUFFER_H__
 
 
+#include <deque>
+
 #include <seiscomp3/qc/qcprocessor.h>
 #include <seiscomp3/plugins/qc/api.h>
 
@@ -24,7 +26,12 @@ namespace Seiscomp {
 namespace Applications {
 namespace Qc {
 
-typedef std::list<QcParameterCPtr> BufferBase;
+//! Parameters are kept ordered by record end time which allows binary
+//! searches for time ranges. This used to be a std::list: plugins must
+//! only iterate the buffer and use push_back of QcBuffer, modifying it
+//! through the BufferBase interface breaks the ordering and the running
+//! sums.
+typedef std::deque<QcParameterCPtr> BufferBase;
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 DEFINE_SMARTPOINTER(QcBuffer);
@@ -32,6 +39,26 @@ DEFINE_SMARTPOINTER(QcBuffer);
 class SC_QCPLUGIN_API QcBuffer : public Core::BaseObject, public BufferBase {
 	DECLARE_SC_CLASS(QcBuffer);
 
+	public:
+		//! A slice of the buffer given by an iterator pair. It is valid
+		//! until the buffer is modified.
+		typedef std::pair<const_iterator, const_iterator> Range;
+
+		//! Count, sum and sum of squares of double parameters
+		struct Statistics {
+			Statistics() : count(0), sum(0), sumSquares(0) {}
+
+			double mean() const;
+			//! Sets the sample standard deviation around m. Returns false
+			//! if the sums cannot resolve it precisely enough because the
+			//! spread is tiny compared to the values.
+			bool stdDev(double m, double& value) const;
+
+			size_t count;
+			double sum;
+			double sumSquares;
+		};
+
 	public:
 		QcBuffer();
 		QcBuffer(double maxBufferSize);
@@ -44,6 +71,18 @@ class SC_QCPLUGIN_API QcBuffer : public Core::BaseObject, public BufferBase {
 		const QcBuffer* qcParameter(const Core::Time& startTime, const Core::Time& endTime) const;
 		const QcBuffer* qcParameter(const Core::TimeSpan& lastNSeconds) const;
 
+		//! Returns the parameters starting at or after startTime and ending
+		//! until endTime without copying them
+		Range range(const Core::Time& startTime, const Core::Time& endTime) const;
+		//! Returns the parameters of the last n seconds without copying
+		Range range(const Core::TimeSpan& lastNSeconds) const;
+		//! Returns the whole buffer
+		Range range() const;
+
+		//! Returns the statistics of a range in constant time using running
+		//! sums. False is returned if not all parameters are doubles.
+		bool statistics(const Range& range, Statistics& stats) const;
+
 		void info() const;
 		void dump() const;
 		bool recentlyUsed() const;
@@ -56,10 +95,27 @@ class SC_QCPLUGIN_API QcBuffer : public Core::BaseObject, public BufferBase {
 	protected:
 	
 
+	private:
+		//! Returns a copy of a range including its running sums
+		QcBuffer* copy(const Range& range) const;
+		//! Recomputes the running sums if they are out of sync
+		void syncSums() const;
+
 	private:
 		double _maxBufferSize;
 		bool _recentlyUsed;
 
+		// Running sums of the parameters up to and including the
+		// parameter at the same index and the sums of the parameters
+		// removed from the front. Rebased when enough parameters have
+		// been removed to limit the loss of precision. The sums are only
+		// valid if there are as many of them as parameters.
+		mutable std::deque<double> _sums;
+		mutable std::deque<double> _squares;
+		mutable double _sumBase;
+		mutable double _squareBase;
+		mutable size_t _removed;
+
 
 };
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -249,6 +249,10 @@ double QcPlugin::mean(const QcBuffer* qcb) const {
 
 	if (qcb->size() < 1) return 0.0;
 
+	QcBuffer::Statistics stats;
+	if (qcb->statistics(qcb->range(), stats))
+		return stats.mean();
+
 	double sum = 0.0;
 
 	for (QcBuffer::const_iterator p = qcb->begin(); p != qcb->end(); p++) {
@@ -267,6 +271,11 @@ double QcPlugin::stdDev(const QcBuffer* qcb, double mean) const {
 
 	if (qcb->size() < 2) return 0.0;
 
+	QcBuffer::Statistics stats;
+	double value;
+	if (qcb->statistics(qcb->range(), stats) && stats.stdDev(mean, value))
+		return value;
+
 	double sum = 0.0;
 
 	for (QcBuffer::const_iterator p = qcb->begin(); p != qcb->end(); p++) {
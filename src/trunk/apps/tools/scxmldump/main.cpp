@@ -418,7 +418,7 @@ class EventDump : public Seiscomp::Client::Application {
 			bool staMags = commandline().hasOption("with-magnitudes");
 			bool ignoreArrivals = commandline().hasOption("ignore-arrivals");
 
-			query()->load(org);
+			query()->loadDescendants(org);
 
 			if ( commandline().hasOption("ignore-magnitudes") ) {
 				while ( org->magnitudeCount() > 0 )
@@ -449,7 +449,7 @@ class EventDump : public Seiscomp::Client::Application {
 						continue;
 					}
 
-					query()->load(pick.get());
+					query()->loadDescendants(pick.get());
 
 					if ( !pick->eventParameters() )
 						ep->add(pick.get());
@@ -492,7 +492,7 @@ class EventDump : public Seiscomp::Client::Application {
 			bool withFocMechs = commandline().hasOption("with-focal-mechanisms");
 
 			if ( !preferredOnly )
-				query()->load(event);
+				query()->loadDescendants(event);
 			else {
 				query()->loadComments(event);
 				query()->loadEventDescriptions(event);
@@ -515,7 +515,7 @@ class EventDump : public Seiscomp::Client::Application {
 					continue;
 				}
 
-				query()->load(origin.get());
+				query()->loadDescendants(origin.get());
 
 				if ( preferredOnly && !allMags ) {
 					MagnitudePtr netMag;
@@ -566,7 +566,7 @@ class EventDump : public Seiscomp::Client::Application {
 							continue;
 						}
 
-						query()->load(pick.get());
+						query()->loadDescendants(pick.get());
 
 						if ( !pick->eventParameters() )
 							ep->add(pick.get());
@@ -609,7 +609,7 @@ class EventDump : public Seiscomp::Client::Application {
 					continue;
 				}
 
-				query()->load(fm.get());
+				query()->loadDescendants(fm.get());
 				ep->add(fm.get());
 
 				for ( size_t m = 0; m < fm->momentTensorCount(); ++m ) {
@@ -625,7 +625,7 @@ class EventDump : public Seiscomp::Client::Application {
 						continue;
 					}
 
-					query()->load(derivedOrigin.get());
+					query()->loadDescendants(derivedOrigin.get());
 					ep->add(derivedOrigin.get());
 
 					if ( !foundPreferredMag ) {
@@ -643,7 +643,7 @@ class EventDump : public Seiscomp::Client::Application {
 			if ( !foundPreferredMag ) {
 				OriginPtr org = query()->getOriginByMagnitude(event->preferredMagnitudeID());
 				if ( org ) {
-					query()->load(org.get());
+					query()->loadDescendants(org.get());
 
 					if ( !staMags ) {
 						while ( org->stationMagnitudeCount() > 0 )
@@ -462,6 +462,8 @@ Application::Application(int argc, char** argv)
 	_logContext = false;
 	_logComponent = -1; // -1=unset, 0=off, 1=on
 	_logToStdout = false;
+	_logAsyncQueueSize = 10000;
+	_logAsyncDrop = false;
 	_logUTC = false;
 	_messagingTimeout = 3;
 	_messagingHost = "localhost";
@@ -2113,7 +2115,7 @@ void Application::initCommandLine() {
 		commandline().addOption("Messaging", "timeout,t", "connection timeout in seconds", &_messagingTimeout);
 		commandline().addOption("Messaging", "primary-group,g", "the primary message group of the client", &_messagingPrimaryGroup);
 		commandline().addOption("Messaging", "subscribe-group,S", "a group to subscribe to. this option can be given more than once", &_messagingSubscriptionRequests);
-		commandline().addOption("Messaging", "encoding", "sets the message encoding (binary or xml)", &_messagingEncoding);
+		commandline().addOption("Messaging", "encoding", "sets the message encoding (binary, binary-fast, binary-best, binary-raw or xml)", &_messagingEncoding);
 		commandline().addOption("Messaging", "start-stop-msg", "sets sending of a start- and a stop message", &_enableStartStopMessages);
 	}
 
@@ -2347,6 +2349,27 @@ bool Application::initLogging() {
 	try { logRotateTime = configGetInt("logging.file.rotator.timeSpan"); } catch (...) {}
 	try { logRotateArchiveSize = configGetInt("logging.file.rotator.archiveSize"); } catch (...) {}
 
+	bool logAsync = false;
+	std::string logAsyncOverflow = "block";
+
+	try { logAsync = configGetBool("logging.file.async"); } catch (...) {}
+	try { _logAsyncQueueSize = configGetInt("logging.file.async.queueSize"); } catch (...) {}
+	try { logAsyncOverflow = configGetString("logging.file.async.overflow"); } catch (...) {}
+
+	if ( _logAsyncQueueSize <= 0 ) {
+		std::cerr << "invalid logging.file.async.queueSize: " << _logAsyncQueueSize
+		          << ", expected a positive number" << std::endl;
+		return false;
+	}
+
+	if ( logAsyncOverflow != "block" && logAsyncOverflow != "drop" ) {
+		std::cerr << "invalid logging.file.async.overflow: " << logAsyncOverflow
+		          << ", expected block or drop" << std::endl;
+		return false;
+	}
+
+	_logAsyncDrop = logAsyncOverflow == "drop";
+
 	bool enableLogging = _verbosity > 0;
 	bool syslog = false;
 
@@ -2406,6 +2429,8 @@ bool Application::initLogging() {
 
 			if ( logger->open(logFile.c_str()) ) {
 				//std::cerr << "using logfile: " << logFile << std::endl;
+				if ( logAsync )
+					logger->startAsync(_logAsyncQueueSize, _logAsyncDrop);
 				_logger = logger;
 			}
 			else {
@@ -2851,6 +2876,14 @@ bool Application::forkProcess() {
 #ifndef WIN32
 	pid_t pid;
 
+	// Threads do not survive fork, the log writer is restarted in the
+	// child. Entries logged meanwhile are written synchronously.
+	Logging::FileOutput *fileLogger = dynamic_cast<Logging::FileOutput*>(_logger);
+	if ( fileLogger != NULL && fileLogger->isAsync() )
+		fileLogger->stopAsync();
+	else
+		fileLogger = NULL;
+
 	// Become a session leader to lose controlling TTY.
 	if ( (pid = fork()) < 0 ) {
 		SEISCOMP_ERROR("can't fork: %s", strerror(errno));
@@ -2894,6 +2927,9 @@ bool Application::forkProcess() {
 		return false;
 	}
 
+	if ( fileLogger != NULL )
+		fileLogger->startAsync(_logAsyncQueueSize, _logAsyncDrop);
+
 	return true;
 #else
 	return false;
@@ -919,6 +919,8 @@ class SC_SYSTEM_CLIENT_API Application : public Seiscomp::Core::InterruptibleObj
 		bool _logContext;
 		int _logComponent;
 		bool _logToStdout;
+		int _logAsyncQueueSize;
+		bool _logAsyncDrop;
 		bool _logUTC;
 
 		std::string _plugins;
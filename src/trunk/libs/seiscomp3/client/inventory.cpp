@@ -22,6 +22,53 @@
 
 namespace Seiscomp {
 namespace Client {
+
+
+namespace {
+
+
+bool isIndexed(const DataModel::Object *object) {
+	return DataModel::Inventory::ConstCast(object) != NULL ||
+	       DataModel::Network::ConstCast(object) != NULL ||
+	       DataModel::Station::ConstCast(object) != NULL ||
+	       DataModel::SensorLocation::ConstCast(object) != NULL ||
+	       DataModel::Stream::ConstCast(object) != NULL;
+}
+
+
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+// Invalidates the lookup index whenever networks, stations, locations or
+// streams of the managed inventory are added, removed or updated, e.g. by
+// notifiers received from the messaging.
+class Inventory::IndexObserver : public DataModel::Observer {
+	public:
+		IndexObserver(Inventory *owner) : _owner(owner) {}
+
+	public:
+		void onObjectAdded(DataModel::Object *parent, DataModel::Object *child) {
+			if ( isIndexed(child) && _owner->contains(parent) )
+				_owner->invalidateIndex();
+		}
+
+		void onObjectRemoved(DataModel::Object *parent, DataModel::Object *child) {
+			if ( isIndexed(child) && _owner->contains(parent) )
+				_owner->invalidateIndex();
+		}
+
+		void onObjectModified(DataModel::Object *object) {
+			if ( isIndexed(object) && _owner->contains(object) )
+				_owner->invalidateIndex();
+		}
+
+	private:
+		Inventory *_owner;
+};
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -55,8 +102,7 @@ StationLocation::StationLocation(double lat, double lon, double elv)
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-Inventory::Inventory() {
-}
+Inventory::Inventory() : _indexValid(false) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -80,6 +126,8 @@ void Inventory::load(const char *filename) throw(std::exception) {
 
 	ar >> _inventory;
 	ar.close();
+
+	inventoryChanged();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -276,7 +324,12 @@ void Inventory::load(DataModel::DatabaseReader* reader) {
 void Inventory::loadStations(DataModel::DatabaseReader* reader) {
 	if ( reader == NULL ) return;
 
+	// Do not track the objects added while loading
+	_inventory = NULL;
+	inventoryChanged();
+
 	_inventory = new DataModel::Inventory();
+
 	DataModel::DatabaseIterator it;
 
 	// Read networks
@@ -357,6 +410,8 @@ void Inventory::loadStations(DataModel::DatabaseReader* reader) {
 	}
 
 	it.close();
+
+	inventoryChanged();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -410,6 +465,7 @@ int Inventory::filter(const Util::StringFirewall *networkTypeFW,
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Inventory::setInventory(DataModel::Inventory *inv) {
 	_inventory = inv;
+	inventoryChanged();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -441,7 +497,32 @@ StationLocation Inventory::stationLocation(const std::string& networkCode,
 DataModel::Station* Inventory::getStation(const std::string& networkCode,
                                           const std::string& stationCode,
                                           const Core::Time& time) const {
-	return DataModel::getStation(_inventory.get(), networkCode, stationCode, time);
+	const IndexEntry *entry = indexEntry(networkCode, stationCode, "");
+	if ( entry == NULL ) return NULL;
+
+	// Same epoch checks as DataModel::getStation in inventory order
+	for ( size_t i = 0; i < entry->stations.size(); ++i ) {
+		DataModel::Station *station = entry->stations[i];
+		DataModel::Network *network = station->network();
+
+		try {
+			if ( network->end() < time ) continue;
+		}
+		catch (...) {}
+
+		if ( network->start() > time ) continue;
+
+		try {
+			if ( station->end() < time ) continue;
+		}
+		catch (...) {}
+
+		if ( station->start() > time ) continue;
+
+		return station;
+	}
+
+	return NULL;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -454,7 +535,23 @@ Inventory::getSensorLocation(const std::string &networkCode,
                              const std::string &stationCode,
                              const std::string &locationCode,
                              const Core::Time &time) const {
-	return DataModel::getSensorLocation(_inventory.get(), networkCode, stationCode, locationCode, time);
+	const IndexEntry *entry = indexEntry(networkCode, stationCode, locationCode);
+	if ( entry == NULL ) return NULL;
+
+	for ( size_t i = 0; i < entry->locations.size(); ++i ) {
+		DataModel::SensorLocation *loc = entry->locations[i];
+
+		try {
+			if ( loc->end() <= time ) continue;
+		}
+		catch (...) {}
+
+		if ( loc->start() > time ) continue;
+
+		return loc;
+	}
+
+	return NULL;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -493,7 +590,24 @@ Inventory::getStream(const std::string& networkCode,
                      const std::string& locationCode,
                      const std::string& channelCode,
                      const Core::Time &time) const {
-	return DataModel::getStream(_inventory.get(), networkCode, stationCode, locationCode, channelCode, time);
+	DataModel::SensorLocation *loc = getSensorLocation(networkCode, stationCode, locationCode, time);
+	if ( loc == NULL ) return NULL;
+
+	for ( size_t i = 0; i < loc->streamCount(); ++i ) {
+		DataModel::Stream *stream = loc->stream(i);
+		if ( stream->code() != channelCode ) continue;
+
+		try {
+			if ( stream->end() <= time ) continue;
+		}
+		catch (...) {}
+
+		if ( stream->start() > time ) continue;
+
+		return stream;
+	}
+
+	return NULL;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -549,7 +663,11 @@ int Inventory::getAllStations(StationList& stationList,
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 DataModel::Station* Inventory::getStation(const DataModel::Pick* pick) const {
-	return DataModel::getStation(_inventory.get(), pick);
+	if ( pick == NULL ) return NULL;
+
+	return getStation(pick->waveformID().networkCode(),
+	                  pick->waveformID().stationCode(),
+	                  pick->time().value());
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -558,7 +676,12 @@ DataModel::Station* Inventory::getStation(const DataModel::Pick* pick) const {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 DataModel::SensorLocation* Inventory::getSensorLocation(const DataModel::Pick *pick) const {
-	return DataModel::getSensorLocation(_inventory.get(), pick);
+	if ( pick == NULL ) return NULL;
+
+	return getSensorLocation(pick->waveformID().networkCode(),
+	                         pick->waveformID().stationCode(),
+	                         pick->waveformID().locationCode(),
+	                         pick->time().value());
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -614,6 +737,108 @@ DataModel::Inventory* Inventory::inventory() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Inventory::contains(const DataModel::Object *object) const {
+	if ( !_inventory ) return false;
+
+	while ( object != NULL ) {
+		if ( object == _inventory.get() ) return true;
+		object = object->parent();
+	}
+
+	return false;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+// Registers the observer while an inventory is set and builds the index
+void Inventory::inventoryChanged() {
+	if ( _inventory ) {
+		if ( !_observer ) {
+			_observer = new IndexObserver(this);
+			DataModel::Object::RegisterObserver(_observer.get());
+		}
+	}
+	else if ( _observer ) {
+		DataModel::Object::UnregisterObserver(_observer.get());
+		_observer = NULL;
+	}
+
+	boost::mutex::scoped_lock lock(_indexMutex);
+	buildIndex();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Inventory::invalidateIndex() {
+	boost::mutex::scoped_lock lock(_indexMutex);
+	_indexValid = false;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+// Must be called with _indexMutex locked
+void Inventory::buildIndex() const {
+	_index.clear();
+	_indexValid = true;
+
+	if ( !_inventory ) return;
+
+	for ( size_t n = 0; n < _inventory->networkCount(); ++n ) {
+		DataModel::Network *net = _inventory->network(n);
+
+		for ( size_t s = 0; s < net->stationCount(); ++s ) {
+			DataModel::Station *sta = net->station(s);
+
+			Core::StreamId id = Core::StreamIdTable::Intern(net->code(), sta->code(), "", "");
+			if ( id >= _index.size() ) _index.resize(id+1);
+			_index[id].stations.push_back(sta);
+
+			for ( size_t l = 0; l < sta->sensorLocationCount(); ++l ) {
+				DataModel::SensorLocation *loc = sta->sensorLocation(l);
+
+				id = Core::StreamIdTable::Intern(net->code(), sta->code(), loc->code(), "");
+				if ( id >= _index.size() ) _index.resize(id+1);
+				_index[id].locations.push_back(loc);
+			}
+		}
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const Inventory::IndexEntry *
+Inventory::indexEntry(const std::string &networkCode,
+                      const std::string &stationCode,
+                      const std::string &locationCode) const {
+	{
+		boost::mutex::scoped_lock lock(_indexMutex);
+		if ( !_indexValid ) buildIndex();
+	}
+
+	// Find does not add unknown codes to the table
+	Core::StreamId id = Core::StreamIdTable::Find(networkCode + "." + stationCode + "." + locationCode + ".");
+	if ( id == Core::InvalidStreamId || id >= _index.size() ) return NULL;
+
+	return &_index[id];
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 }
 }
@@ -19,11 +19,14 @@
 #include <seiscomp3/datamodel/pick.h>
 #include <seiscomp3/datamodel/databasereader.h>
 #include <seiscomp3/datamodel/utils.h>
+#include <seiscomp3/core/streamid.h>
 #include <seiscomp3/utils/stringfirewall.h>
 #include <seiscomp3/client.h>
 
 #include <map>
 #include <set>
+#include <vector>
+#include <boost/thread/mutex.hpp>
 
 
 namespace Seiscomp {
@@ -129,11 +132,46 @@ class SC_SYSTEM_CLIENT_API Inventory {
 		DataModel::Inventory* inventory();
 
 
+	// ----------------------------------------------------------------------
+	//  Private interface
+	// ----------------------------------------------------------------------
+	private:
+		//! Stations and sensor locations in inventory order. Entries are
+		//! addressed by the StreamId of "net.sta.." respectively
+		//! "net.sta.loc.", stations and locations with an empty code
+		//! share an entry but not a list.
+		struct IndexEntry {
+			std::vector<DataModel::Station*>        stations;
+			std::vector<DataModel::SensorLocation*> locations;
+		};
+
+		typedef std::vector<IndexEntry> Index;
+
+		class IndexObserver;
+		friend class IndexObserver;
+
+		bool contains(const DataModel::Object *object) const;
+		void inventoryChanged();
+		void invalidateIndex();
+		void buildIndex() const;
+		const IndexEntry *indexEntry(const std::string &networkCode,
+		                             const std::string &stationCode,
+		                             const std::string &locationCode) const;
+
+
 	// ----------------------------------------------------------------------
 	//  Private members
 	// ----------------------------------------------------------------------
 	private:
 		DataModel::InventoryPtr _inventory;
+		// Built when the inventory is set and rebuilt on first use after
+		// it has been modified. Lookups may run concurrently, modifying
+		// the inventory while looking up stations is not allowed.
+		mutable Index           _index;
+		mutable bool            _indexValid;
+		mutable boost::mutex    _indexMutex;
+		// Only registered while an inventory is set
+		DataModel::ObserverPtr  _observer;
 		static Inventory        _instance;
 };
 
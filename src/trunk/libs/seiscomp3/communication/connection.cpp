@@ -29,14 +29,29 @@ namespace
 Protocol::MSG_CONTENT_TYPES encodingLUT[MessageEncoding::Quantity] =
 {
 	Protocol::CONTENT_BINARY,
-	Protocol::CONTENT_XML
+	Protocol::CONTENT_XML,
+	Protocol::CONTENT_BINARY,
+	Protocol::CONTENT_BINARY,
+	Protocol::CONTENT_UNCOMPRESSED_BINARY
+};
+
+
+// zlib compression level per encoding, -1 is the zlib default
+int compressionLUT[MessageEncoding::Quantity] =
+{
+	-1,
+	-1,
+	1,
+	9,
+	0
 };
 
 
 NetworkMessage* encode(Core::Message *msg, const MessageEncoding &enc,
                        int schemaVersion)
 {
-	return NetworkMessage::Encode(msg, encodingLUT[enc], schemaVersion);
+	return NetworkMessage::Encode(msg, encodingLUT[enc], schemaVersion,
+	                              compressionLUT[enc]);
 }
 
 
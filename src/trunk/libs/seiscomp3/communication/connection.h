@@ -86,11 +86,17 @@ namespace Communication
 MAKEENUM(MessageEncoding,
 	EVALUES(
 		BINARY_ENCODING,
-		XML_ENCODING
+		XML_ENCODING,
+		FAST_BINARY_ENCODING,
+		BEST_BINARY_ENCODING,
+		UNCOMPRESSED_BINARY_ENCODING
 	),
 	ENAMES(
 		"binary",
-		"xml"
+		"xml",
+		"binary-fast",
+		"binary-best",
+		"binary-raw"
 	)
 );
 
@@ -135,6 +141,11 @@ public:
 	 * preserve object compatibility while BINARY_ENCODING needs
 	 * objects layouted exactly the same to communicate with another
 	 * system.
+	 * The binary variants trade compression ratio against CPU time:
+	 * FAST_BINARY_ENCODING and BEST_BINARY_ENCODING use the lowest and
+	 * highest zlib level and can be read by every receiver.
+	 * UNCOMPRESSED_BINARY_ENCODING skips zlib which is cheapest on fast
+	 * links but requires receivers that know the content type.
 	 * @param enc The encoding (default: BINARY_ENCODING)
 	 */
 	void setEncoding(MessageEncoding enc);
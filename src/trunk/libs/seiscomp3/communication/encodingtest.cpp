@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+// Encodes a notifier message with picks with every message encoding,
+// checks that it decodes again and reports size and encoding and
+// decoding time. Usage: testmessageencoding [picks] [repeats]
+
+
+#include <seiscomp3/communication/connection.h>
+#include <seiscomp3/communication/systemmessages.h>
+#include <seiscomp3/datamodel/notifier.h>
+#include <seiscomp3/datamodel/pick.h>
+#include <seiscomp3/core/strings.h>
+#include <seiscomp3/utils/timer.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::Communication;
+
+
+namespace {
+
+
+struct Encoding {
+	const char                  *name;
+	Protocol::MSG_CONTENT_TYPES  type;
+	int                          level;
+};
+
+
+// Mirrors the content type and zlib level of the connection encodings
+const Encoding encodings[] = {
+	{ "binary", Protocol::CONTENT_BINARY, -1 },
+	{ "binary-fast", Protocol::CONTENT_BINARY, 1 },
+	{ "binary-best", Protocol::CONTENT_BINARY, 9 },
+	{ "binary-raw", Protocol::CONTENT_UNCOMPRESSED_BINARY, 0 },
+	{ "xml", Protocol::CONTENT_XML, -1 }
+};
+
+
+DataModel::NotifierMessage *createMessage(int picks) {
+	DataModel::NotifierMessage *msg = new DataModel::NotifierMessage;
+	Core::Time time = Core::Time(2015, 1, 1);
+
+	for ( int i = 0; i < picks; ++i ) {
+		char publicID[32];
+		snprintf(publicID, sizeof(publicID), "Pick/20150101/%06d", i);
+
+		DataModel::PickPtr pick = DataModel::Pick::Create(publicID);
+		pick->setTime(time + Core::TimeSpan(i * 0.37));
+		pick->setWaveformID(DataModel::WaveformStreamID("XX", "S" + Core::toString(i % 500), "", "BHZ", ""));
+		pick->setPhaseHint(DataModel::Phase("P"));
+		pick->setEvaluationMode(DataModel::EvaluationMode(DataModel::AUTOMATIC));
+
+		msg->attach(new DataModel::Notifier("EventParameters", DataModel::OP_ADD, pick.get()));
+	}
+
+	return msg;
+}
+
+
+}
+
+
+int main(int argc, char **argv) {
+	int picks = argc > 1 ? atoi(argv[1]) : 100;
+	int repeats = argc > 2 ? atoi(argv[2]) : 100;
+
+	DataModel::NotifierMessagePtr msg = createMessage(picks);
+
+	int errors = 0;
+
+	printf("%d picks, %d repeats\n", picks, repeats);
+
+	for ( size_t e = 0; e < sizeof(encodings)/sizeof(encodings[0]); ++e ) {
+		const Encoding &enc = encodings[e];
+		NetworkMessage *nm = NULL;
+
+		Util::StopWatch timer;
+		for ( int r = 0; r < repeats; ++r ) {
+			delete nm;
+			nm = NetworkMessage::Encode(msg.get(), enc.type, -1, enc.level);
+		}
+		double encodeTime = (double)timer.elapsed() / repeats;
+
+		Core::MessagePtr decoded;
+		timer.restart();
+		for ( int r = 0; r < repeats; ++r )
+			decoded = nm->decode();
+		double decodeTime = (double)timer.elapsed() / repeats;
+
+		DataModel::NotifierMessage *nmsg = DataModel::NotifierMessage::Cast(decoded);
+		if ( nmsg == NULL || nmsg->size() != msg->size() ) {
+			fprintf(stderr, "%s: decoding failed\n", enc.name);
+			++errors;
+		}
+		else
+			printf("%-12s %8lu bytes, encode %8.1f us, decode %8.1f us\n",
+			       enc.name, (unsigned long)nm->data().size(),
+			       encodeTime * 1E6, decodeTime * 1E6);
+
+		delete nm;
+	}
+
+	return errors ? 1 : 0;
+}
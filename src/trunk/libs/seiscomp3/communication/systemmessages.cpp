@@ -41,6 +41,21 @@ namespace Communication
 namespace
 {
 
+bool isCompressed(Protocol::MSG_CONTENT_TYPES type) {
+	switch ( type ) {
+		case Protocol::CONTENT_BINARY:
+		case Protocol::CONTENT_XML:
+		case Protocol::CONTENT_BSON:
+		case Protocol::CONTENT_JSON:
+			return true;
+		default:
+			break;
+	}
+
+	return false;
+}
+
+
 template<typename Ch>
 class buffer_sink
 {
@@ -427,7 +442,8 @@ void NetworkMessage::setContentType(Protocol::MSG_CONTENT_TYPES type) throw(Core
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 NetworkMessage* NetworkMessage::Encode(Seiscomp::Core::Message* msg,
                                        Protocol::MSG_CONTENT_TYPES type,
-                                       int schemaVersion)
+                                       int schemaVersion,
+                                       int compressionLevel)
 {
 	NetworkMessage *nm = new NetworkMessage(Protocol::DATA_MSG);
 	std::string &data = nm->data();
@@ -436,10 +452,13 @@ NetworkMessage* NetworkMessage::Encode(Seiscomp::Core::Message* msg,
 	{
 		nm->setContentType(type);
 
+		// Setting up a zlib stream is expensive, only do it if needed
 		boost::iostreams::stream_buffer<boost::iostreams::back_insert_device<std::string> > buf(data);
 		boost::iostreams::filtering_ostreambuf filtered_buf;
-		filtered_buf.push(boost::iostreams::zlib_compressor());
-		filtered_buf.push(buf);
+		if ( isCompressed(type) ) {
+			filtered_buf.push(boost::iostreams::zlib_compressor(compressionLevel));
+			filtered_buf.push(buf);
+		}
 
 		switch ( type )
 		{
@@ -452,6 +471,15 @@ NetworkMessage* NetworkMessage::Encode(Seiscomp::Core::Message* msg,
 			}
 				break;
 
+			case Protocol::CONTENT_UNCOMPRESSED_BINARY:
+			{
+				IO::VBinaryArchive ar(&buf, false, schemaVersion);
+				ar << msg;
+				if ( !ar.success() )
+					throw Core::GeneralException("failed to serialize archive");
+			}
+				break;
+
 			case Protocol::CONTENT_XML:
 			{
 				IO::XMLArchive ar(&filtered_buf, false, schemaVersion);
@@ -561,8 +589,10 @@ Seiscomp::Core::Message* NetworkMessage::decode() const
 
 		boost::iostreams::filtering_istreambuf filtered_buf;
 		boost::iostreams::stream_buffer<boost::iostreams::array_source> buf(data().c_str(), data().size());
-		filtered_buf.push(boost::iostreams::zlib_decompressor());
-		filtered_buf.push(buf);
+		if ( isCompressed(cType) ) {
+			filtered_buf.push(boost::iostreams::zlib_decompressor());
+			filtered_buf.push(buf);
+		}
 
 		switch ( cType )
 		{
@@ -573,6 +603,13 @@ Seiscomp::Core::Message* NetworkMessage::decode() const
 			}
 				break;
 
+			case Protocol::CONTENT_UNCOMPRESSED_BINARY:
+			{
+				IO::VBinaryArchive ar(&buf, true);
+				ar >> msg;
+			}
+				break;
+
 			case Protocol::CONTENT_XML:
 			{
 				IO::XMLArchive ar(&filtered_buf, true);
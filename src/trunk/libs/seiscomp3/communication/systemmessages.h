@@ -134,9 +134,17 @@ public:
 	 */
 	virtual NetworkMessage* copy() const;
 
+	/** Encodes a message.
+	 *  @param type The content type
+	 *  @param schemaVersion The packed schema version to write
+	 *  @param compressionLevel The zlib compression level (0-9) used for
+	 *                          compressed content types, -1 selects the
+	 *                          zlib default
+	 */
 	static NetworkMessage* Encode(Seiscomp::Core::Message*,
 	                              Protocol::MSG_CONTENT_TYPES type,
-	                              int schemaVersion = -1);
+	                              int schemaVersion = -1,
+	                              int compressionLevel = -1);
 	Seiscomp::Core::Message* decode() const;
 
 
@@ -32,7 +32,8 @@ IMPLEMENT_INTERFACE_FACTORY(Record, SC_SYSTEM_CORE_API);
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 Record::Record(Array::DataType datatype, Hint h)
  : _net(""), _sta(""), _loc(""), _cha(""), _stime(Core::Time(0,0)),
-   _datatype(datatype), _hint(h), _nsamp(0), _fsamp(0), _timequal(-1) {}
+   _datatype(datatype), _hint(h), _nsamp(0), _fsamp(0), _timequal(-1),
+   _streamId(Core::InvalidStreamId) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -43,7 +44,8 @@ Record::Record(Array::DataType datatype, Hint h,
                std::string net, std::string sta, std::string loc, std::string cha,
                Core::Time stime, int nsamp, double fsamp, int tqual)
  : _net(net), _sta(sta), _loc(loc), _cha(cha), _stime(stime),
-   _datatype(datatype), _hint(h), _nsamp(nsamp), _fsamp(fsamp), _timequal(tqual) {}
+   _datatype(datatype), _hint(h), _nsamp(nsamp), _fsamp(fsamp), _timequal(tqual),
+   _streamId(Core::InvalidStreamId) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -55,7 +57,8 @@ Record::Record(const Record &rec)
    _net(rec.networkCode()), _sta(rec.stationCode()), _loc(rec.locationCode()),
    _cha(rec.channelCode()), _stime(rec.startTime()), _datatype(rec.dataType()),
    _hint(rec._hint), _nsamp(rec.sampleCount()),
-   _fsamp(rec.samplingFrequency()), _timequal(rec.timingQuality()) {}
+   _fsamp(rec.samplingFrequency()), _timequal(rec.timingQuality()),
+   _streamId(rec._streamId) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -77,6 +80,7 @@ Record& Record::operator=(const Record &rec) {
 		_sta = rec.stationCode();
 		_loc = rec.locationCode();
 		_cha = rec.channelCode();
+		_streamId = rec._streamId;
 		_stime = rec.startTime();
 		_nsamp = rec.sampleCount();
 		_fsamp = rec.samplingFrequency();
@@ -102,6 +106,7 @@ const std::string &Record::networkCode() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Record::setNetworkCode(std::string net) {
 	_net = net;
+	_streamId = Core::InvalidStreamId;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -120,6 +125,7 @@ const std::string &Record::stationCode() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Record::setStationCode(std::string sta) {
 	_sta = sta;
+	_streamId = Core::InvalidStreamId;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -138,6 +144,7 @@ const std::string &Record::locationCode() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Record::setLocationCode(std::string loc) {
 	_loc = loc;
+	_streamId = Core::InvalidStreamId;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -156,6 +163,7 @@ const std::string &Record::channelCode() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Record::setChannelCode(std::string cha) {
 	_cha = cha;
+	_streamId = Core::InvalidStreamId;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -242,8 +250,19 @@ void Record::setTimingQuality(int tqual) {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-std::string Record::streamID() const {
-	return (_net+"."+_sta+"."+_loc+"."+_cha);
+const std::string &Record::streamID() const {
+	return Core::StreamIdTable::Name(streamId());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::StreamId Record::streamId() const {
+	if ( _streamId == Core::InvalidStreamId )
+		_streamId = Core::StreamIdTable::Intern(_net, _sta, _loc, _cha);
+	return _streamId;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -285,6 +304,9 @@ void Record::serialize(Archive& ar) {
 	ar & TAGGED_MEMBER(cha);
 	ar & TAGGED_MEMBER(stime);
 	ar & TAGGED_MEMBER(fsamp);
+
+	if ( ar.isReading() )
+		_streamId = Core::InvalidStreamId;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -24,6 +24,7 @@
 #include <seiscomp3/core/timewindow.h>
 #include <seiscomp3/core/array.h>
 #include <seiscomp3/core/exceptions.h>
+#include <seiscomp3/core/streamid.h>
 
 
 
@@ -132,7 +133,11 @@ class SC_SYSTEM_CORE_API Record : public Seiscomp::Core::BaseObject {
 		void setTimingQuality(int tqual);
 
 		//! Returns the so called stream ID: <net>.<sta>.<loc>.<cha>
-		std::string streamID() const;
+		const std::string &streamID() const;
+
+		//! Returns the interned id of the stream. The codes are interned
+		//! on first access and the id is cached until a code changes.
+		Core::StreamId streamId() const;
 
 		//! Returns the data type specified for the data sample requests
 		Array::DataType dataType() const;
@@ -190,6 +195,9 @@ class SC_SYSTEM_CORE_API Record : public Seiscomp::Core::BaseObject {
 		int             _nsamp;
 		double          _fsamp;
 		int             _timequal;
+
+	private:
+		mutable Core::StreamId _streamId;
 };
 
 
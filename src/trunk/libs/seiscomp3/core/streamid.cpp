@@ -0,0 +1,309 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#include <seiscomp3/core/streamid.h>
+#include <seiscomp3/core/exceptions.h>
+
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+
+namespace Seiscomp {
+namespace Core {
+
+
+namespace {
+
+
+struct Entry {
+	std::string  codes[4];
+	std::string  name;
+	unsigned int hash;
+	StreamId     next;
+};
+
+
+// FNV-1a
+inline unsigned int hashAppend(unsigned int h, const char *s, size_t len) {
+	for ( size_t i = 0; i < len; ++i ) {
+		h ^= (unsigned char)s[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+
+inline unsigned int hashName(const std::string &name) {
+	return hashAppend(2166136261u, name.data(), name.size());
+}
+
+
+// Hashes the codes as if they were joined with dots to be consistent
+// with hashName
+inline unsigned int hashCodes(const std::string &net, const std::string &sta,
+                              const std::string &loc, const std::string &cha) {
+	static const char dot = '.';
+	unsigned int h = 2166136261u;
+	h = hashAppend(h, net.data(), net.size());
+	h = hashAppend(h, &dot, 1);
+	h = hashAppend(h, sta.data(), sta.size());
+	h = hashAppend(h, &dot, 1);
+	h = hashAppend(h, loc.data(), loc.size());
+	h = hashAppend(h, &dot, 1);
+	return hashAppend(h, cha.data(), cha.size());
+}
+
+
+struct Table {
+	// Entries are stored in chunks that are allocated once and never
+	// moved or freed. An id is only handed out after its entry has been
+	// written, so readers holding a valid id can access the entry without
+	// taking the mutex.
+	enum {
+		ChunkSize = 1024,
+		MaxChunks = 4096
+	};
+
+	Table() : count(0), buckets(1024, InvalidStreamId) {
+		for ( int i = 0; i < MaxChunks; ++i ) chunks[i] = NULL;
+	}
+
+	Entry                *chunks[MaxChunks];
+	size_t                count;
+	std::vector<StreamId> buckets;
+	boost::mutex          mutex;
+
+	const Entry *get(StreamId id) const {
+		if ( id == InvalidStreamId ) return NULL;
+		const Entry *chunk = chunks[(id-1) / ChunkSize];
+		if ( chunk == NULL ) return NULL;
+		return &chunk[(id-1) % ChunkSize];
+	}
+
+	Entry &at(StreamId id) {
+		return chunks[(id-1) / ChunkSize][(id-1) % ChunkSize];
+	}
+
+	StreamId add(const std::string &net, const std::string &sta,
+	             const std::string &loc, const std::string &cha,
+	             const std::string &name, unsigned int hash) {
+		if ( count % ChunkSize == 0 ) {
+			if ( count / ChunkSize >= MaxChunks )
+				throw OverflowException("stream id table is full");
+			chunks[count / ChunkSize] = new Entry[ChunkSize];
+		}
+
+		StreamId id = (StreamId)(count+1);
+		Entry &e = at(id);
+		e.codes[0] = net; e.codes[1] = sta;
+		e.codes[2] = loc; e.codes[3] = cha;
+		e.name = name;
+		e.hash = hash;
+		++count;
+
+		if ( count > buckets.size() ) rehash(buckets.size()*2);
+		else {
+			size_t b = hash & (buckets.size()-1);
+			e.next = buckets[b];
+			buckets[b] = id;
+		}
+
+		return id;
+	}
+
+	void rehash(size_t size) {
+		buckets.assign(size, InvalidStreamId);
+		for ( size_t i = 1; i <= count; ++i ) {
+			Entry &e = at((StreamId)i);
+			size_t b = e.hash & (size-1);
+			e.next = buckets[b];
+			buckets[b] = (StreamId)i;
+		}
+	}
+
+	StreamId findName(const std::string &name, unsigned int hash) const {
+		StreamId id = buckets[hash & (buckets.size()-1)];
+		while ( id != InvalidStreamId ) {
+			const Entry &e = *get(id);
+			if ( e.hash == hash && e.name == name ) return id;
+			id = e.next;
+		}
+
+		return InvalidStreamId;
+	}
+};
+
+
+Table &table() {
+	static Table t;
+	return t;
+}
+
+
+const std::string &emptyString() {
+	static std::string s;
+	return s;
+}
+
+
+}
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+StreamId StreamIdTable::Intern(const std::string &networkCode,
+                               const std::string &stationCode,
+                               const std::string &locationCode,
+                               const std::string &channelCode) {
+	Table &t = table();
+	unsigned int hash = hashCodes(networkCode, stationCode, locationCode, channelCode);
+
+	boost::mutex::scoped_lock lock(t.mutex);
+
+	StreamId id = t.buckets[hash & (t.buckets.size()-1)];
+	while ( id != InvalidStreamId ) {
+		const Entry &e = *t.get(id);
+		if ( e.hash == hash &&
+		     e.codes[3] == channelCode && e.codes[1] == stationCode &&
+		     e.codes[0] == networkCode && e.codes[2] == locationCode )
+			return id;
+		id = e.next;
+	}
+
+	return t.add(networkCode, stationCode, locationCode, channelCode,
+	             networkCode + "." + stationCode + "." + locationCode + "." + channelCode,
+	             hash);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+StreamId StreamIdTable::Intern(const std::string &streamID) {
+	Table &t = table();
+	unsigned int hash = hashName(streamID);
+
+	boost::mutex::scoped_lock lock(t.mutex);
+
+	StreamId id = t.findName(streamID, hash);
+	if ( id != InvalidStreamId ) return id;
+
+	std::string codes[4];
+	size_t pos = 0;
+	for ( int i = 0; i < 3; ++i ) {
+		size_t dot = streamID.find('.', pos);
+		if ( dot == std::string::npos ) {
+			codes[i] = streamID.substr(pos);
+			pos = streamID.size();
+			break;
+		}
+
+		codes[i] = streamID.substr(pos, dot-pos);
+		pos = dot+1;
+	}
+
+	if ( pos < streamID.size() )
+		codes[3] = streamID.substr(pos);
+
+	return t.add(codes[0], codes[1], codes[2], codes[3], streamID, hash);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+StreamId StreamIdTable::Find(const std::string &streamID) {
+	Table &t = table();
+	unsigned int hash = hashName(streamID);
+	boost::mutex::scoped_lock lock(t.mutex);
+	return t.findName(streamID, hash);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::string &StreamIdTable::Name(StreamId id) {
+	const Entry *e = table().get(id);
+	return e != NULL ? e->name : emptyString();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::string *StreamIdTable::Codes(StreamId id) {
+	const Entry *e = table().get(id);
+	return e != NULL ? e->codes : NULL;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::string &StreamIdTable::NetworkCode(StreamId id) {
+	const Entry *e = table().get(id);
+	return e != NULL ? e->codes[0] : emptyString();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::string &StreamIdTable::StationCode(StreamId id) {
+	const Entry *e = table().get(id);
+	return e != NULL ? e->codes[1] : emptyString();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::string &StreamIdTable::LocationCode(StreamId id) {
+	const Entry *e = table().get(id);
+	return e != NULL ? e->codes[2] : emptyString();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::string &StreamIdTable::ChannelCode(StreamId id) {
+	const Entry *e = table().get(id);
+	return e != NULL ? e->codes[3] : emptyString();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t StreamIdTable::Size() {
+	Table &t = table();
+	boost::mutex::scoped_lock lock(t.mutex);
+	return t.count;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_CORE_STREAMID_H__
+#define __SEISCOMP_CORE_STREAMID_H__
+
+
+#include <string>
+#include <seiscomp3/core.h>
+
+
+namespace Seiscomp {
+namespace Core {
+
+
+//! Integer handle of an interned stream identifier. Ids are assigned
+//! consecutively starting with 1 and are valid for the lifetime of the
+//! process, so they can be used as array indexes.
+typedef unsigned int StreamId;
+
+//! The id of a stream that has not been interned yet
+const StreamId InvalidStreamId = 0;
+
+
+/**
+ * \brief Process wide symbol table of stream identifiers.
+ *
+ * Each distinct combination of network, station, location and channel
+ * code is stored exactly once and mapped to a StreamId. Comparing and
+ * hashing StreamIds is much cheaper than comparing four strings, and the
+ * interned codes and the "net.sta.loc.cha" name can be returned by
+ * reference without allocating.
+ *
+ * The table only grows; entries are never removed and never move in
+ * memory. All methods are thread safe. Name() and the code accessors do
+ * not lock for ids returned by Intern() or Find().
+ */
+class SC_SYSTEM_CORE_API StreamIdTable {
+	public:
+		//! Returns the id of the stream and adds it to the table if
+		//! it does not exist yet
+		static StreamId Intern(const std::string &networkCode,
+		                       const std::string &stationCode,
+		                       const std::string &locationCode,
+		                       const std::string &channelCode);
+
+		//! Returns the id of a stream given as "net.sta.loc.cha" and adds
+		//! it to the table if it does not exist yet
+		static StreamId Intern(const std::string &streamID);
+
+		//! Returns the id of a stream given as "net.sta.loc.cha" or
+		//! InvalidStreamId if it has not been interned yet
+		static StreamId Find(const std::string &streamID);
+
+		//! Returns "net.sta.loc.cha" of an interned stream. An empty
+		//! string is returned for unknown ids.
+		static const std::string &Name(StreamId id);
+
+		//! Returns the network, station, location and channel code of an
+		//! interned stream as an array of four strings or NULL for
+		//! unknown ids
+		static const std::string *Codes(StreamId id);
+
+		static const std::string &NetworkCode(StreamId id);
+		static const std::string &StationCode(StreamId id);
+		static const std::string &LocationCode(StreamId id);
+		static const std::string &ChannelCode(StreamId id);
+
+		//! Returns the number of interned streams which is also the
+		//! highest assigned id
+		static size_t Size();
+};
+
+
+}
+}
+
+
+#endif
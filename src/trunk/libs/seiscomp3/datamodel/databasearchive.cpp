@@ -14,9 +14,11 @@
 #define SEISCOMP_COMPONENT DatabaseArchive
 #include <seiscomp3/core/exceptions.h>
 #include <seiscomp3/datamodel/databasearchive.h>
+#include <seiscomp3/datamodel/notifier.h>
 #include <seiscomp3/datamodel/version.h>
 #include <seiscomp3/logging/log.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdlib.h>
 #include <strings.h>
@@ -126,6 +128,10 @@ const std::string& toSQL(const std::string& str) {
 }
 
 
+// Maximum number of parent ids passed with one 'in' clause
+const size_t MaxParentIDsPerQuery = 1000;
+
+
 bool strtobool(bool &val, const char *str) {
 	int v;
 	if ( fromString(v, str) ) {
@@ -201,15 +207,20 @@ Object* DatabaseIterator::fetch() const {
 	_cached = false;
 
 	int col;
+	long id;
 	_parent_oid = _oid = -1;
-	if ( (col = _reader->_db->findColumn("_oid")) != -1)
-		Core::fromString(_oid, std::string(static_cast<const char*>(_reader->_db->getRowField(col))));
-		
-	if ( (col = _reader->_db->findColumn("_parent_oid")) != -1)
-		Core::fromString(_parent_oid, std::string(static_cast<const char*>(_reader->_db->getRowField(col))));
-
-	if ( (col = _reader->_db->findColumn("_last_modified")) != -1)
-		_lastModified = _reader->_db->stringToTime(static_cast<const char*>(_reader->_db->getRowField(col)));
+	if ( (col = _reader->_db->findColumn("_oid")) != -1 &&
+	     _reader->_db->getRowFieldInt(col, id) )
+		_oid = (int)id;
+
+	if ( (col = _reader->_db->findColumn("_parent_oid")) != -1 &&
+	     _reader->_db->getRowFieldInt(col, id) )
+		_parent_oid = (int)id;
+
+	Core::Time lastModified;
+	if ( (col = _reader->_db->findColumn("_last_modified")) != -1 &&
+	     _reader->_db->getRowFieldTime(col, lastModified) )
+		_lastModified = lastModified;
 	else
 		_lastModified = Core::None;
 
@@ -487,6 +498,7 @@ Seiscomp::IO::DatabaseInterface* DatabaseArchive::driver() const {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::setDriver(Seiscomp::IO::DatabaseInterface* db) {
 	_objectIdCache.clear();
+	_statements.clear();
 	_db = db;
 	_errorMsg = "";
 
@@ -636,6 +648,9 @@ bool DatabaseArchive::create(const char* /*dataSource*/) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::close() {
+	// Statements refer to the driver and must be released before
+	_statements.clear();
+
 	if ( _db != NULL && _allowDbClose )
 		_db->disconnect();
 	_db = NULL;
@@ -825,6 +840,149 @@ DatabaseIterator DatabaseArchive::getObjects(const PublicObject* parent,
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int DatabaseArchive::loadDescendants(PublicObject *object) {
+	return loadDescendants(std::vector<PublicObject*>(1, object));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int DatabaseArchive::loadDescendants(const std::vector<PublicObject*> &objects) {
+	if ( !validInterface() ) {
+		SEISCOMP_ERROR("no valid database interface");
+		return 0;
+	}
+
+	typedef std::map<unsigned long, PublicObject*> ParentMap;
+	typedef std::vector<unsigned long> IDList;
+	typedef std::map<const RTTI*, IDList> ChildTypeMap;
+
+	ParentMap parents;
+
+	for ( size_t i = 0; i < objects.size(); ++i ) {
+		PublicObject *object = objects[i];
+		if ( object == NULL ) continue;
+
+		unsigned long id = getCachedId(object);
+		if ( !id ) {
+			id = publicObjectId(object->publicID());
+			if ( !id ) {
+				SEISCOMP_INFO("object with id '%s' not found in database", object->publicID().c_str());
+				continue;
+			}
+			registerId(object, id);
+		}
+
+		parents[id] = object;
+	}
+
+	bool saveState = Notifier::IsEnabled();
+	Notifier::Disable();
+
+	int count = 0;
+
+	while ( !parents.empty() ) {
+		// Group the parents of this level by the types of their children.
+		// Different parent types can share a child type, e.g. comments.
+		ChildTypeMap childTypes;
+		for ( ParentMap::iterator it = parents.begin(); it != parents.end(); ++it ) {
+			const TypeList &types = this->childTypes(it->second);
+			for ( size_t i = 0; i < types.size(); ++i )
+				childTypes[types[i]].push_back(it->first);
+		}
+
+		ParentMap children;
+
+		for ( ChildTypeMap::iterator it = childTypes.begin(); it != childTypes.end(); ++it ) {
+			const RTTI *type = it->first;
+			const IDList &ids = it->second;
+			bool isPublic = type->isTypeOf(PublicObject::TypeInfo());
+
+			for ( size_t i = 0; i < ids.size(); i += MaxParentIDsPerQuery ) {
+				IDList chunk(ids.begin() + i,
+				             ids.begin() + std::min(ids.size(), i + MaxParentIDsPerQuery));
+
+				DatabaseIterator dbit = getObjectIterator(chunk, *type);
+				while ( *dbit ) {
+					Object *child = *dbit;
+					ParentMap::iterator pit = parents.find(dbit.parentOid());
+
+					if ( pit == parents.end() )
+						SEISCOMP_WARNING("%s: unexpected parent id %d",
+						                 type->className(), dbit.parentOid());
+					else if ( child->parent() == pit->second ) {
+						// Already attached, e.g. a cached public object
+						// loaded before: its descendants may be missing
+						if ( isPublic )
+							children[dbit.oid()] = static_cast<PublicObject*>(child);
+					}
+					else if ( child->parent() != NULL ) {
+						PublicObject *po = PublicObject::Cast(child);
+						SEISCOMP_WARNING("%s::add(%s%s%s): object has already another parent",
+						                 pit->second->className(), type->className(),
+						                 po ? " " : "", po ? po->publicID().c_str() : "");
+					}
+					else if ( child->attachTo(pit->second) ) {
+						++count;
+						if ( isPublic ) {
+							if ( dbit.cached() ) registerId(child, dbit.oid());
+							children[dbit.oid()] = static_cast<PublicObject*>(child);
+						}
+					}
+
+					++dbit;
+				}
+				dbit.close();
+			}
+		}
+
+		parents.swap(children);
+	}
+
+	Notifier::SetEnabled(saveState);
+
+	return count;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const DatabaseArchive::TypeList &DatabaseArchive::childTypes(const Object *object) {
+	ChildTypeCache::iterator cit = _childTypes.find(&object->typeInfo());
+	if ( cit != _childTypes.end() ) return cit->second;
+
+	TypeList &types = _childTypes[&object->typeInfo()];
+
+	for ( const MetaObject *meta = object->meta(); meta != NULL; meta = meta->base() ) {
+		for ( size_t i = 0; i < meta->propertyCount(); ++i ) {
+			const MetaProperty *prop = meta->property(i);
+			if ( !prop->isArray() || !prop->isClass() ) continue;
+
+			BaseObjectPtr child = ClassFactory::Create(prop->type());
+			if ( !child ) {
+				SEISCOMP_WARNING("loadDescendants: unknown child type '%s'",
+				                 prop->type().c_str());
+				continue;
+			}
+
+			const RTTI *type = &child->typeInfo();
+			if ( std::find(types.begin(), types.end(), type) == types.end() )
+				types.push_back(type);
+		}
+	}
+
+	return types;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 size_t DatabaseArchive::getObjectCount(const std::string& parentID,
                                        const Seiscomp::Core::RTTI& classType) {
@@ -956,7 +1114,24 @@ DatabaseIterator DatabaseArchive::getObjectIterator(unsigned long parentID,
 			query += " where ";
 
 		query += classType.className();
-		query += "._parent_oid='" + toString(parentID) + "'";
+		query += "._parent_oid=";
+
+		IO::DatabaseStatement *stmt = statement(query + "?");
+		if ( stmt != NULL ) {
+			if ( !stmt->bindInt(0, (long)parentID) || !stmt->beginQuery() ) {
+				SEISCOMP_ERROR("starting query '%s?' failed", query.c_str());
+				return DatabaseIterator();
+			}
+
+			if ( !_db->fetchRow() ) {
+				_db->endQuery();
+				return DatabaseIterator();
+			}
+
+			return DatabaseIterator(this, &classType);
+		}
+
+		query += "'" + toString(parentID) + "'";
 	}
 
 	return getObjectIterator(query, classType);
@@ -966,6 +1141,41 @@ DatabaseIterator DatabaseArchive::getObjectIterator(unsigned long parentID,
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+DatabaseIterator DatabaseArchive::getObjectIterator(const std::vector<unsigned long> &parentIDs,
+                                                    const RTTI& classType) {
+	if ( !validInterface() ) {
+		SEISCOMP_ERROR("no valid database interface");
+		return DatabaseIterator();
+	}
+
+	if ( parentIDs.empty() ) return DatabaseIterator();
+
+	std::stringstream ss;
+	if ( classType.isTypeOf(PublicObject::TypeInfo()) ) {
+		ss << "select " << PublicObject::ClassName() << "." << _publicIDColumn << ","
+		   << classType.className() << ".* from "
+		   << PublicObject::ClassName() << "," << classType.className()
+		   << " where " << PublicObject::ClassName() << "._oid="
+		   << classType.className() << "._oid and ";
+	}
+	else
+		ss << "select * from " << classType.className() << " where ";
+
+	ss << classType.className() << "._parent_oid in (";
+	for ( size_t i = 0; i < parentIDs.size(); ++i ) {
+		if ( i > 0 ) ss << ",";
+		ss << parentIDs[i];
+	}
+	ss << ")";
+
+	return getObjectIterator(ss.str(), classType);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 DatabaseIterator DatabaseArchive::getObjectIterator(const std::string& query,
                                                     const Seiscomp::Core::RTTI &classType) {
@@ -1025,7 +1235,11 @@ std::string DatabaseArchive::toString(const char *value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::read(int& value) {
-	fromString(value, field());
+	long v;
+	if ( _db->getRowFieldInt(_fieldIndex, v) )
+		value = (int)v;
+	else
+		fromString(value, field());
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1034,7 +1248,11 @@ void DatabaseArchive::read(int& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::read(float& value) {
-	fromString(value, field());
+	double v;
+	if ( _db->getRowFieldDouble(_fieldIndex, v) )
+		value = (float)v;
+	else
+		fromString(value, field());
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1043,7 +1261,8 @@ void DatabaseArchive::read(float& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::read(double& value) {
-	fromString(value, field());
+	if ( !_db->getRowFieldDouble(_fieldIndex, value) )
+		fromString(value, field());
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1146,7 +1365,9 @@ void DatabaseArchive::read(std::string& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::read(time_t& value) {
-	Time t = _db->stringToTime(field());
+	Time t;
+	if ( !_db->getRowFieldTime(_fieldIndex, t) )
+		t = _db->stringToTime(field());
 	value = t.seconds();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -1156,13 +1377,14 @@ void DatabaseArchive::read(time_t& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::read(Time& value) {
-	value = _db->stringToTime(field());
+	if ( !_db->getRowFieldTime(_fieldIndex, value) )
+		value = _db->stringToTime(field());
 	if ( hint() & SPLIT_TIME ) {
-		int microSeconds;
+		long microSeconds;
 		_currentAttributeName += MICROSECONDS_POSTFIX;
 		readAttrib();
 		if ( field() != NULL ) {
-			if ( fromString(microSeconds, field()) )
+			if ( _db->getRowFieldInt(_fieldIndex, microSeconds) )
 				value.setUSecs(microSeconds);
 		}
 	}
@@ -1201,7 +1423,8 @@ void DatabaseArchive::write(double value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::complex<float>& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1210,7 +1433,8 @@ void DatabaseArchive::write(std::complex<float>& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::complex<double>& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1219,7 +1443,8 @@ void DatabaseArchive::write(std::complex<double>& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(bool value) {
-	writeAttrib(std::string(value?"'1'":"'0'"));
+	std::string raw(value?"1":"0");
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1228,7 +1453,8 @@ void DatabaseArchive::write(bool value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::vector<char>& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1237,7 +1463,8 @@ void DatabaseArchive::write(std::vector<char>& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::vector<int>& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1246,7 +1473,8 @@ void DatabaseArchive::write(std::vector<int>& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::vector<float>& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1255,7 +1483,8 @@ void DatabaseArchive::write(std::vector<float>& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::vector<double>& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1264,7 +1493,8 @@ void DatabaseArchive::write(std::vector<double>& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::vector<std::string>& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1273,7 +1503,8 @@ void DatabaseArchive::write(std::vector<std::string>& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::vector<std::complex<double> >& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1282,7 +1513,7 @@ void DatabaseArchive::write(std::vector<std::complex<double> >& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(std::string& value) {
-	writeAttrib("'" + toSQL(value) + "'");
+	writeAttrib("'" + toSQL(value) + "'", &value);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1291,7 +1522,8 @@ void DatabaseArchive::write(std::string& value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(time_t value) {
-	writeAttrib("'" + toString(Time(value)) + "'");
+	std::string raw = toString(Time(value));
+	writeAttrib("'" + raw + "'", &raw);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1300,7 +1532,8 @@ void DatabaseArchive::write(time_t value) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void DatabaseArchive::write(Time& value) {
-	writeAttrib("'" + toString(value) + "'");
+	std::string raw = toString(value);
+	writeAttrib("'" + raw + "'", &raw);
 	if ( hint() & SPLIT_TIME ) {
 		std::string backupName = _currentAttributeName;
 		_currentAttributeName += MICROSECONDS_POSTFIX;
@@ -1314,7 +1547,8 @@ void DatabaseArchive::write(Time& value) {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-void DatabaseArchive::writeAttrib(OPT_CR(std::string) value) const {
+void DatabaseArchive::writeAttrib(OPT_CR(std::string) value,
+                                  const std::string *raw) const {
 	std::string indexName;
 	std::string& index = indexName;
 
@@ -1332,10 +1566,17 @@ void DatabaseArchive::writeAttrib(OPT_CR(std::string) value) const {
 	if ( (hint() & INDEX_ATTRIBUTE) && _ignoreIndexAttributes )
 		map = &_indexAttributes;
 
+	std::string column = _db->convertColumnName(index);
+
 	if ( value )
-		(*map)[_db->convertColumnName(index)] = *value;
+		(*map)[column] = *value;
+	else
+		(*map)[column] = None;
+
+	if ( raw != NULL )
+		_rawValues[map][column] = *raw;
 	else
-		(*map)[_db->convertColumnName(index)] = None;
+		_rawValues[map].erase(column);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1367,6 +1608,23 @@ void DatabaseArchive::renderValues(const AttributeMap& attributes) {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 unsigned long DatabaseArchive::publicObjectId(const std::string& publicId) {
 	unsigned long id = 0;
+
+	IO::DatabaseStatement *stmt = statement(std::string("select _oid from ") +
+	                                        PublicObject::ClassName() + " where " +
+	                                        _publicIDColumn + "=?");
+	if ( stmt != NULL ) {
+		if ( !stmt->bindString(0, publicId) || !stmt->beginQuery() )
+			return id;
+
+		long oid;
+		if ( _db->fetchRow() && _db->getRowFieldInt(0, oid) )
+			id = (unsigned long)oid;
+
+		_db->endQuery();
+
+		return id;
+	}
+
 	std::stringstream ss;
 	ss << "select _oid from " << PublicObject::ClassName()
 	   << " where " << _publicIDColumn << "='" << toSQL(publicId) << "'";
@@ -1395,6 +1653,7 @@ unsigned long DatabaseArchive::objectId(Object* object, const std::string& paren
 	_objectAttributes->clear();
 	_indexAttributes.clear();
 	_childTables.clear();
+	_rawValues.clear();
 	_childDepth = 0;
 	
 	_ignoreIndexAttributes = true;
@@ -1485,6 +1744,16 @@ unsigned long DatabaseArchive::objectId(Object* object, const std::string& paren
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 unsigned long DatabaseArchive::insertObject() {
+	IO::DatabaseStatement *stmt = statement(std::string("insert into ") +
+	                                        Object::ClassName() + "(_oid) values(" +
+	                                        _db->defaultValue() + ")");
+	if ( stmt != NULL ) {
+		if ( !stmt->execute() )
+			return 0;
+
+		return _db->lastInsertId(Object::ClassName());
+	}
+
 	std::stringstream ss;
 	ss << "insert into " << Object::ClassName() << "(_oid) values("
 	   << _db->defaultValue() << ")";
@@ -1507,6 +1776,20 @@ unsigned long DatabaseArchive::insertPublicObject(const std::string& publicId) {
 	if ( objectId == 0 )
 		return 0;
 
+	IO::DatabaseStatement *stmt = statement(std::string("insert into ") +
+	                                        PublicObject::ClassName() + "(_oid," +
+	                                        _publicIDColumn + ") values(?,?)");
+	if ( stmt != NULL ) {
+		if ( !stmt->bindInt(0, (long)objectId) ||
+		     !stmt->bindString(1, publicId) ||
+		     !stmt->execute() ) {
+			deleteObject(objectId);
+			return 0;
+		}
+
+		return objectId;
+	}
+
 	std::stringstream ss;
 	ss << "insert into " << PublicObject::ClassName()
 	   << "(_oid," << _publicIDColumn << ") values("
@@ -1528,6 +1811,45 @@ unsigned long DatabaseArchive::insertPublicObject(const std::string& publicId) {
 bool DatabaseArchive::insertRow(const std::string& table,
                                 const AttributeMap& attribs,
                                 const std::string& parentId) {
+	if ( parentId.empty() ) {
+		std::stringstream ss;
+		ss << "insert into " << table << "(" << AttributeMapper(attribs)
+		   << ") values (";
+		for ( size_t i = 0; i < attribs.size(); ++i ) {
+			if ( i > 0 ) ss << ",";
+			ss << "?";
+		}
+		ss << ")";
+
+		IO::DatabaseStatement *stmt = statement(ss.str());
+		if ( stmt != NULL ) {
+			// Literals are bound with the values they have been rendered
+			// from, everything else (numbers) is passed as is and converted
+			// by the database
+			static const RawValueMap noRawValues;
+			RawValues::const_iterator rit = _rawValues.find(&attribs);
+			const RawValueMap &raw = rit != _rawValues.end() ? rit->second : noRawValues;
+
+			int index = 0;
+			for ( AttributeMap::const_iterator it = attribs.begin();
+			      it != attribs.end(); ++it, ++index ) {
+				bool bound;
+				RawValueMap::const_iterator rawIt = raw.find(it->first);
+
+				if ( !it->second )
+					bound = stmt->bindNull(index);
+				else if ( rawIt != raw.end() )
+					bound = stmt->bindString(index, rawIt->second);
+				else
+					bound = stmt->bindString(index, *it->second);
+
+				if ( !bound ) return false;
+			}
+
+			return stmt->execute();
+		}
+	}
+
 	std::stringstream ss;
 	ss.precision(12);
 	ss << "insert into " << table << "(";
@@ -1571,6 +1893,22 @@ bool DatabaseArchive::deleteObject(unsigned long id) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+IO::DatabaseStatement *DatabaseArchive::statement(const std::string &sql) {
+	StatementCache::iterator it = _statements.find(sql);
+	if ( it != _statements.end() ) return it->second.get();
+
+	// Failed or unsupported statements are cached as well to not try
+	// again for each row
+	IO::DatabaseStatement *stmt = _db->prepare(sql.c_str());
+	_statements[sql] = stmt;
+	return stmt;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool DatabaseArchive::write(Object* object, const std::string& parentId) {
 	if ( object == NULL ) return false;
@@ -1585,6 +1923,7 @@ bool DatabaseArchive::write(Object* object, const std::string& parentId) {
 	_objectAttributes = &_rootAttributes;
 	_objectAttributes->clear();
 	_childTables.clear();
+	_rawValues.clear();
 	_childDepth = 0;
 	_ignoreIndexAttributes = false;
 
@@ -1693,6 +2032,7 @@ bool DatabaseArchive::update(Object* object, const std::string& parentID) {
 	_objectAttributes->clear();
 	_indexAttributes.clear();
 	_childTables.clear();
+	_rawValues.clear();
 	_childDepth = 0;
 
 	PublicObject* publicObject = PublicObject::Cast(object);
@@ -19,6 +19,8 @@
 #include <seiscomp3/io/database.h>
 #include <seiscomp3/datamodel/publicobject.h>
 #include <list>
+#include <map>
+#include <vector>
 
 
 namespace Seiscomp {
@@ -294,6 +296,26 @@ class SC_SYSTEM_CORE_API DatabaseArchive : protected Seiscomp::Core::Archive,
 		size_t getObjectCount(const PublicObject* parent,
 		                      const Seiscomp::Core::RTTI &classType);
 
+		/**
+		 * Loads all descendants of a public object, e.g. the arrivals,
+		 * magnitudes and station magnitudes of an origin including their
+		 * comments and contributions. In contrast to the load methods of
+		 * DatabaseReader which issue one query per parent and child type,
+		 * the tree is read level by level with one query per child type
+		 * that covers all parents of a level and assembled in memory.
+		 * @param object The root object. It has to exist in the database.
+		 * @return The number of attached objects
+		 */
+		int loadDescendants(PublicObject *object);
+
+		/**
+		 * Loads all descendants of a list of public objects with the same
+		 * number of queries as for a single object.
+		 * @param objects The root objects
+		 * @return The number of attached objects
+		 */
+		int loadDescendants(const std::vector<PublicObject*> &objects);
+
 		/**
 		 * Returns the publicID of the parent object if any.
 		 * @param object The PublicObject whose parent is queried.
@@ -509,8 +531,16 @@ class SC_SYSTEM_CORE_API DatabaseArchive : protected Seiscomp::Core::Archive,
     	typedef std::map<const Object*, unsigned int> ObjectIdMap;
 		typedef std::map<std::string, OPT(std::string)> AttributeMap;
 
+		//! Unquoted values of the literals in an AttributeMap which are
+		//! bound to prepared statements
+		typedef std::map<std::string, std::string> RawValueMap;
+		typedef std::map<const AttributeMap*, RawValueMap> RawValues;
+
 		typedef std::pair<std::string, AttributeMap> ChildTable;
 		typedef std::list<ChildTable> ChildTables;
+		typedef std::map<std::string, Seiscomp::IO::DatabaseStatementPtr> StatementCache;
+		typedef std::vector<const Seiscomp::Core::RTTI*> TypeList;
+		typedef std::map<const Seiscomp::Core::RTTI*, TypeList> ChildTypeCache;
 
 
 	// ----------------------------------------------------------------------
@@ -528,8 +558,10 @@ class SC_SYSTEM_CORE_API DatabaseArchive : protected Seiscomp::Core::Archive,
 		//! Returns the current field size
 		size_t fieldSize() const { return _fieldSize; }
 
-		//! Writes an attribute into the attribute map
-		void writeAttrib(OPT_CR(std::string) value) const;
+		//! Writes an attribute into the attribute map. If value is a
+		//! quoted literal, raw holds the value it represents.
+		void writeAttrib(OPT_CR(std::string) value,
+		                 const std::string *raw = NULL) const;
 
 		//! Reads an attribute from the query result
 		void readAttrib() const;
@@ -551,6 +583,11 @@ class SC_SYSTEM_CORE_API DatabaseArchive : protected Seiscomp::Core::Archive,
 		DatabaseIterator getObjectIterator(unsigned long parentID,
 		                                   const Seiscomp::Core::RTTI& classType);
 
+		//! Returns an iterator for objects of a given type whose parent
+		//! is one of the given database ids.
+		DatabaseIterator getObjectIterator(const std::vector<unsigned long> &parentIDs,
+		                                   const Seiscomp::Core::RTTI& classType);
+
 		//! Queries for the database id of a PublicObject for
 		//! a given publicID
 		unsigned long publicObjectId(const std::string& publicId);
@@ -569,9 +606,19 @@ class SC_SYSTEM_CORE_API DatabaseArchive : protected Seiscomp::Core::Archive,
 		               const AttributeMap& attributes,
 		               const std::string& parentId = "");
 
+		//! Returns the types of the children of an object. Each of them
+		//! is stored in a table of its own referencing the parent by
+		//! _parent_oid.
+		const TypeList &childTypes(const Object *object);
+
 		//! Delete an object with a given database id
 		bool deleteObject(unsigned long id);
 
+		//! Returns a prepared statement for the given SQL. Statements are
+		//! cached for the lifetime of the connection. NULL is returned if
+		//! the driver does not support prepared statements.
+		Seiscomp::IO::DatabaseStatement *statement(const std::string &sql);
+
 	protected:
 		Seiscomp::IO::DatabaseInterfacePtr _db;
 
@@ -581,6 +628,8 @@ class SC_SYSTEM_CORE_API DatabaseArchive : protected Seiscomp::Core::Archive,
 		bool _checkForCached;
 
 		mutable ObjectIdMap _objectIdCache;
+		StatementCache _statements;
+		ChildTypeCache _childTypes;
 		mutable int _fieldIndex;
 		mutable const char* _field;
 		mutable size_t _fieldSize;
@@ -589,6 +638,7 @@ class SC_SYSTEM_CORE_API DatabaseArchive : protected Seiscomp::Core::Archive,
 		mutable AttributeMap _indexAttributes;
 		mutable AttributeMap* _objectAttributes;
 		mutable ChildTables _childTables;
+		mutable RawValues _rawValues;
 		mutable ChildTables::iterator _currentChildTable;
 		mutable int _childDepth;
 
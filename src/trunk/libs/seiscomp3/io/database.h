@@ -27,6 +27,84 @@ namespace Seiscomp {
 namespace IO {
 
 
+DEFINE_SMARTPOINTER(DatabaseStatement);
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+/** \brief A prepared statement of a database interface
+
+	Statements are created with DatabaseInterface::prepare. Parameters
+	are marked with '?' in the statement and are numbered starting with 0.
+	Bound values are transferred separately from the statement and need
+	neither quoting nor escaping. Bindings are kept until they are
+	replaced so a statement can be executed many times while only the
+	changed parameters are rebound.
+
+	A statement belongs to the interface that prepared it and has to be
+	destroyed before the interface is deleted.
+
+	\code
+	DatabaseStatementPtr stmt = db->prepare("select _oid from PublicObject where publicID=?");
+	stmt->bindString(0, publicID);
+	if ( stmt->beginQuery() ) {
+		long oid;
+		if ( db->fetchRow() && db->getRowFieldInt(0, oid) ) ...
+		db->endQuery();
+	}
+	\endcode
+ */
+class SC_SYSTEM_CORE_API DatabaseStatement : public Seiscomp::Core::BaseObject {
+	// ------------------------------------------------------------------
+	//  Xstruction
+	// ------------------------------------------------------------------
+	protected:
+		//! Protected constructor
+		DatabaseStatement();
+
+	public:
+		//! Destructor
+		virtual ~DatabaseStatement();
+
+
+	// ------------------------------------------------------------------
+	//  Public interface
+	// ------------------------------------------------------------------
+	public:
+		//! Returns the number of parameters of the statement
+		virtual int parameterCount() const = 0;
+
+		//! Binds SQL NULL to a parameter
+		virtual bool bindNull(int index) = 0;
+
+		//! Binds an integer to a parameter
+		virtual bool bindInt(int index, long value) = 0;
+
+		//! Binds a floating point value to a parameter
+		virtual bool bindDouble(int index, double value) = 0;
+
+		//! Binds a string to a parameter
+		virtual bool bindString(int index, const std::string &value) = 0;
+
+		//! Binds a time to a parameter. The time is stored with the
+		//! precision of the database time type.
+		virtual bool bindTime(int index, const Seiscomp::Core::Time &value) = 0;
+
+		//! Executes the statement without expecting a result
+		virtual bool execute() = 0;
+
+		/** Executes the statement and makes its result the current
+		    result of the database interface. The rows are fetched
+		    and accessed with the row methods of the interface and the
+		    query is closed with DatabaseInterface::endQuery.
+		    @return False, if the statement has not been executed
+		            because of errors.
+		  */
+		virtual bool beginQuery() = 0;
+};
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 DEFINE_SMARTPOINTER(DatabaseInterface);
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
@@ -143,6 +221,17 @@ DEFINE_SMARTPOINTER(DatabaseInterface);
 		//! Ends a query after its results are not needed anymore
 		virtual void endQuery() = 0;
 
+		/** Prepares a statement with parameter placeholders ('?') for
+		    repeated execution.
+		    @return The statement or NULL if it could not be prepared or
+		            the interface does not support prepared statements.
+		            In that case the statement has to be sent with
+		            execute or beginQuery instead.
+		            NOTE: The returned pointer has to be deleted by the
+		                  caller!
+		  */
+		virtual DatabaseStatement *prepare(const char *statement);
+
 		/** Returns the default value name for the 'insert into' statement.
 		    This is needed because sqlite3 does not support
 		    \code
@@ -222,6 +311,24 @@ DEFINE_SMARTPOINTER(DatabaseInterface);
 		  */
 		virtual size_t getRowFieldSize(int index) = 0;
 
+		/** Returns the content of an indexed field as integer. Interfaces
+		    that fetch rows in binary form return the value without
+		    parsing, the default implementation converts the string
+		    returned by getRowField.
+		    @param index The field index (column)
+		    @param value The returned value
+		    @return False, if the field is NULL or not a number
+		  */
+		virtual bool getRowFieldInt(int index, long &value);
+
+		//! Returns the content of an indexed field as double.
+		//! @see getRowFieldInt
+		virtual bool getRowFieldDouble(int index, double &value);
+
+		//! Returns the content of an indexed field as time.
+		//! @see getRowFieldInt
+		virtual bool getRowFieldTime(int index, Seiscomp::Core::Time &value);
+
 		//! Converts a time to a string representation used by
 		//! the database.
 		virtual std::string timeToString(const Seiscomp::Core::Time&);
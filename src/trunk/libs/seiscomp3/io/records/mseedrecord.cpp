@@ -14,6 +14,7 @@
 #define SEISCOMP_COMPONENT MSEEDRECORD
 #include <seiscomp3/logging/log.h>
 #include <seiscomp3/io/records/mseedrecord.h>
+#include <seiscomp3/io/records/steim.h>
 #include <seiscomp3/core/arrayfactory.h>
 
 #include <libmseed.h>
@@ -40,6 +41,155 @@ struct MSEEDLogger {
 static MSEEDLogger __logger__;
 
 
+namespace {
+
+
+inline uint16_t get16(const char *p, bool swap) {
+	uint16_t v;
+	memcpy(&v, p, 2);
+	if ( swap ) ms_gswap2a(&v);
+	return v;
+}
+
+
+inline int32_t get32(const char *p, bool swap) {
+	int32_t v;
+	memcpy(&v, p, 4);
+	if ( swap ) ms_gswap4a(&v);
+	return v;
+}
+
+
+template <typename T>
+int unpackInt(int bytes, const char *data, int nbytes, int nsamp,
+              bool swap, T *out) {
+	int n = nbytes / bytes;
+	if ( n > nsamp ) n = nsamp;
+
+	if ( bytes == 2 ) {
+		for ( int i = 0; i < n; ++i )
+			out[i] = static_cast<T>((int16_t)get16(data + i*2, swap));
+	}
+	else {
+		for ( int i = 0; i < n; ++i )
+			out[i] = static_cast<T>(get32(data + i*4, swap));
+	}
+
+	return n;
+}
+
+
+/*
+ * Decodes the samples of a raw record directly into out.
+ * Returns false if the record is not supported by the direct decoder.
+ */
+template <typename T>
+bool unpackDirect(const char *rec, int reclen, int nsamp, T *out) {
+	if ( reclen < 48 ) return false;
+
+	const struct fsdh_s *fsdh = reinterpret_cast<const struct fsdh_s*>(rec);
+	uint16_t year, day;
+	memcpy(&year, &fsdh->start_time.year, 2);
+	memcpy(&day, &fsdh->start_time.day, 2);
+	bool hswap = !MS_ISVALIDYEARDAY(year, day);
+
+	int dataOffset = get16(rec + 44, hswap);
+	int blktOffset = get16(rec + 46, hswap);
+	int encoding = -1;
+	int byteorder = -1;
+
+	// Walk the blockette chain to find blockette 1000
+	for ( int i = 0; blktOffset >= 48 && blktOffset + 8 <= reclen && i < 256; ++i ) {
+		int type = get16(rec + blktOffset, hswap);
+		int next = get16(rec + blktOffset + 2, hswap);
+		if ( type == 1000 ) {
+			encoding = (uint8_t)rec[blktOffset+4];
+			byteorder = (uint8_t)rec[blktOffset+5];
+			break;
+		}
+
+		if ( next <= blktOffset ) break;
+		blktOffset = next;
+	}
+
+	if ( byteorder < 0 || dataOffset < 48 || dataOffset >= reclen )
+		return false;
+
+	bool dswap = (byteorder > 0) != (ms_bigendianhost() != 0);
+	const char *data = rec + dataOffset;
+	int nbytes = reclen - dataOffset;
+	int nd;
+
+	switch ( encoding ) {
+		case DE_STEIM1:
+			nd = Steim::decode(1, data, nbytes, nsamp, dswap, out);
+			break;
+		case DE_STEIM2:
+			nd = Steim::decode(2, data, nbytes, nsamp, dswap, out);
+			break;
+		case DE_INT16:
+			nd = unpackInt(2, data, nbytes, nsamp, dswap, out);
+			break;
+		case DE_INT32:
+			nd = unpackInt(4, data, nbytes, nsamp, dswap, out);
+			break;
+		default:
+			return false;
+	}
+
+	if ( nd < 0 )
+		throw LibmseedException("Invalid Steim compression flag.");
+
+	if ( nd != nsamp )
+		throw LibmseedException("The number of the unpacked data samples differs from the sample number in fixed data header.");
+
+	return true;
+}
+
+
+template <typename T>
+bool unpackDirect(const char *rec, int reclen, int nsamp, TypedArray<T> &target) {
+	target.resize(nsamp);
+	if ( nsamp == 0 ) return true;
+	return unpackDirect(rec, reclen, nsamp, target.typedData());
+}
+
+
+bool unpackDirect(const char *rec, int reclen, int nsamp, Array &target) {
+	switch ( target.dataType() ) {
+		case Array::INT:
+			return unpackDirect(rec, reclen, nsamp, static_cast<IntArray&>(target));
+		case Array::FLOAT:
+			return unpackDirect(rec, reclen, nsamp, static_cast<FloatArray&>(target));
+		case Array::DOUBLE:
+			return unpackDirect(rec, reclen, nsamp, static_cast<DoubleArray&>(target));
+		default:
+			break;
+	}
+
+	return false;
+}
+
+
+Array *createArray(Array::DataType dt) {
+	switch ( dt ) {
+		case Array::INT:
+			return new IntArray;
+		case Array::FLOAT:
+			return new FloatArray;
+		case Array::DOUBLE:
+			return new DoubleArray;
+		default:
+			break;
+	}
+
+	return NULL;
+}
+
+
+}
+
+
 IMPLEMENT_SC_CLASS_DERIVED(MSeedRecord, Record, "MSeedRecord");
 REGISTER_RECORD(MSeedRecord, "mseed");
 
@@ -311,9 +461,23 @@ const Array* MSeedRecord::data() const throw(LibmseedException) {
     return _data.get();
 }
 
+bool MSeedRecord::decode(Array &target) const throw(LibmseedException) {
+	if ( !_raw.data() || _nsamp < 0 ) return false;
+	return unpackDirect(_raw.typedData(), _raw.size(), _nsamp, target);
+}
+
 void MSeedRecord::_setDataAttributes(int reclen, char *data) const throw(LibmseedException) {
 	MSRecord *pmsr = NULL;
 
+	if (data && _nsamp >= 0) {
+		// Try to unpack the samples directly into the final array first
+		ArrayPtr ar = createArray(_datatype);
+		if ( ar && unpackDirect(data, reclen, _nsamp, *ar) ) {
+			_data = ar;
+			return;
+		}
+	}
+
 	if (data) {
 		if (msr_unpack(data,reclen,&pmsr,1,0) == MS_NOERROR) {
 			if (pmsr->numsamples == _nsamp) {
@@ -130,6 +130,16 @@ public:
 
 	const Array* raw() const;
 
+	//! Decodes the data samples into the given array which is resized to
+	//! the number of samples. Steim1, Steim2, INT16 and INT32 records are
+	//! unpacked directly into the array without an intermediate libmseed
+	//! record and sample buffer. Passing the same array for consecutive
+	//! records reuses its storage.
+	//! Returns false if the raw record is not available or its encoding or
+	//! the array type are not supported by the direct decoder. In that case
+	//! data() has to be used.
+	bool decode(Array &target) const throw(LibmseedException);
+
 	//! Frees the memory occupied by the decoded data samples.
 	//! ! Use it with the hint SAVE_RAW only otherwise the data samples cannot be redecoded!
 	void saveSpace() const;
@@ -0,0 +1,253 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+// Compares the direct MiniSEED decoder of MSeedRecord with msr_unpack for
+// every available Steim kernel and int, float and double output and
+// measures both.
+// Usage: testmseedrecord [records] [repeats]
+
+
+#include <seiscomp3/io/records/mseedrecord.h>
+#include <seiscomp3/io/records/steim.h>
+#include <seiscomp3/core/arrayfactory.h>
+#include <seiscomp3/core/typedarray.h>
+
+#include <libmseed.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/time.h>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::IO;
+
+
+namespace {
+
+
+typedef vector< vector<char> > RawRecords;
+
+
+void collect(char *record, int reclen, void *records) {
+	static_cast<RawRecords*>(records)->push_back(vector<char>(record, record + reclen));
+}
+
+
+double now() {
+	timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1E-6;
+}
+
+
+bool pack(RawRecords &records, vector<int32_t> &samples,
+          int encoding, int byteorder) {
+	MSRecord *msr = msr_init(NULL);
+	strcpy(msr->network, "XX");
+	strcpy(msr->station, "TEST");
+	strcpy(msr->channel, "BHZ");
+	msr->starttime = ms_time2hptime(2015, 1, 0, 0, 0, 0);
+	msr->samprate = 100;
+	msr->reclen = 512;
+	msr->encoding = encoding;
+	msr->byteorder = byteorder;
+	msr->datasamples = &samples[0];
+	msr->numsamples = samples.size();
+	msr->sampletype = 'i';
+
+	int64_t packed;
+	int res = msr_pack(msr, collect, &records, &packed, 1, 0);
+
+	msr->datasamples = NULL;
+	msr_free(&msr);
+
+	return res > 0;
+}
+
+
+// Returns false if the samples of one record differ. The expected samples
+// are converted from the msr_unpack output like the libmseed fallback of
+// MSeedRecord does.
+bool check(const RawRecords &records, Array::DataType dt) {
+	for ( size_t i = 0; i < records.size(); ++i ) {
+		MSRecord *msr = NULL;
+		if ( msr_unpack(const_cast<char*>(&records[i][0]), records[i].size(),
+		                &msr, 1, 0) != MS_NOERROR )
+			return false;
+
+		ArrayPtr expected = ArrayFactory::Create(dt, Array::INT, msr->numsamples,
+		                                         msr->datasamples);
+		MSeedRecord rec(msr, dt, Record::SAVE_RAW);
+		msr_free(&msr);
+
+		ArrayPtr direct = ArrayFactory::Create(dt, dt, 0, NULL);
+		if ( !rec.decode(*direct) ) return false;
+
+		// data() also takes the direct path
+		const Array *data = rec.data();
+
+		size_t bytes = expected->size() * expected->bytes();
+		if ( direct->size() != expected->size() ||
+		     memcmp(direct->data(), expected->data(), bytes) != 0 ||
+		     data == NULL || data->dataType() != dt ||
+		     data->size() != expected->size() ||
+		     memcmp(data->data(), expected->data(), bytes) != 0 )
+			return false;
+	}
+
+	return true;
+}
+
+
+// Returns the time per record in microseconds of the libmseed and the
+// direct path
+void measure(const RawRecords &records, int repeats,
+             double &libmseed, double &direct) {
+	vector<MSeedRecord*> recs;
+	for ( size_t i = 0; i < records.size(); ++i ) {
+		MSRecord *msr = NULL;
+		msr_unpack(const_cast<char*>(&records[i][0]), records[i].size(),
+		           &msr, 0, 0);
+		recs.push_back(new MSeedRecord(msr, Array::INT, Record::SAVE_RAW));
+		msr_free(&msr);
+	}
+
+	double start = now();
+	for ( int r = 0; r < repeats; ++r ) {
+		for ( size_t i = 0; i < records.size(); ++i ) {
+			MSRecord *msr = NULL;
+			msr_unpack(const_cast<char*>(&records[i][0]), records[i].size(),
+			           &msr, 1, 0);
+			ArrayPtr ar = ArrayFactory::Create(Array::INT, Array::INT,
+			                                   msr->numsamples, msr->datasamples);
+			msr_free(&msr);
+		}
+	}
+	libmseed = (now() - start) * 1E6 / (records.size() * repeats);
+
+	IntArray ar;
+	start = now();
+	for ( int r = 0; r < repeats; ++r ) {
+		for ( size_t i = 0; i < recs.size(); ++i )
+			recs[i]->decode(ar);
+	}
+	direct = (now() - start) * 1E6 / (records.size() * repeats);
+
+	for ( size_t i = 0; i < recs.size(); ++i )
+		delete recs[i];
+}
+
+
+}
+
+
+int main(int argc, char **argv) {
+	int numRecords = argc > 1 ? atoi(argv[1]) : 1000;
+	int repeats = argc > 2 ? atoi(argv[2]) : 20;
+
+	struct {
+		int         encoding;
+		const char *name;
+		int         range;
+	} encodings[] = {
+		{ DE_STEIM1, "Steim1", 8 },
+		{ DE_STEIM1, "Steim1", 200 },
+		{ DE_STEIM1, "Steim1", 1 << 20 },
+		{ DE_STEIM2, "Steim2", 8 },
+		{ DE_STEIM2, "Steim2", 200 },
+		{ DE_STEIM2, "Steim2", 1 << 20 },
+		{ DE_INT16, "INT16", 200 },
+		{ DE_INT32, "INT32", 1 << 20 }
+	};
+
+	struct {
+		Array::DataType  type;
+		const char      *name;
+	} types[] = {
+		{ Array::INT, "int" },
+		{ Array::FLOAT, "float" },
+		{ Array::DOUBLE, "double" }
+	};
+
+	const char *kernels[] = { "scalar", "sse2", "avx2" };
+
+	printf("Steim kernels:");
+	for ( size_t k = 0; k < sizeof(kernels)/sizeof(kernels[0]); ++k ) {
+		if ( Steim::setKernel(kernels[k]) ) printf(" %s", kernels[k]);
+	}
+	Steim::setKernel(NULL);
+	printf(", default %s\n", Steim::kernel());
+
+	int errors = 0;
+
+	for ( size_t e = 0; e < sizeof(encodings)/sizeof(encodings[0]); ++e ) {
+		// Random walk, the sample count is chosen to fill about numRecords
+		// Steim records
+		vector<int32_t> samples(numRecords * 200);
+		int32_t v = 0;
+		for ( size_t i = 0; i < samples.size(); ++i ) {
+			v += rand() % (2*encodings[e].range) - encodings[e].range;
+			if ( encodings[e].encoding == DE_INT16 && (v > 32767 || v < -32768) )
+				v = 0;
+			samples[i] = v;
+		}
+
+		for ( int byteorder = 0; byteorder < 2; ++byteorder ) {
+			RawRecords records;
+			if ( !pack(records, samples, encodings[e].encoding, byteorder) ) {
+				fprintf(stderr, "%s, range %d: packing failed\n",
+				        encodings[e].name, encodings[e].range);
+				++errors;
+				continue;
+			}
+
+			// Every available Steim kernel is checked with every output
+			// type
+			bool ok = true;
+			for ( size_t k = 0; k < sizeof(kernels)/sizeof(kernels[0]); ++k ) {
+				if ( !Steim::setKernel(kernels[k]) ) continue;
+
+				for ( size_t t = 0; t < sizeof(types)/sizeof(types[0]); ++t ) {
+					if ( !check(records, types[t].type) ) {
+						fprintf(stderr, "%s, range %d, %s endian, %s kernel, %s: "
+						        "samples differ\n", encodings[e].name,
+						        encodings[e].range, byteorder ? "big" : "little",
+						        kernels[k], types[t].name);
+						ok = false;
+					}
+				}
+			}
+
+			Steim::setKernel(NULL);
+
+			if ( !ok ) {
+				++errors;
+				continue;
+			}
+
+			double libmseed, direct;
+			measure(records, repeats, libmseed, direct);
+			printf("%-6s %7d %-6s %6d records: msr_unpack %.2f us/record, "
+			       "direct %.2f us/record\n",
+			       encodings[e].name, encodings[e].range,
+			       byteorder ? "big" : "little",
+			       (int)records.size(), libmseed, direct);
+		}
+	}
+
+	return errors ? 1 : 0;
+}
@@ -249,10 +249,16 @@ void SACRecord::read(std::istream &in) throw(Core::StreamException) {
 
 	setStartTime(reftime + Core::TimeSpan(header.b));
 
-	copy_buf(_net, 8, header.knetwk);
-	copy_buf(_sta, 8, header.kstnm);
-	copy_buf(_loc, 8, header.khole);
-	copy_buf(_cha, 8, header.kcmpnm);
+	// The setters also reset the cached stream id
+	std::string code;
+	copy_buf(code, 8, header.knetwk);
+	setNetworkCode(code);
+	copy_buf(code, 8, header.kstnm);
+	setStationCode(code);
+	copy_buf(code, 8, header.khole);
+	setLocationCode(code);
+	copy_buf(code, 8, header.kcmpnm);
+	setChannelCode(code);
 
 	_fsamp = 1.0 / header.delta;
 
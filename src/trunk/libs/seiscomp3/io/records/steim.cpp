@@ -0,0 +1,365 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#include <seiscomp3/io/records/steim.h>
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#define STEIM_SSE2
+#include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && (__GNUC__ >= 5)
+#define STEIM_AVX2
+#include <immintrin.h>
+#endif
+
+
+namespace Seiscomp {
+namespace IO {
+namespace Steim {
+
+
+namespace {
+
+
+// Maximum number of differences in a single frame: 15 words with
+// 7 differences each
+const int MAX_FRAME_DIFFS = 15*7;
+
+
+inline int32_t load32(const char *p, bool swap) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	if ( swap )
+		v = (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+	return (int32_t)v;
+}
+
+
+inline int16_t load16(const char *p, bool swap) {
+	uint16_t v;
+	memcpy(&v, p, 2);
+	if ( swap )
+		v = (uint16_t)((v >> 8) | (v << 8));
+	return (int16_t)v;
+}
+
+
+inline int32_t signExtend(uint32_t v, int bits) {
+	uint32_t m = 1u << (bits-1);
+	v &= (1u << bits) - 1;
+	return (int32_t)(v ^ m) - (int32_t)m;
+}
+
+
+// Unpacks n differences of width bits from a Steim2 word
+inline int unpackBits(uint32_t val, int n, int bits, int32_t *diffs) {
+	for ( int i = 0; i < n; ++i )
+		diffs[i] = signExtend(val >> ((n-1-i)*bits), bits);
+	return n;
+}
+
+
+/*
+ * Unpacks all differences of a single frame into diffs which needs room
+ * for MAX_FRAME_DIFFS values. Returns the number of differences or -1 if
+ * an invalid compression flag was found.
+ */
+int unpackFrame(int level, const char *frame, bool swap, int32_t *diffs) {
+	uint32_t ctrl = (uint32_t)load32(frame, swap);
+	int n = 0;
+
+	for ( int wn = 1; wn < 16; ++wn ) {
+		const char *word = frame + wn*4;
+
+		switch ( (ctrl >> (30-wn*2)) & 0x3 ) {
+			case 0:
+				// Header info or integration constants
+				break;
+			case 1:
+				// 4 1-byte differences
+				diffs[n++] = (int8_t)word[0];
+				diffs[n++] = (int8_t)word[1];
+				diffs[n++] = (int8_t)word[2];
+				diffs[n++] = (int8_t)word[3];
+				break;
+			case 2:
+				if ( level == 1 ) {
+					// 2 2-byte differences
+					diffs[n++] = load16(word, swap);
+					diffs[n++] = load16(word+2, swap);
+				}
+				else {
+					uint32_t val = (uint32_t)load32(word, swap);
+					switch ( val >> 30 ) {
+						case 1: n += unpackBits(val, 1, 30, diffs+n); break;
+						case 2: n += unpackBits(val, 2, 15, diffs+n); break;
+						case 3: n += unpackBits(val, 3, 10, diffs+n); break;
+						default: return -1;
+					}
+				}
+				break;
+			case 3:
+				if ( level == 1 ) {
+					// 1 4-byte difference
+					diffs[n++] = load32(word, swap);
+				}
+				else {
+					uint32_t val = (uint32_t)load32(word, swap);
+					switch ( val >> 30 ) {
+						case 0: n += unpackBits(val, 5, 6, diffs+n); break;
+						case 1: n += unpackBits(val, 6, 5, diffs+n); break;
+						case 2: n += unpackBits(val, 7, 4, diffs+n); break;
+						default: return -1;
+					}
+				}
+				break;
+		}
+	}
+
+	return n;
+}
+
+
+// Integrates n differences starting at *last and writes the samples to out.
+// Additions wrap around as in the encoder.
+template <typename T>
+void integrateScalar(const int32_t *diffs, int n, int32_t *last, T *out) {
+	uint32_t v = (uint32_t)*last;
+	for ( int i = 0; i < n; ++i ) {
+		v += (uint32_t)diffs[i];
+		out[i] = static_cast<T>((int32_t)v);
+	}
+	*last = (int32_t)v;
+}
+
+
+#ifdef STEIM_SSE2
+
+inline void store4(int32_t *out, __m128i v) {
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+}
+
+inline void store4(float *out, __m128i v) {
+	_mm_storeu_ps(out, _mm_cvtepi32_ps(v));
+}
+
+inline void store4(double *out, __m128i v) {
+	_mm_storeu_pd(out, _mm_cvtepi32_pd(v));
+	_mm_storeu_pd(out+2, _mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0xEE)));
+}
+
+
+template <typename T>
+void integrateSSE2(const int32_t *diffs, int n, int32_t *last, T *out) {
+	__m128i carry = _mm_set1_epi32(*last);
+	int i = 0;
+
+	for ( ; i+4 <= n; i += 4 ) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(diffs+i));
+		// Prefix sum inside the vector
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi32(x, carry);
+		store4(out+i, x);
+		carry = _mm_shuffle_epi32(x, 0xFF);
+	}
+
+	*last = _mm_cvtsi128_si32(carry);
+	integrateScalar(diffs+i, n-i, last, out+i);
+}
+
+#endif
+
+
+#ifdef STEIM_AVX2
+
+__attribute__((target("avx2")))
+inline void store8(int32_t *out, __m256i v) {
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+}
+
+__attribute__((target("avx2")))
+inline void store8(float *out, __m256i v) {
+	_mm256_storeu_ps(out, _mm256_cvtepi32_ps(v));
+}
+
+__attribute__((target("avx2")))
+inline void store8(double *out, __m256i v) {
+	_mm256_storeu_pd(out, _mm256_cvtepi32_pd(_mm256_castsi256_si128(v)));
+	_mm256_storeu_pd(out+4, _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)));
+}
+
+
+template <typename T>
+__attribute__((target("avx2")))
+void integrateAVX2(const int32_t *diffs, int n, int32_t *last, T *out) {
+	__m256i carry = _mm256_set1_epi32(*last);
+	__m256i top = _mm256_set1_epi32(7);
+	int i = 0;
+
+	for ( ; i+8 <= n; i += 8 ) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(diffs+i));
+		// Prefix sum inside both 128 bit lanes
+		x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+		x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+		// Add the total of the low lane to the high lane
+		__m256i t = _mm256_shuffle_epi32(x, 0xFF);
+		x = _mm256_add_epi32(x, _mm256_permute2x128_si256(t, t, 0x08));
+		x = _mm256_add_epi32(x, carry);
+		store8(out+i, x);
+		carry = _mm256_permutevar8x32_epi32(x, top);
+	}
+
+	*last = _mm_cvtsi128_si32(_mm256_castsi256_si128(carry));
+	integrateScalar(diffs+i, n-i, last, out+i);
+}
+
+#endif
+
+
+struct Kernels {
+	void (*toInt)(const int32_t*, int, int32_t*, int32_t*);
+	void (*toFloat)(const int32_t*, int, int32_t*, float*);
+	void (*toDouble)(const int32_t*, int, int32_t*, double*);
+	const char *name;
+};
+
+
+// Fills k with the named kernel if it has been compiled in and the CPU
+// supports it
+bool makeKernels(const char *name, Kernels &k) {
+	if ( !strcmp(name, "scalar") ) {
+		k.toInt = integrateScalar<int32_t>;
+		k.toFloat = integrateScalar<float>;
+		k.toDouble = integrateScalar<double>;
+		k.name = "scalar";
+		return true;
+	}
+
+#ifdef STEIM_SSE2
+	if ( !strcmp(name, "sse2") ) {
+		k.toInt = integrateSSE2<int32_t>;
+		k.toFloat = integrateSSE2<float>;
+		k.toDouble = integrateSSE2<double>;
+		k.name = "sse2";
+		return true;
+	}
+#endif
+
+#ifdef STEIM_AVX2
+	if ( !strcmp(name, "avx2") ) {
+		__builtin_cpu_init();
+		if ( !__builtin_cpu_supports("avx2") ) return false;
+		k.toInt = integrateAVX2<int32_t>;
+		k.toFloat = integrateAVX2<float>;
+		k.toDouble = integrateAVX2<double>;
+		k.name = "avx2";
+		return true;
+	}
+#endif
+
+	return false;
+}
+
+
+Kernels selectKernels() {
+	Kernels k;
+	if ( !makeKernels("avx2", k) && !makeKernels("sse2", k) )
+		makeKernels("scalar", k);
+	return k;
+}
+
+
+Kernels &kernels() {
+	static Kernels k = selectKernels();
+	return k;
+}
+
+
+template <typename T>
+int decodeFrames(int level, const char *frames, int nbytes, int nsamp,
+                 bool swap, T *out, int32_t *xn,
+                 void (*integrate)(const int32_t*, int, int32_t*, T*)) {
+	if ( nsamp <= 0 || nbytes < 64 ) return 0;
+
+	int nframes = nbytes / 64;
+	int32_t diffs[MAX_FRAME_DIFFS];
+	int32_t last = 0;
+	int nd = 0;
+
+	// Word 1 and 2 of the first frame are the integration constants
+	if ( xn ) *xn = load32(frames + 8, swap);
+
+	for ( int fn = 0; fn < nframes && nd < nsamp; ++fn ) {
+		int n = unpackFrame(level, frames + fn*64, swap, diffs);
+		if ( n < 0 ) return -1;
+		if ( n == 0 ) continue;
+		if ( n > nsamp - nd ) n = nsamp - nd;
+
+		// The first difference refers to the previous record, the first
+		// sample is given by the forward integration constant X0.
+		if ( nd == 0 ) diffs[0] = load32(frames + 4, swap);
+
+		integrate(diffs, n, &last, out + nd);
+		nd += n;
+	}
+
+	return nd;
+}
+
+
+}
+
+
+int decode(int level, const char *frames, int nbytes, int nsamp,
+           bool swap, int32_t *out, int32_t *xn) {
+	return decodeFrames(level, frames, nbytes, nsamp, swap, out, xn, kernels().toInt);
+}
+
+
+int decode(int level, const char *frames, int nbytes, int nsamp,
+           bool swap, float *out, int32_t *xn) {
+	return decodeFrames(level, frames, nbytes, nsamp, swap, out, xn, kernels().toFloat);
+}
+
+
+int decode(int level, const char *frames, int nbytes, int nsamp,
+           bool swap, double *out, int32_t *xn) {
+	return decodeFrames(level, frames, nbytes, nsamp, swap, out, xn, kernels().toDouble);
+}
+
+
+const char *kernel() {
+	return kernels().name;
+}
+
+
+bool setKernel(const char *name) {
+	if ( name == NULL ) {
+		kernels() = selectKernels();
+		return true;
+	}
+
+	Kernels k;
+	if ( !makeKernels(name, k) ) return false;
+	kernels() = k;
+	return true;
+}
+
+
+}
+}
+}
@@ -0,0 +1,78 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+#ifndef __SEISCOMP_IO_RECORDS_STEIM_H__
+#define __SEISCOMP_IO_RECORDS_STEIM_H__
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <seiscomp3/core.h>
+
+
+namespace Seiscomp {
+namespace IO {
+namespace Steim {
+
+
+/**
+ * Steim1 and Steim2 frame decoder.
+ *
+ * The frames are decoded frame by frame: the differences of a frame are
+ * unpacked into a small stack buffer and then integrated and converted
+ * into the output with SSE2 or AVX2 kernels. The kernel is selected at
+ * runtime according to the CPU features, a scalar implementation is used
+ * on all other platforms.
+ *
+ * The decoder does not depend on libmseed and only needs the raw data
+ * frames, e.g. the part of a MiniSEED record behind the data offset.
+ *
+ * @param level The Steim compression level, 1 or 2
+ * @param frames Pointer to the first 64 byte data frame
+ * @param nbytes Number of bytes available for the data frames
+ * @param nsamp Number of samples to decode
+ * @param swap Whether the frames need to be byte swapped to host order
+ * @param out Output buffer with room for nsamp samples
+ * @param xn Optional pointer that receives the reverse integration
+ *           constant of the frames to check the decoded data
+ * @return The number of decoded samples or -1 if the frames contain
+ *         an invalid compression flag
+ */
+SC_SYSTEM_CORE_API int decode(int level, const char *frames, int nbytes,
+                              int nsamp, bool swap, int32_t *out,
+                              int32_t *xn = NULL);
+SC_SYSTEM_CORE_API int decode(int level, const char *frames, int nbytes,
+                              int nsamp, bool swap, float *out,
+                              int32_t *xn = NULL);
+SC_SYSTEM_CORE_API int decode(int level, const char *frames, int nbytes,
+                              int nsamp, bool swap, double *out,
+                              int32_t *xn = NULL);
+
+//! Returns the name of the kernel selected for this CPU:
+//! "avx2", "sse2" or "scalar"
+SC_SYSTEM_CORE_API const char *kernel();
+
+//! Forces the kernel to use: "avx2", "sse2" or "scalar". NULL restores
+//! the selection according to the CPU features. Returns false if the
+//! kernel has not been compiled in or is not supported by the CPU.
+//! This is meant for tests and must not be called while other threads
+//! decode.
+SC_SYSTEM_CORE_API bool setKernel(const char *name);
+
+
+}
+}
+}
+
+
+#endif
@@ -14,9 +14,19 @@
 #define SEISCOMP_COMPONENT SDSARCHIVE
 
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <errno.h>
 #include <iomanip>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <boost/bind.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
 #include <seiscomp3/io/recordstream/sdsarchive.h>
+#include <seiscomp3/core/strings.h>
 #include <seiscomp3/logging/log.h>
 #include <libmseed.h>
 
@@ -34,26 +44,416 @@ IMPLEMENT_SC_CLASS_DERIVED(SDSArchive,
 REGISTER_RECORDSTREAM(SDSArchive, "sdsarchive");
 
 
-SDSArchive::SDSArchive() : RecordStream() {}
+namespace {
+
+
+// Read-only view on a memory region that does not copy the data
+class MappedBuffer : public std::streambuf {
+	public:
+		void setView(char *begin, char *end) {
+			setg(begin, begin, end);
+		}
+
+	protected:
+		// Record readers use tellg/seekg to scan for headers
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+		                 std::ios_base::openmode) {
+			char *p;
+
+			if ( dir == std::ios_base::beg )
+				p = eback() + off;
+			else if ( dir == std::ios_base::cur )
+				p = gptr() + off;
+			else
+				p = egptr() + off;
+
+			if ( p < eback() || p > egptr() )
+				return pos_type(off_type(-1));
+
+			setg(eback(), p, egptr());
+			return pos_type(off_type(p - eback()));
+		}
+
+		pos_type seekpos(pos_type pos, std::ios_base::openmode which) {
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+};
+
+
+// Maximum size of the pieces a stream is read in if the records are
+// merged by time. Together with the piece that is merged and the one that
+// is prefetched this bounds the memory to about two pieces per stream.
+const size_t MaxChunkSize = 128*1024;
+
+
+// Records of one requested stream read by a prefetch worker: the whole
+// stream or a piece of it if the records are merged by time
+struct Chunk {
+	struct Rec {
+		Rec(hptime_t t, size_t j, size_t o, size_t l)
+		: time(t), job(j), offset(o), length(l) {}
+
+		bool operator<(const Rec &other) const {
+			if ( time != other.time ) return time < other.time;
+			if ( job != other.job ) return job < other.job;
+			return offset < other.offset;
+		}
+
+		hptime_t time;
+		size_t   job;
+		size_t   offset;
+		size_t   length;
+	};
+
+	Chunk(size_t j) : job(j), last(true) {}
+
+	size_t            job;
+	bool              last;
+	std::vector<char> data;
+	std::vector<Rec>  records;
+};
+
+
+// Reads the records of a single stream from the archive into a chunk.
+// If maxBytes is not 0 reading stops after the record that reaches it;
+// the next call continues there. Returns false if the stream has ended.
+bool readChunk(SDSArchive &arc, Chunk *chunk, size_t maxBytes = 0) {
+	const int LEN = 64;
+	char header[LEN];
+	MSRecord *prec = NULL;
+
+	try {
+		while ( true ) {
+			istream &is = arc.stream();
+			if ( !is.good() ) break;
+
+			if ( !is.read(header, LEN) ) continue;
+			/* ignore nondata records and scan to the next valid header */
+			if ( !MS_ISVALIDHEADER(header) ) continue;
+
+			int reclen = ms_detect(header, LEN);
+			if ( reclen < LEN || reclen > MAXRECLEN ) {
+				SEISCOMP_WARNING("sdsarchive: unable to detect record length, skip rest of stream");
+				break;
+			}
+
+			size_t offset = chunk->data.size();
+			chunk->data.resize(offset + reclen);
+			memcpy(&chunk->data[offset], header, LEN);
+
+			if ( !is.read(&chunk->data[offset+LEN], reclen-LEN) ||
+			     msr_unpack(&chunk->data[offset], reclen, &prec, 0, 0) != MS_NOERROR ) {
+				chunk->data.resize(offset);
+				continue;
+			}
+
+			chunk->records.push_back(Chunk::Rec(prec->starttime, chunk->job, offset, reclen));
+
+			if ( maxBytes > 0 && chunk->data.size() >= maxBytes ) {
+				msr_free(&prec);
+				return true;
+			}
+		}
+	}
+	catch ( ArchiveException & ) {
+		// No data for this stream
+	}
+
+	msr_free(&prec);
+	return false;
+}
+
+
+}
+
+
+struct SDSArchive::Prefetch {
+	typedef std::pair<hptime_t, size_t> HeapEntry;
+
+	Prefetch() : nextJob(0), running(0), capacity(1), aborted(false), openStreams(0),
+	             current(NULL), exhausted(-1), started(false), delivered(false) {}
+
+	~Prefetch() {
+		delete current;
+		for ( size_t i = 0; i < chunks.size(); ++i )
+			delete chunks[i];
+		for ( size_t i = 0; i < readers.size(); ++i )
+			delete readers[i];
+		for ( size_t i = 0; i < merging.size(); ++i )
+			delete merging[i];
+		for ( size_t i = 0; i < pending.size(); ++i )
+			delete pending[i];
+	}
+
+	// Blocks until a chunk is available. Returns NULL if all workers
+	// have finished and the queue is drained.
+	Chunk *pop() {
+		boost::mutex::scoped_lock lk(mutex);
+		while ( chunks.empty() && running > 0 )
+			notEmpty.wait(lk);
+
+		if ( chunks.empty() ) return NULL;
+
+		Chunk *chunk = chunks.front();
+		chunks.pop_front();
+		notFull.notify_one();
+		return chunk;
+	}
+
+	// Waits for room in the queue and appends the chunk. Returns false
+	// and deletes the chunk if the prefetch has been aborted.
+	bool push(boost::mutex::scoped_lock &lk, Chunk *chunk) {
+		while ( chunks.size() >= capacity && !aborted )
+			notFull.wait(lk);
+
+		if ( aborted ) {
+			delete chunk;
+			return false;
+		}
+
+		chunks.push_back(chunk);
+		notEmpty.notify_one();
+		return true;
+	}
+
+	void work(const string &source, const Time &stime, const Time &etime) {
+		while ( true ) {
+			size_t job;
+
+			{
+				boost::mutex::scoped_lock lk(mutex);
+				if ( aborted || nextJob >= jobs.size() ) break;
+				job = nextJob++;
+			}
+
+			const StreamIdx &idx = jobs[job];
+			Chunk *chunk = new Chunk(job);
+
+			try {
+				SDSArchive arc;
+				arc.setSource(source);
+				arc.setStartTime(stime);
+				arc.setEndTime(etime);
+				arc.addStream(idx.network(), idx.station(), idx.location(), idx.channel(),
+				              idx.startTime(), idx.endTime());
+				readChunk(arc, chunk);
+			}
+			catch ( std::exception &e ) {
+				SEISCOMP_ERROR("sdsarchive: %s: %s", idx.str(stime, etime).c_str(), e.what());
+			}
+
+			boost::mutex::scoped_lock lk(mutex);
+			if ( !push(lk, chunk) ) break;
+		}
+
+		boost::mutex::scoped_lock lk(mutex);
+		--running;
+		notEmpty.notify_all();
+	}
+
+	// Worker of the time ordered mode: reads the next piece of the
+	// streams requested by the consumer
+	void workOrdered(const Time &stime, const Time &etime) {
+		while ( true ) {
+			size_t job;
+
+			{
+				boost::mutex::scoped_lock lk(mutex);
+				while ( requests.empty() && openStreams > 0 && !aborted )
+					hasRequest.wait(lk);
+
+				if ( aborted || requests.empty() ) break;
+				job = requests.front();
+				requests.pop_front();
+			}
+
+			Chunk *chunk = new Chunk(job);
+
+			try {
+				chunk->last = !readChunk(*readers[job], chunk, MaxChunkSize);
+			}
+			catch ( std::exception &e ) {
+				SEISCOMP_ERROR("sdsarchive: %s: %s", jobs[job].str(stime, etime).c_str(), e.what());
+				chunk->last = true;
+			}
+
+			// Records of a stream are merged in file order
+			std::sort(chunk->records.begin(), chunk->records.end());
+
+			boost::mutex::scoped_lock lk(mutex);
+			if ( chunk->last && --openStreams == 0 )
+				hasRequest.notify_all();
+
+			if ( !push(lk, chunk) ) break;
+		}
+
+		boost::mutex::scoped_lock lk(mutex);
+		--running;
+		notEmpty.notify_all();
+	}
+
+	// Asks the workers for the next piece of a stream
+	void request(size_t job) {
+		boost::mutex::scoped_lock lk(mutex);
+		requests.push_back(job);
+		hasRequest.notify_one();
+	}
+
+	// Replaces the merged chunk of a stream by its next piece that
+	// contains records and adds the stream to the heap. At most one piece
+	// per stream is requested or pending at a time, so the chunks of other
+	// streams that are popped while waiting can always be stored.
+	void advance(size_t job) {
+		while ( true ) {
+			bool last = merging[job] == NULL || merging[job]->last;
+			if ( merging[job] != NULL && last ) {
+				delete merging[job];
+				merging[job] = NULL;
+				return;
+			}
+
+			delete merging[job];
+			merging[job] = NULL;
+
+			while ( pending[job] == NULL ) {
+				Chunk *chunk = pop();
+				if ( chunk == NULL ) return;
+				pending[chunk->job] = chunk;
+			}
+
+			Chunk *chunk = pending[job];
+			pending[job] = NULL;
+			merging[job] = chunk;
+			positions[job] = 0;
+
+			// Prefetch the following piece while this one is merged
+			if ( !chunk->last ) request(job);
+
+			if ( !chunk->records.empty() ) {
+				heap.push(HeapEntry(chunk->records[0].time, job));
+				return;
+			}
+		}
+	}
+
+	std::vector<StreamIdx>  jobs;
+	size_t                  nextJob;
+	int                     running;
+	size_t                  capacity;
+	bool                    aborted;
+	std::deque<Chunk*>      chunks;
+	boost::mutex            mutex;
+	boost::condition        notFull, notEmpty;
+	boost::thread_group     workers;
+
+	// Time ordered mode: one reader per stream, the streams whose next
+	// piece has been requested and the number of streams not read
+	// completely
+	std::vector<SDSArchive*> readers;
+	std::deque<size_t>       requests;
+	boost::condition         hasRequest;
+	size_t                   openStreams;
+
+	// Consumer side
+	Chunk                  *current;
+	std::vector<Chunk*>     merging;
+	std::vector<Chunk*>     pending;
+	std::vector<size_t>     positions;
+	std::priority_queue<HeapEntry, std::vector<HeapEntry>,
+	                    std::greater<HeapEntry> > heap;
+	int                     exhausted;
+	bool                    started;
+	bool                    delivered;
+};
+
+
+SDSArchive::SDSArchive()
+: RecordStream(), _useMMap(false), _mapStarted(false), _mapFound(false)
+, _mapData(NULL), _mapSize(0), _mapRecLen(0)
+, _mapBuffer(new MappedBuffer), _mapStream(_mapBuffer)
+, _threads(1), _timeOrdered(false), _prefetch(NULL) {}
 
 SDSArchive::SDSArchive(const string arcroot) 
-: RecordStream(), _arcroot(arcroot) {}
+: RecordStream(), _useMMap(false), _mapStarted(false), _mapFound(false)
+, _mapData(NULL), _mapSize(0), _mapRecLen(0)
+, _mapBuffer(new MappedBuffer), _mapStream(_mapBuffer)
+, _threads(1), _timeOrdered(false), _prefetch(NULL) {
+	setSource(arcroot);
+}
 
-SDSArchive::SDSArchive(const SDSArchive &mem) : RecordStream() {
+SDSArchive::SDSArchive(const SDSArchive &mem)
+: RecordStream(), _useMMap(false), _mapStarted(false), _mapFound(false)
+, _mapData(NULL), _mapSize(0), _mapRecLen(0)
+, _mapBuffer(new MappedBuffer), _mapStream(_mapBuffer)
+, _threads(1), _timeOrdered(false), _prefetch(NULL) {
 	setSource(mem.archiveRoot());
+	_useMMap = mem._useMMap;
+	_threads = mem._threads;
+	_timeOrdered = mem._timeOrdered;
 }
 
-SDSArchive::~SDSArchive() {}
+SDSArchive::~SDSArchive() {
+	stopPrefetch();
+	unmapFile();
+	delete _mapBuffer;
+}
 
 SDSArchive& SDSArchive::operator=(const SDSArchive &mem) {
-	if (this != &mem)
+	if (this != &mem) {
 		_arcroot = mem.archiveRoot();
+		_useMMap = mem._useMMap;
+		_threads = mem._threads;
+		_timeOrdered = mem._timeOrdered;
+	}
 
 	return *this;
 }
 
 bool SDSArchive::setSource(string src) {
-	_arcroot = src;
+	size_t pos = src.find('?');
+	_useMMap = false;
+	_threads = 1;
+	_timeOrdered = false;
+
+	if ( pos != string::npos ) {
+		_arcroot = src.substr(0, pos);
+		string params = src.substr(pos+1);
+		vector<string> toks;
+		split(toks, params.c_str(), "&");
+		for ( vector<string>::iterator it = toks.begin(); it != toks.end(); ++it ) {
+			string name, value;
+
+			pos = it->find('=');
+			if ( pos != string::npos ) {
+				name = it->substr(0, pos);
+				value = it->substr(pos+1);
+			}
+			else
+				name = *it;
+
+			if ( name == "mmap" ) {
+				if ( value.empty() || !fromString(_useMMap, value) )
+					_useMMap = true;
+			}
+			else if ( name == "threads" ) {
+				if ( !fromString(_threads, value) || _threads < 1 ) {
+					SEISCOMP_ERROR("sdsarchive: invalid number of threads: %s", value.c_str());
+					return false;
+				}
+			}
+			else if ( name == "order" ) {
+				if ( value == "time" )
+					_timeOrdered = true;
+				else if ( value != "stream" ) {
+					SEISCOMP_ERROR("sdsarchive: invalid order: %s", value.c_str());
+					return false;
+				}
+			}
+		}
+	}
+	else
+		_arcroot = src;
+
 	return true;
 }
 
@@ -130,7 +530,10 @@ bool SDSArchive::setTimeout(int seconds) {
 	return false;
 }
 
-void SDSArchive::close() {}
+void SDSArchive::close() {
+	stopPrefetch();
+	unmapFile();
+}
 
 string SDSArchive::archiveRoot() const {
 	return _arcroot;
@@ -352,6 +755,12 @@ bool SDSArchive::isEnd() {
 }
 
 istream& SDSArchive::stream() throw(ArchiveException) {  
+	if ( _threads > 1 || _timeOrdered )
+		return parallelStream();
+
+	if ( _useMMap )
+		return mappedStream();
+
 	if ( _recstream ) {
 		/* eof check: try to read from stream */
 		istream &tmpstream = _recstream->stream();
@@ -417,3 +826,331 @@ istream& SDSArchive::stream() throw(ArchiveException) {
 
 	return _recstream->stream();
 }
+
+bool SDSArchive::mapFile(const string &fname) {
+	unmapFile();
+
+	int fd = ::open(fname.c_str(), O_RDONLY);
+	if ( fd < 0 )
+		return false;
+
+	struct stat st;
+	if ( fstat(fd, &st) != 0 || st.st_size <= 0 ) {
+		::close(fd);
+		return false;
+	}
+
+	void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping keeps its own reference to the file
+	::close(fd);
+
+	if ( data == MAP_FAILED ) {
+		SEISCOMP_WARNING("sdsarchive: unable to map %s: %s", fname.c_str(), strerror(errno));
+		return false;
+	}
+
+	_mapData = static_cast<char*>(data);
+	_mapSize = st.st_size;
+
+	// The binary search touches only a few pages
+	madvise(_mapData, _mapSize, MADV_RANDOM);
+
+	_mapRecLen = ms_detect(_mapData, _mapSize > MAXRECLEN ? MAXRECLEN : (int)_mapSize);
+	if ( _mapRecLen <= 0 ) {
+		SEISCOMP_WARNING("sdsarchive: [%s] no valid mseed record found", fname.c_str());
+		unmapFile();
+		return false;
+	}
+
+	return true;
+}
+
+void SDSArchive::unmapFile() {
+	static_cast<MappedBuffer*>(_mapBuffer)->setView(NULL, NULL);
+
+	if ( _mapData != NULL ) {
+		munmap(_mapData, _mapSize);
+		_mapData = NULL;
+	}
+
+	_mapSize = 0;
+	_mapRecLen = 0;
+}
+
+bool SDSArchive::findRange(const Time &stime, const Time &etime,
+                           size_t &from, size_t &to) {
+	// Records in a SDS day file are of fixed size and sorted by time so
+	// the record index itself serves as time -> offset lookup table.
+	long nrecs = (long)(_mapSize / _mapRecLen);
+	MSRecord *prec = NULL;
+	bool result = true;
+
+	hptime_t hpstime = (hptime_t)stime.seconds()*HPTMODULUS + stime.microseconds();
+	hptime_t hpetime = (hptime_t)etime.seconds()*HPTMODULUS + etime.microseconds();
+
+	// Lower bound: first record that ends after the requested start time
+	long start = 0, end = nrecs;
+	while ( start < end ) {
+		long half = start + (end - start)/2;
+		if ( msr_unpack(_mapData + half*_mapRecLen, _mapRecLen, &prec, 0, 0) != MS_NOERROR ) {
+			SEISCOMP_WARNING("sdsarchive: [@%ld] Couldn't read mseed header!", half*_mapRecLen);
+			start = 0;
+			result = false;
+			break;
+		}
+
+		hptime_t recetime = prec->starttime;
+		if ( prec->samprate > 0. )
+			recetime += (hptime_t)(prec->samplecnt / prec->samprate * HPTMODULUS);
+		else
+			recetime += HPTMODULUS;
+
+		if ( recetime <= hpstime )
+			start = half+1;
+		else
+			end = half;
+	}
+
+	from = start*_mapRecLen;
+
+	// Upper bound: first record that starts after the requested end time
+	end = nrecs;
+	while ( start < end ) {
+		long half = start + (end - start)/2;
+		if ( msr_unpack(_mapData + half*_mapRecLen, _mapRecLen, &prec, 0, 0) != MS_NOERROR ) {
+			SEISCOMP_WARNING("sdsarchive: [@%ld] Couldn't read mseed header!", half*_mapRecLen);
+			end = nrecs;
+			result = false;
+			break;
+		}
+
+		if ( prec->starttime > hpetime )
+			end = half;
+		else
+			start = half+1;
+	}
+
+	to = end < nrecs ? end*_mapRecLen : _mapSize;
+
+	msr_free(&prec);
+
+	return result;
+}
+
+istream &SDSArchive::mappedStream() {
+	if ( _mapStarted ) {
+		/* go on at the current mapping */
+		_mapStream.peek();
+		if ( _mapStream.good() )
+			return _mapStream;
+	}
+	else {
+		_curiter = _streams.begin();
+		_mapStarted = true;
+		_mapFound = false;
+	}
+
+	while ( !_fnames.empty() || _curiter != _streams.end() ) {
+		while ( _fnames.empty() && _curiter != _streams.end() ) {
+			SEISCOMP_DEBUG("SDS request: %s", _curiter->str(_stime, _etime).c_str());
+			if ( _etime == Time() )
+				_etime = Time::GMT();
+			if ( (_curiter->startTime() == Time() && _stime == Time()) ) {
+				SEISCOMP_WARNING("... has invalid time window -> ignore this request above");
+				++_curiter;
+			}
+			else {
+				_curidx = &*_curiter;
+				++_curiter;
+				setFilenames();
+				break;
+			}
+		}
+
+		if ( _fnames.empty() )
+			continue;
+
+		Time stime = (_curidx->startTime() == Time())?_stime:_curidx->startTime();
+		Time etime = (_curidx->endTime() == Time())?_etime:_curidx->endTime();
+
+		while ( !_fnames.empty() ) {
+			string fname = _fnames.front();
+			_fnames.pop();
+
+			if ( !mapFile(fname) ) {
+				SEISCOMP_DEBUG("file %s not found", fname.c_str());
+				continue;
+			}
+
+			_mapFound = true;
+
+			size_t from, to;
+			if ( !findRange(stime, etime, from, to) )
+				SEISCOMP_WARNING("Error reading file %s; time window maybe incorrect", fname.c_str());
+
+			if ( from >= to )
+				continue;
+
+			// Only the requested range is read from now on
+			madvise(_mapData + from, to - from, MADV_WILLNEED);
+			static_cast<MappedBuffer*>(_mapBuffer)->setView(_mapData + from, _mapData + to);
+			_mapStream.clear();
+			return _mapStream;
+		}
+	}
+
+	unmapFile();
+
+	if ( !_mapFound ) {
+		SEISCOMP_DEBUG("no data found in SDS archive");
+		throw ArchiveException("no data found in SDS archive");
+	}
+
+	_mapStream.clear(ios::eofbit);
+	return _mapStream;
+}
+
+void SDSArchive::startPrefetch() {
+	_prefetch = new Prefetch;
+
+	if ( _etime == Time() )
+		_etime = Time::GMT();
+
+	for ( set<StreamIdx>::const_iterator it = _streams.begin(); it != _streams.end(); ++it ) {
+		SEISCOMP_DEBUG("SDS request: %s", it->str(_stime, _etime).c_str());
+		if ( it->startTime() == Time() && _stime == Time() ) {
+			SEISCOMP_WARNING("... has invalid time window -> ignore this request above");
+			continue;
+		}
+
+		_prefetch->jobs.push_back(*it);
+	}
+
+	string source = _arcroot;
+	if ( _useMMap ) source += "?mmap";
+
+	int threads = std::min(_threads, (int)_prefetch->jobs.size());
+	// Allow each worker to have one finished stream or piece pending
+	_prefetch->capacity = std::max(threads, 1);
+	_prefetch->running = threads;
+
+	if ( _timeOrdered ) {
+		size_t n = _prefetch->jobs.size();
+		_prefetch->merging.resize(n, NULL);
+		_prefetch->pending.resize(n, NULL);
+		_prefetch->positions.resize(n, 0);
+		_prefetch->openStreams = n;
+
+		for ( size_t i = 0; i < n; ++i ) {
+			const StreamIdx &idx = _prefetch->jobs[i];
+			SDSArchive *arc = new SDSArchive;
+			_prefetch->readers.push_back(arc);
+			arc->setSource(source);
+			arc->setStartTime(_stime);
+			arc->setEndTime(_etime);
+			arc->addStream(idx.network(), idx.station(), idx.location(), idx.channel(),
+			               idx.startTime(), idx.endTime());
+			_prefetch->requests.push_back(i);
+		}
+
+		for ( int i = 0; i < threads; ++i )
+			_prefetch->workers.create_thread(
+				boost::bind(&Prefetch::workOrdered, _prefetch, _stime, _etime)
+			);
+		return;
+	}
+
+	for ( int i = 0; i < threads; ++i )
+		_prefetch->workers.create_thread(
+			boost::bind(&Prefetch::work, _prefetch, source, _stime, _etime)
+		);
+}
+
+void SDSArchive::stopPrefetch() {
+	if ( _prefetch == NULL ) return;
+
+	static_cast<MappedBuffer*>(_mapBuffer)->setView(NULL, NULL);
+
+	{
+		boost::mutex::scoped_lock lk(_prefetch->mutex);
+		_prefetch->aborted = true;
+		_prefetch->notFull.notify_all();
+		_prefetch->hasRequest.notify_all();
+	}
+
+	_prefetch->workers.join_all();
+	delete _prefetch;
+	_prefetch = NULL;
+}
+
+istream &SDSArchive::parallelStream() {
+	if ( _prefetch == NULL )
+		startPrefetch();
+	else {
+		/* go on at the current chunk */
+		_mapStream.peek();
+		if ( _mapStream.good() )
+			return _mapStream;
+	}
+
+	MappedBuffer *buf = static_cast<MappedBuffer*>(_mapBuffer);
+
+	if ( _timeOrdered ) {
+		// k-way merge of the streams by the start time of their next
+		// record, ties are broken by request order
+		if ( !_prefetch->started ) {
+			for ( size_t i = 0; i < _prefetch->jobs.size(); ++i )
+				_prefetch->advance(i);
+			_prefetch->started = true;
+		}
+		else if ( _prefetch->exhausted >= 0 ) {
+			// The last record of the chunk has been read
+			buf->setView(NULL, NULL);
+			_prefetch->advance(_prefetch->exhausted);
+			_prefetch->exhausted = -1;
+		}
+
+		if ( !_prefetch->heap.empty() ) {
+			size_t job = _prefetch->heap.top().second;
+			_prefetch->heap.pop();
+
+			Chunk *chunk = _prefetch->merging[job];
+			const Chunk::Rec &rec = chunk->records[_prefetch->positions[job]++];
+
+			if ( _prefetch->positions[job] < chunk->records.size() )
+				_prefetch->heap.push(Prefetch::HeapEntry(chunk->records[_prefetch->positions[job]].time, job));
+			else
+				_prefetch->exhausted = job;
+
+			char *data = &chunk->data[rec.offset];
+			buf->setView(data, data + rec.length);
+			_prefetch->delivered = true;
+			_mapStream.clear();
+			return _mapStream;
+		}
+	}
+	else {
+		Chunk *chunk;
+		while ( (chunk = _prefetch->pop()) != NULL ) {
+			buf->setView(NULL, NULL);
+			delete _prefetch->current;
+			_prefetch->current = chunk;
+
+			if ( chunk->data.empty() ) continue;
+
+			buf->setView(&chunk->data[0], &chunk->data[0] + chunk->data.size());
+			_prefetch->delivered = true;
+			_mapStream.clear();
+			return _mapStream;
+		}
+	}
+
+	if ( !_prefetch->delivered ) {
+		SEISCOMP_DEBUG("no data found in SDS archive");
+		throw ArchiveException("no data found in SDS archive");
+	}
+
+	buf->setView(NULL, NULL);
+	_mapStream.clear(ios::eofbit);
+	return _mapStream;
+}
@@ -32,7 +32,21 @@ DEFINE_SMARTPOINTER(SDSArchive);
 /* This class allows the file access to a SDS data archive given by the 
    archive root and stream time windows (wildcarding not supported!!!)
    archive structure: 
-   <root>/<year>/<net>/<sta>/<cha>.D/<net>.<sta>.<loc>.<cha>.D.<year>.<doy> */
+   <root>/<year>/<net>/<sta>/<cha>.D/<net>.<sta>.<loc>.<cha>.D.<year>.<doy>
+
+   If the source is given as <root>?mmap the day files are memory mapped
+   and the requested time window is located with a binary search over the
+   fixed size records of the mapping. The returned stream reads directly
+   from the mapped pages so only the records inside the requested time
+   window are touched.
+
+   With <root>?threads=n the requested streams are fetched by n worker
+   threads in parallel and handed over through a bounded queue. Records
+   are returned stream by stream in the order the workers finish them
+   unless order=time is given which merges all records by start time.
+   For the merge the streams are read in pieces of up to 128 kB on demand,
+   so at most about two pieces per stream are held in memory. The records
+   of each stream are expected in time order as in the SDS day files. */
 class SC_SYSTEM_CORE_API SDSArchive:  public Seiscomp::IO::RecordStream {
 	DECLARE_SC_CLASS(SDSArchive);
 
@@ -82,6 +96,22 @@ class SC_SYSTEM_CORE_API SDSArchive:  public Seiscomp::IO::RecordStream {
 		bool setStart(const std::string &fname);
 		bool isEnd();
 
+		//! Implementation of stream() for memory mapped day files
+		std::istream &mappedStream();
+		bool mapFile(const std::string &fname);
+		void unmapFile();
+		//! Returns the byte offsets of the first record ending after stime
+		//! and of the first record starting after etime in the current
+		//! mapping.
+		bool findRange(const Seiscomp::Core::Time &stime,
+		               const Seiscomp::Core::Time &etime,
+		               size_t &from, size_t &to);
+
+		//! Implementation of stream() for parallel prefetching
+		std::istream &parallelStream();
+		void startPrefetch();
+		void stopPrefetch();
+
 
 	// ----------------------------------------------------------------------
 	//  Protected members
@@ -96,6 +126,20 @@ class SC_SYSTEM_CORE_API SDSArchive:  public Seiscomp::IO::RecordStream {
 		std::queue<std::string>             _fnames;
 		Seiscomp::IO::RecordStreamPtr       _recstream;
 
+		bool                                _useMMap;
+		bool                                _mapStarted;
+		bool                                _mapFound;
+		char                               *_mapData;
+		size_t                              _mapSize;
+		int                                 _mapRecLen;
+		std::streambuf                     *_mapBuffer;
+		std::istream                        _mapStream;
+
+		struct Prefetch;
+		int                                 _threads;
+		bool                                _timeOrdered;
+		Prefetch                           *_prefetch;
+
 	friend class IsoFile;
 };
 
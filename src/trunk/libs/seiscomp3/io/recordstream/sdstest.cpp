@@ -0,0 +1,243 @@
+/***************************************************************************
+ *   Copyright (C) by GFZ Potsdam                                          *
+ *                                                                         *
+ *   You can redistribute and/or modify this program under the             *
+ *   terms of the SeisComP Public License.                                 *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   SeisComP Public License for more details.                             *
+ ***************************************************************************/
+
+
+// Writes a synthetic SDS archive and reads a time window crossing a day
+// boundary sequentially, with parallel prefetching in stream order and
+// merged by time. Checks that all modes return the same records per
+// stream, that order=time returns them by start time and reports the
+// time of each mode.
+// Usage: testsdsarchive [streams] [days] [threads]
+
+
+#include <seiscomp3/io/recordstream/sdsarchive.h>
+#include <seiscomp3/io/recordinput.h>
+#include <seiscomp3/core/strings.h>
+#include <seiscomp3/utils/timer.h>
+
+#include <libmseed.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace std;
+using namespace Seiscomp;
+
+
+namespace {
+
+
+const double SamplingFrequency = 10;
+
+
+void writeRecord(char *record, int reclen, void *fp) {
+	fwrite(record, reclen, 1, static_cast<FILE*>(fp));
+}
+
+
+bool makeDirs(const string &path) {
+	for ( size_t pos = 1; pos != string::npos; ) {
+		pos = path.find('/', pos + 1);
+		if ( mkdir(path.substr(0, pos).c_str(), 0755) != 0 && errno != EEXIST )
+			return false;
+	}
+
+	return true;
+}
+
+
+string stationCode(int stream) {
+	char code[8];
+	snprintf(code, sizeof(code), "S%03d", stream);
+	return code;
+}
+
+
+// Writes one day file per stream and day. The streams start at slightly
+// different times so that the merge has to interleave them.
+bool createArchive(const string &root, int streams, int days) {
+	srand(1);
+
+	for ( int s = 0; s < streams; ++s ) {
+		string sta = stationCode(s);
+
+		for ( int d = 0; d < days; ++d ) {
+			Core::Time start = Core::Time(2015, 1, 1 + d) + Core::TimeSpan(s * 0.37);
+			int year, doy;
+			start.get2(&year, &doy);
+
+			string dir = root + "/" + Core::toString(year) + "/XX/" + sta + "/BHZ.D";
+			if ( !makeDirs(dir) ) return false;
+
+			char name[64];
+			snprintf(name, sizeof(name), "XX.%s..BHZ.D.%04d.%03d", sta.c_str(), year, doy + 1);
+			FILE *fp = fopen((dir + "/" + name).c_str(), "wb");
+			if ( fp == NULL ) return false;
+
+			vector<int32_t> samples((int)(86400 * SamplingFrequency) - 10);
+			int32_t v = 0;
+			for ( size_t i = 0; i < samples.size(); ++i ) {
+				v += rand() % 401 - 200;
+				samples[i] = v;
+			}
+
+			MSRecord *msr = msr_init(NULL);
+			strcpy(msr->network, "XX");
+			strcpy(msr->station, sta.c_str());
+			strcpy(msr->channel, "BHZ");
+			msr->starttime = ms_time2hptime(year, doy + 1, 0, 0, 0, 0) +
+			                 (hptime_t)(s * 0.37 * HPTMODULUS);
+			msr->samprate = SamplingFrequency;
+			msr->reclen = 512;
+			msr->encoding = DE_STEIM2;
+			msr->byteorder = 1;
+			msr->datasamples = &samples[0];
+			msr->numsamples = samples.size();
+			msr->sampletype = 'i';
+
+			int64_t packed;
+			int res = msr_pack(msr, writeRecord, fp, &packed, 1, 0);
+
+			msr->datasamples = NULL;
+			msr_free(&msr);
+			fclose(fp);
+
+			if ( res <= 0 ) return false;
+		}
+	}
+
+	return true;
+}
+
+
+struct Result {
+	map<string, int> records;
+	bool             timeOrdered;
+	double           seconds;
+};
+
+
+bool read(const string &source, int streams, const Core::TimeWindow &tw,
+          Result &result) {
+	RecordStream::SDSArchive arc;
+	if ( !arc.setSource(source) ) return false;
+
+	for ( int s = 0; s < streams; ++s )
+		arc.addStream("XX", stationCode(s), "", "BHZ");
+	arc.setTimeWindow(tw);
+
+	result.records.clear();
+	result.timeOrdered = true;
+
+	Util::StopWatch timer;
+	IO::RecordInput input(&arc, Array::INT, Record::SAVE_RAW);
+	Core::Time last;
+
+	try {
+		for ( IO::RecordIterator it = input.begin(); it != input.end(); ++it ) {
+			Record *rec = *it;
+			++result.records[rec->stationCode()];
+			if ( rec->startTime() < last ) result.timeOrdered = false;
+			last = rec->startTime();
+			delete rec;
+		}
+	}
+	catch ( std::exception &e ) {
+		fprintf(stderr, "%s: %s\n", source.c_str(), e.what());
+		return false;
+	}
+
+	result.seconds = (double)timer.elapsed();
+	return true;
+}
+
+
+int total(const Result &result) {
+	int n = 0;
+	for ( map<string, int>::const_iterator it = result.records.begin();
+	      it != result.records.end(); ++it )
+		n += it->second;
+	return n;
+}
+
+
+}
+
+
+int main(int argc, char **argv) {
+	int streams = argc > 1 ? atoi(argv[1]) : 20;
+	int days = argc > 2 ? atoi(argv[2]) : 2;
+	int threads = argc > 3 ? atoi(argv[3]) : 4;
+
+	char tmpl[] = "/tmp/testsdsarchive.XXXXXX";
+	if ( mkdtemp(tmpl) == NULL ) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	string root = tmpl;
+	if ( !createArchive(root, streams, days) ) {
+		fprintf(stderr, "failed to create the archive in %s\n", root.c_str());
+		return 1;
+	}
+
+	// From the middle of the first to the middle of the last day
+	Core::TimeWindow tw(Core::Time(2015, 1, 1, 12),
+	                    Core::Time(2015, 1, days, 12));
+
+	const char *modes[] = { "", "?threads=", "?order=time&threads=" };
+	const char *names[] = { "sequential", "parallel", "order=time" };
+	Result reference;
+	int errors = 0;
+
+	for ( int m = 0; m < 3; ++m ) {
+		string source = root + modes[m];
+		if ( m > 0 ) source += Core::toString(threads);
+
+		Result result;
+		if ( !read(source, streams, tw, result) ) {
+			++errors;
+			continue;
+		}
+
+		if ( m == 0 )
+			reference = result;
+		else if ( result.records != reference.records ) {
+			fprintf(stderr, "%s: records differ from the sequential read\n", names[m]);
+			++errors;
+		}
+
+		if ( m == 2 && !result.timeOrdered ) {
+			fprintf(stderr, "%s: records are not ordered by time\n", names[m]);
+			++errors;
+		}
+
+		printf("%-10s %3d streams: %7d records, %.3f s\n", names[m],
+		       (int)result.records.size(), total(result), result.seconds);
+	}
+
+	if ( total(reference) == 0 ) {
+		fprintf(stderr, "no records read\n");
+		++errors;
+	}
+
+	system(("rm -rf " + root).c_str());
+
+	return errors ? 1 : 0;
+}
@@ -18,6 +18,8 @@
 #include <cstdarg>
 #include <iomanip>
 #include <sstream>
+#include <stdio.h>
+#include <boost/bind.hpp>
 
 
 namespace Seiscomp {
@@ -25,14 +27,18 @@ namespace Logging {
 
 
 FileOutput::FileOutput()
- : _stream() {
+ : _stream(), _writer(NULL), _queueSize(0), _dropOnOverflow(false),
+   _stopWriter(false), _dropped(0) {
 }
 
 FileOutput::FileOutput(const char* filename)
- : _filename(filename), _stream(filename, std::ios_base::out | std::ios_base::app) {
+ : _filename(filename), _stream(filename, std::ios_base::out | std::ios_base::app),
+   _writer(NULL), _queueSize(0), _dropOnOverflow(false),
+   _stopWriter(false), _dropped(0) {
 }
 
 FileOutput::~FileOutput() {
+	stopAsync();
 	_stream.close();
 }
 
@@ -46,38 +52,139 @@ bool FileOutput::isOpen() {
 	return _stream.is_open();
 }
 
+void FileOutput::startAsync(size_t queueSize, bool dropOnOverflow) {
+	stopAsync();
+
+	_queueSize = queueSize > 0 ? queueSize : 1;
+	_dropOnOverflow = dropOnOverflow;
+	_stopWriter = false;
+	_dropped = 0;
+	_writer = new boost::thread(boost::bind(&FileOutput::writerLoop, this));
+}
+
+void FileOutput::stopAsync() {
+	if ( _writer == NULL ) return;
+
+	{
+		boost::mutex::scoped_lock lock(_queueMutex);
+		_stopWriter = true;
+	}
+
+	_queueNotEmpty.notify_all();
+	_queueNotFull.notify_all();
+	_writer->join();
+	delete _writer;
+	_writer = NULL;
+}
+
+bool FileOutput::isAsync() const {
+	return _writer != NULL;
+}
+
 void FileOutput::log(const char* channelName,
                      LogLevel level,
                      const char* msg,
                      time_t time) {
 	tm currentTime;
 
+#ifndef WIN32
+	if ( _useUTC )
+		gmtime_r(&time, &currentTime);
+	else
+		localtime_r(&time, &currentTime);
+#else
 	currentTime = _useUTC ? *gmtime(&time) : *localtime(&time);
+#endif
+
+	char stamp[32];
+	snprintf(stamp, sizeof(stamp), "%d/%02d/%02d %02d:%02d:%02d ",
+	         currentTime.tm_year + 1900, currentTime.tm_mon + 1,
+	         currentTime.tm_mday, currentTime.tm_hour,
+	         currentTime.tm_min, currentTime.tm_sec);
+
+	std::string line(stamp);
+	line += "[";
+	line += channelName;
+	if ( likely(_logComponent) ) {
+		line += "/";
+		line += component();
+	}
+	line += "] ";
+	if ( unlikely(_logContext) ) {
+		char lineNumber[16];
+		snprintf(lineNumber, sizeof(lineNumber), "%d", lineNum());
+		line += "(";
+		line += fileName();
+		line += ":";
+		line += lineNumber;
+		line += ") ";
+	}
+	line += msg;
+
+	if ( _writer == NULL ) {
+		write(line, time);
+		return;
+	}
+
+	boost::mutex::scoped_lock lock(_queueMutex);
+
+	while ( _queue.size() >= _queueSize && !_stopWriter ) {
+		if ( _dropOnOverflow ) {
+			++_dropped;
+			return;
+		}
+
+		_queueNotFull.wait(lock);
+	}
+
+	_queue.push_back(Entry(line, time));
+	if ( _queue.size() == 1 )
+		_queueNotEmpty.notify_one();
+}
+
+void FileOutput::write(const std::string &line, time_t) {
+	_stream << line << '\n';
 
-	_stream << (currentTime.tm_year + 1900) << "/";
+	// The writer thread flushes once per batch
+	if ( _writer == NULL )
+		_stream.flush();
+}
 
-	int w = _stream.width();
-	char f = _stream.fill();
+void FileOutput::writerLoop() {
+	Entries batch;
 
-	_stream << std::setfill('0') << std::setw(2) << (currentTime.tm_mon + 1) << "/"
-	        << std::setfill('0') << std::setw(2) << currentTime.tm_mday << " ";
+	while ( true ) {
+		size_t dropped;
+		bool stop;
 
-	_stream << std::setfill('0') << std::setw(2) << currentTime.tm_hour << ":"
-	        << std::setfill('0') << std::setw(2) << currentTime.tm_min << ":"
-	        << std::setfill('0') << std::setw(2) << currentTime.tm_sec << " ";
+		{
+			boost::mutex::scoped_lock lock(_queueMutex);
+			while ( _queue.empty() && !_stopWriter )
+				_queueNotEmpty.wait(lock);
 
-	_stream.width(w);
-	_stream.fill(f);
+			batch.swap(_queue);
+			dropped = _dropped;
+			_dropped = 0;
+			stop = _stopWriter;
+		}
 
-	_stream << "[" << channelName;
-	if ( likely(_logComponent) )
-		_stream << "/" << component();
-	_stream << "] ";
-	if ( unlikely(_logContext) )
-		_stream << "(" << fileName() << ':' << lineNum() << ") ";
-	_stream << msg << std::endl;
-}
+		_queueNotFull.notify_all();
 
+		for ( Entries::iterator it = batch.begin(); it != batch.end(); ++it )
+			write(it->line, it->time);
+
+		if ( dropped > 0 ) {
+			std::ostringstream ss;
+			ss << "[log] " << dropped << " log entries dropped, queue full";
+			write(ss.str(), ::time(NULL));
+		}
+
+		_stream.flush();
+		batch.clear();
+
+		if ( stop ) break;
+	}
+}
 
 }
 }
@@ -16,6 +16,9 @@
 
 #include <seiscomp3/logging/output.h>
 #include <fstream>
+#include <deque>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
 
 
 namespace Seiscomp {
@@ -31,6 +34,23 @@ class SC_SYSTEM_CORE_API FileOutput : public Output {
 		virtual bool open(const char* filename);
 		bool isOpen();
 
+		/**
+		 * Enables asynchronous writing. Log entries are formatted by the
+		 * calling thread and queued, a background thread writes them in
+		 * batches. Derived classes that override write() must call
+		 * stopAsync() in their destructor.
+		 * @param queueSize The maximum number of queued entries
+		 * @param dropOnOverflow Whether to drop entries if the queue is
+		 *                       full instead of blocking the caller
+		 */
+		void startAsync(size_t queueSize, bool dropOnOverflow);
+
+		//! Writes all queued entries and stops the background thread
+		void stopAsync();
+
+		//! Returns whether the background thread is running
+		bool isAsync() const;
+
 	protected:
 		/** Callback method for receiving log messages */
 		void log(const char* channelName,
@@ -38,9 +58,36 @@ class SC_SYSTEM_CORE_API FileOutput : public Output {
 		         const char* msg,
 		         time_t time);
 
+		//! Writes a formatted line without the trailing newline
+		virtual void write(const std::string &line, time_t time);
+
+	private:
+		struct Entry {
+			Entry() {}
+			Entry(const std::string &l, time_t t) : line(l), time(t) {}
+
+			std::string line;
+			time_t      time;
+		};
+
+		typedef std::deque<Entry> Entries;
+
+		void writerLoop();
+
 	protected:
 		std::string _filename;
 		mutable std::ofstream _stream;
+
+	private:
+		boost::thread    *_writer;
+		boost::mutex      _queueMutex;
+		boost::condition  _queueNotEmpty;
+		boost::condition  _queueNotFull;
+		Entries           _queue;
+		size_t            _queueSize;
+		bool              _dropOnOverflow;
+		bool              _stopWriter;
+		size_t            _dropped;
 };
 
 
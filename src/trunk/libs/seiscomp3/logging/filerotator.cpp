@@ -36,6 +36,12 @@ FileRotatorOutput::FileRotatorOutput(const char* filename, int timeSpan, int his
  : FileOutput(filename), _timeSpan(timeSpan), _historySize(historySize), _lastInterval(-1) {
 }
 
+FileRotatorOutput::~FileRotatorOutput() {
+	// The writer thread calls write() which must not happen once this
+	// part of the object is gone
+	stopAsync();
+}
+
 bool FileRotatorOutput::open(const char* filename) {
 	if ( !FileOutput::open(filename) ) return false;
 
@@ -48,10 +54,7 @@ bool FileRotatorOutput::open(const char* filename) {
 	return true;
 }
 
-void FileRotatorOutput::log(const char* channelName,
-                            LogLevel level,
-                            const char* msg,
-                            time_t time) {
+void FileRotatorOutput::write(const std::string &line, time_t time) {
 	boost::mutex::scoped_lock l(outputMutex);
 
 	int currentInterval = (int)(time / (time_t)_timeSpan);
@@ -64,7 +67,7 @@ void FileRotatorOutput::log(const char* channelName,
 		_lastInterval = currentInterval;
 	}
 
-	FileOutput::log(channelName, level, msg, time);
+	FileOutput::write(line, time);
 }
 
 void FileRotatorOutput::removeLog(int index) {
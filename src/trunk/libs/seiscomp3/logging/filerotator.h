@@ -31,15 +31,13 @@ class SC_SYSTEM_CORE_API FileRotatorOutput : public FileOutput {
 		 * @param count The number of historic files to store
 		 */
 		FileRotatorOutput(const char* filename, int timeSpan = 60*60*24, int historySize = 7);
+		~FileRotatorOutput();
 
 		bool open(const char* filename);
 
 	protected:
-		/** Callback method for receiving log messages */
-		void log(const char* channelName,
-		         LogLevel level,
-		         const char* msg,
-		         time_t time);
+		//! Rotates the logs if the interval of time has changed
+		void write(const std::string &line, time_t time);
 
 	private:
 		void rotateLogs();
@@ -26,6 +26,7 @@ namespace Processing {
 Application::Application(int argc, char **argv)
 : Client::StreamApplication(argc, argv), _waveformBuffer(30.*60.) {
 	_registrationBlocked = false;
+	_processorCount = 0;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -107,7 +108,11 @@ void Application::registerProcessor(const std::string& networkCode,
                                     const std::string& locationCode,
                                     const std::string& channelCode,
                                     WaveformProcessor *wp) {
-	_processors.insert(ProcessorMap::value_type(networkCode + "." + stationCode + "." + locationCode + "." + channelCode, wp));
+	StreamBuffer::Handle handle = Core::StreamIdTable::Intern(networkCode, stationCode, locationCode, channelCode);
+	if ( handle >= _processors.size() )
+		_processors.resize(handle+1);
+	_processors[handle].push_back(wp);
+	++_processorCount;
 
 	// Because we are dealing with a multimap we need to check if the pointer
 	// is already registered for this station. Otherwise the remove method will
@@ -131,7 +136,7 @@ void Application::registerProcessor(const std::string& networkCode,
 	SEISCOMP_DEBUG("Added processor on stream %s.%s.%s.%s, current size: %lu/%lu, object count: %d",
 	              networkCode.c_str(), stationCode.c_str(),
 	              locationCode.c_str(), channelCode.c_str(),
-	              (unsigned long)_processors.size(), (unsigned long)_stationProcessors.size(),
+	              (unsigned long)_processorCount, (unsigned long)_stationProcessors.size(),
 	              Core::BaseObject::ObjectCount());
 	SEISCOMP_DEBUG("Added proc %ld", (long)wp);
 }
@@ -205,28 +210,32 @@ void Application::removeProcessors(const std::string& networkCode,
                                    const std::string& channelCode) {
 
 	bool checkPendingQueue;
-	std::pair<ProcessorMap::iterator, ProcessorMap::iterator> itq =
-		_processors.equal_range(networkCode + "." +
-		                        stationCode + "." +
-		                        locationCode + "." +
-		                        channelCode);
-
-	checkPendingQueue = itq.first == itq.second;
-
-	// Remove stations - processor association
-	for ( ProcessorMap::iterator it = itq.first; it != itq.second; ++it ) {
-		for ( StationProcessors::iterator its = _stationProcessors.begin();
-		      its != _stationProcessors.end(); )
-		{
-			if ( its->second == it->second ) {
-				SEISCOMP_DEBUG("Removed processor from station %s", its->first.c_str());
-				_stationProcessors.erase(its++);
-				break;
+	StreamBuffer::Handle handle = Core::StreamIdTable::Intern(networkCode,
+	                                                          stationCode,
+	                                                          locationCode,
+	                                                          channelCode);
+
+	checkPendingQueue = handle >= _processors.size() || _processors[handle].empty();
+
+	if ( !checkPendingQueue ) {
+		ProcessorList &procs = _processors[handle];
+
+		// Remove stations - processor association
+		for ( ProcessorList::iterator it = procs.begin(); it != procs.end(); ++it ) {
+			for ( StationProcessors::iterator its = _stationProcessors.begin();
+			      its != _stationProcessors.end(); ++its )
+			{
+				if ( its->second == *it ) {
+					SEISCOMP_DEBUG("Removed processor from station %s", its->first.c_str());
+					_stationProcessors.erase(its);
+					break;
+				}
 			}
 		}
-	}
 
-	_processors.erase(itq.first, itq.second);
+		_processorCount -= procs.size();
+		procs.clear();
+	}
 
 	if ( !checkPendingQueue ) return;
 
@@ -261,16 +270,18 @@ void Application::removeProcessor(Processing::WaveformProcessor *wp) {
 		return;
 	}
 
-	for ( ProcessorMap::iterator it = _processors.begin();
-	      it != _processors.end(); )
-	{
-		if ( it->second.get() == wp ) {
-			SEISCOMP_DEBUG("Removed proc %ld", (long)wp);
-			SEISCOMP_DEBUG("Removed processor from stream %s", it->first.c_str());
-			_processors.erase(it++);
+	for ( size_t i = 0; i < _processors.size(); ++i ) {
+		ProcessorList &procs = _processors[i];
+		for ( ProcessorList::iterator it = procs.begin(); it != procs.end(); ) {
+			if ( it->get() == wp ) {
+				SEISCOMP_DEBUG("Removed proc %ld", (long)wp);
+				SEISCOMP_DEBUG("Removed processor from stream %s", Core::StreamIdTable::Name((Core::StreamId)i).c_str());
+				it = procs.erase(it);
+				--_processorCount;
+			}
+			else
+				++it;
 		}
-		else
-			++it;
 	}
 
 	for ( StationProcessors::iterator it = _stationProcessors.begin();
@@ -307,7 +318,7 @@ void Application::removeProcessor(Processing::WaveformProcessor *wp) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 size_t Application::processorCount() const {
-	return _processors.size();
+	return _processorCount;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -361,7 +372,6 @@ void Application::updateObject(const std::string& parentID, DataModel::Object* o
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::handleRecord(Record *rec) {
-	std::string streamID = rec->streamID();
 	std::list<WaveformProcessor*> trashList;
 
 	RecordPtr tmp(rec);
@@ -370,20 +380,27 @@ void Application::handleRecord(Record *rec) {
 
 	if ( !_waveformBuffer.feed(rec) ) return;
 
+	// The stream has been resolved by the buffer already, its handle
+	// indexes the processor table directly
+	StreamBuffer::Handle handle = _waveformBuffer.lastHandle();
+
 	if ( _waveformBuffer.addedNewStream() )
 		handleNewStream(rec);
 
 	_registrationBlocked = true;
 
-	std::pair<ProcessorMap::iterator, ProcessorMap::iterator> itq = _processors.equal_range(streamID);
-	for (ProcessorMap::iterator it = itq.first; it != itq.second; ++it) {
-		// Schedule the processor for deletion when finished
-		if ( it->second->isFinished() )
-			trashList.push_back(it->second.get());
-		else {
-			it->second->feed(rec);
-			if ( it->second->isFinished() )
-				trashList.push_back(it->second.get());
+	if ( handle < _processors.size() ) {
+		const ProcessorList &procs = _processors[handle];
+		for ( size_t i = 0; i < procs.size(); ++i ) {
+			WaveformProcessor *proc = procs[i].get();
+			// Schedule the processor for deletion when finished
+			if ( proc->isFinished() )
+				trashList.push_back(proc);
+			else {
+				proc->feed(rec);
+				if ( proc->isFinished() )
+					trashList.push_back(proc);
+			}
 		}
 	}
 
@@ -452,10 +469,13 @@ void Application::enableStation(const std::string& code, bool enabled) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Application::enableStream(const std::string& code, bool enabled) {
-	std::pair<StationProcessors::iterator, StationProcessors::iterator> itq = _processors.equal_range(code);
-	for (StationProcessors::iterator it = itq.first; it != itq.second; ++it) {
+	StreamBuffer::Handle handle = Core::StreamIdTable::Find(code);
+	if ( handle >= _processors.size() ) return;
+
+	ProcessorList &procs = _processors[handle];
+	for ( ProcessorList::iterator it = procs.begin(); it != procs.end(); ++it ) {
 		SEISCOMP_INFO("%s stream %s", enabled?"Enabling":"Disabling", code.c_str());
-		it->second->setEnabled(enabled);
+		(*it)->setEnabled(enabled);
 	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -112,7 +112,9 @@ class SC_SYSTEM_CLIENT_API Application : public Client::StreamApplication {
 	// ----------------------------------------------------------------------
 	private:
 		typedef std::multimap<std::string, WaveformProcessorPtr> StationProcessors;
-		typedef std::multimap<std::string, WaveformProcessorPtr> ProcessorMap;
+		typedef std::vector<WaveformProcessorPtr>               ProcessorList;
+		// Processor lists indexed by the stream buffer handle
+		typedef std::vector<ProcessorList>                       ProcessorMap;
 		typedef DataModel::WaveformStreamID                      WID;
 		typedef std::pair<WID, WaveformProcessorPtr>             WaveformProcessorItem;
 		typedef std::pair<WID, TimeWindowProcessorPtr>           TimeWindowProcessorItem;
@@ -121,6 +123,7 @@ class SC_SYSTEM_CLIENT_API Application : public Client::StreamApplication {
 		typedef std::list<TimeWindowProcessorItem>               TimeWindowProcessorQueue;
 
 		ProcessorMap                    _processors;
+		size_t                          _processorCount;
 		StationProcessors               _stationProcessors;
 
 		StreamBuffer                    _waveformBuffer;
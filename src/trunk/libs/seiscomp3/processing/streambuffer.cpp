@@ -13,6 +13,7 @@
 
 
 #include <iostream>
+#include <algorithm>
 #include <seiscomp3/processing/streambuffer.h>
 
 
@@ -20,6 +21,39 @@ namespace Seiscomp {
 
 namespace Processing {
 
+
+namespace {
+
+
+// Orders handles by network, station, location and channel code like
+// the former WaveformID map did
+struct CodeLess {
+	bool operator()(StreamBuffer::Handle a, StreamBuffer::Handle b) const {
+		int cmp = Core::StreamIdTable::NetworkCode(a).compare(Core::StreamIdTable::NetworkCode(b));
+		if ( cmp != 0 ) return cmp < 0;
+		cmp = Core::StreamIdTable::StationCode(a).compare(Core::StreamIdTable::StationCode(b));
+		if ( cmp != 0 ) return cmp < 0;
+		cmp = Core::StreamIdTable::LocationCode(a).compare(Core::StreamIdTable::LocationCode(b));
+		if ( cmp != 0 ) return cmp < 0;
+		return Core::StreamIdTable::ChannelCode(a) < Core::StreamIdTable::ChannelCode(b);
+	}
+};
+
+
+template <typename TABLE>
+std::vector<StreamBuffer::Handle> sortedHandles(const TABLE &sequences) {
+	std::vector<StreamBuffer::Handle> handles;
+	for ( size_t i = 0; i < sequences.size(); ++i )
+		if ( sequences[i] != NULL ) handles.push_back((StreamBuffer::Handle)i);
+	std::sort(handles.begin(), handles.end(), CodeLess());
+	return handles;
+}
+
+
+}
+
+
+const StreamBuffer::Handle StreamBuffer::InvalidHandle;
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -28,8 +62,8 @@ namespace Processing {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 StreamBuffer::StreamBuffer() {
 	_newStreamAdded = false;
+	clear();
 }
-
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -39,8 +73,8 @@ StreamBuffer::StreamBuffer() {
 StreamBuffer::StreamBuffer(const Seiscomp::Core::TimeWindow& timeWindow) {
 	setTimeWindow(timeWindow);
 	_newStreamAdded = false;
+	clear();
 }
-
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -50,8 +84,8 @@ StreamBuffer::StreamBuffer(const Seiscomp::Core::TimeWindow& timeWindow) {
 StreamBuffer::StreamBuffer(const Seiscomp::Core::TimeSpan& timeSpan) {
 	setTimeSpan(timeSpan);
 	_newStreamAdded = false;
+	clear();
 }
-
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -87,14 +121,55 @@ void StreamBuffer::setTimeSpan(const Seiscomp::Core::TimeSpan& timeSpan) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void StreamBuffer::reserve(size_t streams) {
+	_sequences.reserve(streams+1);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 RecordSequence* StreamBuffer::sequence(const WaveformID& wid) const {
-	SequenceMap::const_iterator it = _sequences.find(wid);
-	if ( it != _sequences.end() )
-		return it->second;
+	return sequence(wid.id);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+RecordSequence* StreamBuffer::sequence(Handle handle) const {
+	if ( handle < _sequences.size() )
+		return _sequences[handle];
 	return NULL;
 }
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+StreamBuffer::Handle StreamBuffer::handle(const WaveformID& wid) const {
+	return sequence(wid.id) != NULL ? wid.id : InvalidHandle;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+RecordSequence* StreamBuffer::createSequence() const {
+	switch ( _mode ) {
+		case TIME_WINDOW:
+			return new TimeWindowBuffer(Core::TimeWindow(_timeStart, _timeStart + _timeSpan));
+		case RING_BUFFER:
+			return new RingBuffer(_timeSpan);
+	}
+
+	return NULL;
+}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -106,21 +181,34 @@ RecordSequence* StreamBuffer::feed(const Record *rec) {
 
 	_newStreamAdded = false;
 
-	WaveformID wid(rec);
-	RecordSequence *seq = sequence(wid);
-
-	if ( seq == NULL ) {
-		switch ( _mode ) {
-			case TIME_WINDOW:
-				seq = new TimeWindowBuffer(Core::TimeWindow(_timeStart, _timeStart + _timeSpan));
-				break;
-			case RING_BUFFER:
-				seq = new RingBuffer(_timeSpan);
-				break;
+	RecordSequence *seq;
+
+	// Records of the same stream usually arrive in bursts. Comparing the
+	// codes with those of the last stream avoids interning the codes of
+	// the record which takes the table lock.
+	if ( _lastSequence != NULL &&
+	     rec->channelCode() == _lastCodes[3] &&
+	     rec->stationCode() == _lastCodes[1] &&
+	     rec->networkCode() == _lastCodes[0] &&
+	     rec->locationCode() == _lastCodes[2] )
+		seq = _lastSequence;
+	else {
+		// Interns the codes once per record, the id is cached in the record
+		Handle h = rec->streamId();
+		if ( h >= _sequences.size() )
+			_sequences.resize(h+1, NULL);
+
+		seq = _sequences[h];
+		if ( seq == NULL ) {
+			seq = createSequence();
+			_sequences[h] = seq;
+			++_streamCount;
+			_newStreamAdded = true;
 		}
 
-		_sequences[wid] = seq;
-		_newStreamAdded = true;
+		_lastHandle = h;
+		_lastSequence = seq;
+		_lastCodes = Core::StreamIdTable::Codes(h);
 	}
 
 	if ( seq->feed(rec) )
@@ -133,6 +221,15 @@ RecordSequence* StreamBuffer::feed(const Record *rec) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+StreamBuffer::Handle StreamBuffer::lastHandle() const {
+	return _lastHandle;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool StreamBuffer::addedNewStream() const {
 	return _newStreamAdded;
@@ -142,17 +239,24 @@ bool StreamBuffer::addedNewStream() const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t StreamBuffer::streamCount() const {
+	return _streamCount;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void StreamBuffer::printStreams(std::ostream& os) const {
-	for ( SequenceMap::const_iterator it = _sequences.begin();
-	      it != _sequences.end(); ++it ) {
+	std::vector<Handle> handles = sortedHandles(_sequences);
+	for ( size_t i = 0; i < handles.size(); ++i ) {
+		const RecordSequence *seq = _sequences[handles[i]];
 		os << "["
-		          << it->first.networkCode << "."
-		          << it->first.stationCode << "."
-		          << it->first.locationCode << "."
-		          << it->first.channelCode << "] "
-		          << it->second->timeWindow().startTime().toString("%F %T") << " - "
-		          << it->second->timeWindow().endTime().toString("%F %T")
+		          << Core::StreamIdTable::Name(handles[i]) << "] "
+		          << seq->timeWindow().startTime().toString("%F %T") << " - "
+		          << seq->timeWindow().endTime().toString("%F %T")
 		          << std::endl;
 	}
 }
@@ -166,16 +270,9 @@ std::list<std::string> StreamBuffer::getStreams() const {
 
 	std::list<std::string> streamList;
 
-	for ( SequenceMap::const_iterator it = _sequences.begin();
-	      it != _sequences.end(); ++it ) {
-		
-		streamList.push_back(
-		              it->first.networkCode + "."
-		            + it->first.stationCode + "."
-		            + it->first.locationCode + "."
-		            + it->first.channelCode
-		);
-	}
+	std::vector<Handle> handles = sortedHandles(_sequences);
+	for ( size_t i = 0; i < handles.size(); ++i )
+		streamList.push_back(Core::StreamIdTable::Name(handles[i]));
 
 	return streamList;
 }
@@ -186,11 +283,16 @@ std::list<std::string> StreamBuffer::getStreams() const {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void StreamBuffer::clear() {
-	for ( SequenceMap::iterator it = _sequences.begin();
+	for ( SequenceTable::iterator it = _sequences.begin();
 			it != _sequences.end(); ++it )
-		if ( it->second ) delete it->second;
+		if ( *it ) delete *it;
 
 	_sequences.clear();
+	_streamCount = 0;
+
+	_lastHandle = InvalidHandle;
+	_lastSequence = NULL;
+	_lastCodes = NULL;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
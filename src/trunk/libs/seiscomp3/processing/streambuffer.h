@@ -16,8 +16,10 @@
 
 #include<string>
 #include<list>
+#include<vector>
 
 #include <seiscomp3/core/recordsequence.h>
+#include <seiscomp3/core/streamid.h>
 #include <seiscomp3/client.h>
 
 
@@ -38,35 +40,37 @@ class SC_SYSTEM_CLIENT_API StreamBuffer {
 			           const std::string& sta,
 			           const std::string& loc,
 			           const std::string& cha)
-				: networkCode(net), stationCode(sta),
-				  locationCode(loc), channelCode(cha) {}
-		
+				: id(Core::StreamIdTable::Intern(net, sta, loc, cha)) {}
+
 			WaveformID(const Record *rec)
-				: networkCode(rec->networkCode()), stationCode(rec->stationCode()),
-				  locationCode(rec->locationCode()), channelCode(rec->channelCode()) {}
+				: id(rec->streamId()) {}
 
+			WaveformID(Core::StreamId sid)
+				: id(sid) {}
 
-			bool operator<(const WaveformID& other) const {
 
-				if ( networkCode < other.networkCode ) return true;
-				if ( networkCode > other.networkCode ) return false;
-		
-				if ( stationCode < other.stationCode ) return true;
-				if ( stationCode > other.stationCode ) return false;
-		
-				if ( locationCode < other.locationCode ) return true;
-				if ( locationCode > other.locationCode ) return false;
-		
-				return channelCode < other.channelCode;
+			bool operator<(const WaveformID& other) const {
+				return id < other.id;
 			}
-		
-		
-			std::string networkCode;
-			std::string stationCode;
-			std::string locationCode;
-			std::string channelCode;
+
+			const std::string &networkCode() const { return Core::StreamIdTable::NetworkCode(id); }
+			const std::string &stationCode() const { return Core::StreamIdTable::StationCode(id); }
+			const std::string &locationCode() const { return Core::StreamIdTable::LocationCode(id); }
+			const std::string &channelCode() const { return Core::StreamIdTable::ChannelCode(id); }
+			const std::string &streamID() const { return Core::StreamIdTable::Name(id); }
+
+			//! The interned stream id
+			Core::StreamId id;
 		};
 
+		//! Handle of a buffered stream. Handles are the interned stream
+		//! ids and can be used to index per stream tables, e.g. to
+		//! resolve the processors of a stream once instead of per record.
+		typedef Core::StreamId Handle;
+
+		//! The handle of no stream
+		static const Handle InvalidHandle = Core::InvalidStreamId;
+
 
 	// ----------------------------------------------------------------------
 	//  Xstruction
@@ -92,11 +96,26 @@ class SC_SYSTEM_CLIENT_API StreamBuffer {
 		void setTimeWindow(const Seiscomp::Core::TimeWindow& timeWindow);
 		void setTimeSpan(const Seiscomp::Core::TimeSpan& timeSpan);
 
+		//! Preallocates the stream table for the given number of streams
+		void reserve(size_t streams);
+
 		RecordSequence* sequence(const WaveformID& wid) const;
+		RecordSequence* sequence(Handle handle) const;
+
+		//! Returns the handle of the stream or InvalidHandle if the
+		//! stream has not been fed yet
+		Handle handle(const WaveformID& wid) const;
+
 		RecordSequence* feed(const Record *rec);
 
+		//! Returns the handle of the stream of the last fed record
+		Handle lastHandle() const;
+
 		bool addedNewStream() const;
 
+		//! Returns the number of buffered streams
+		size_t streamCount() const;
+
 		void printStreams(std::ostream& os=std::cout) const;
 		std::list<std::string> getStreams() const;
 
@@ -118,8 +137,20 @@ class SC_SYSTEM_CLIENT_API StreamBuffer {
 		Seiscomp::Core::Time _timeStart;
 		Seiscomp::Core::TimeSpan _timeSpan;
 
-		typedef std::map<WaveformID, RecordSequence*> SequenceMap;
-		SequenceMap _sequences;
+		RecordSequence *createSequence() const;
+
+		// Sequences indexed by the interned stream id. The ids are
+		// dense so this is cheaper than any hash map.
+		typedef std::vector<RecordSequence*> SequenceTable;
+		SequenceTable _sequences;
+		size_t        _streamCount;
+
+		// Cache of the last fed stream. Records usually arrive in
+		// bursts of the same stream, so comparing the codes with the
+		// cached interned codes avoids the symbol table lookup.
+		Handle             _lastHandle;
+		RecordSequence    *_lastSequence;
+		const std::string *_lastCodes;
 
 		bool _newStreamAdded;
 };
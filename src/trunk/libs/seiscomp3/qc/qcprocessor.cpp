@@ -13,6 +13,8 @@
 
 #include <seiscomp3/qc/qcprocessor.h>
 
+#include <math.h>
+
 namespace Seiscomp {
 namespace Processing {
 
@@ -35,6 +37,67 @@ IMPLEMENT_SC_ABSTRACT_CLASS_DERIVED(QcProcessor, WaveformProcessor, "QcProcessor
 //     throw (Core::ValueException);
 // }
 
+QcRecordStatistics::QcRecordStatistics()
+	: count(0), mean(0), rms(0), _record(NULL) {}
+
+
+
+
+void QcRecordStatistics::update(const Record *record, const DoubleArray &data) {
+	// The record is kept alive while it is fed to the processors of its
+	// stream, the start time guards against a reused address afterwards
+	if (record == _record && record->startTime() == _startTime &&
+	    (size_t)data.size() == count)
+		return;
+
+	compute(data);
+	_record = record;
+	_startTime = record->startTime();
+}
+
+
+
+
+void QcRecordStatistics::compute(const DoubleArray &data) {
+	size_t n = data.size();
+	const double *f = data.typedData();
+
+	count = n;
+	if (n == 0) {
+		mean = rms = 0;
+		return;
+	}
+
+	// Sum relative to the first sample to avoid cancellation with large
+	// offsets. Independent accumulators let the compiler vectorize.
+	double shift = f[0];
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	double q0 = 0, q1 = 0, q2 = 0, q3 = 0;
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4) {
+		double d0 = f[i] - shift, d1 = f[i+1] - shift;
+		double d2 = f[i+2] - shift, d3 = f[i+3] - shift;
+		s0 += d0; s1 += d1; s2 += d2; s3 += d3;
+		q0 += d0*d0; q1 += d1*d1; q2 += d2*d2; q3 += d3*d3;
+	}
+
+	for (; i < n; ++i) {
+		double d = f[i] - shift;
+		s0 += d;
+		q0 += d*d;
+	}
+
+	double m = (s0 + s1 + s2 + s3) / n;
+	double var = (q0 + q1 + q2 + q3) / n - m*m;
+
+	mean = shift + m;
+	rms = var > 0 ? sqrt(var) : 0;
+}
+
+
+
+
 QcProcessor::QcProcessor(const Core::TimeSpan &deadTime,
 						const Core::TimeSpan &gapThreshold) 
 	: WaveformProcessor(deadTime, gapThreshold),
@@ -113,5 +176,26 @@ bool QcProcessor::isValid() const {
 
 
 
+
+void QcProcessor::setRecordStatistics(QcRecordStatistics *stats) {
+	_statistics = stats;
+}
+
+
+
+
+const QcRecordStatistics &QcProcessor::statistics(const Record *record, const DoubleArray &data) {
+	// Filtered data differs from what the other processors see
+	if (!_statistics || _stream.filter) {
+		_ownStatistics.compute(data);
+		return _ownStatistics;
+	}
+
+	_statistics->update(record, data);
+	return *_statistics;
+}
+
+
+
 }
 }
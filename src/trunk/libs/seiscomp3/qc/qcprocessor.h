@@ -60,6 +60,34 @@ public:
 
 
 
+DEFINE_SMARTPOINTER(QcRecordStatistics);
+
+//! Sample statistics of a record. An instance can be shared by all
+//! processors of a stream, the statistics are then computed only once per
+//! record by the first processor that asks for them.
+class SC_SYSTEM_CLIENT_API QcRecordStatistics : public Core::BaseObject {
+public:
+    QcRecordStatistics();
+
+    //! Computes the statistics of data unless they have been computed
+    //! for record already
+    void update(const Record *record, const DoubleArray &data);
+
+    //! Computes mean and rms in a single pass over the samples
+    void compute(const DoubleArray &data);
+
+    size_t count;
+    double mean;
+    double rms;
+
+private:
+    const Record *_record;
+    Core::Time _startTime;
+};
+
+
+
+
 DEFINE_SMARTPOINTER(QcProcessor);
 
 class SC_SYSTEM_CLIENT_API QcProcessor : public WaveformProcessor {
@@ -90,15 +118,24 @@ public:
     //! Returns true in case of a valid value in QC processing result; false otherwise
     bool isValid() const;
 
+    //! Sets the statistics shared with the other processors of the stream
+    void setRecordStatistics(QcRecordStatistics *stats);
+
 protected:
     //! Implements the inherited method
     //! Notifies registered observers
     virtual void process(const Record* record, const DoubleArray& data);
 
+    //! Returns the statistics of the data passed to setState. Shared
+    //! statistics are only used if no filter is set.
+    const QcRecordStatistics &statistics(const Record* record, const DoubleArray& data);
+
     QcParameterPtr _qcp;
     
 private:
     std::deque<QcProcessorObserver *> _observers;
+    QcRecordStatisticsPtr _statistics;
+    QcRecordStatistics _ownStatistics;
     bool _setFlag;
     bool _validFlag;
 };
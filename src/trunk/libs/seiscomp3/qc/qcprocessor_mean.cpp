@@ -25,7 +25,7 @@ QcProcessorMean::QcProcessorMean()
     : QcProcessor() {}
 
 bool QcProcessorMean::setState(const Record *record, const DoubleArray &data) {
-    _qcp->parameter = data.mean();
+    _qcp->parameter = statistics(record, data).mean;
     return true;
 }
 
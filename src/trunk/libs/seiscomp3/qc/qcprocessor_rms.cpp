@@ -24,7 +24,7 @@ QcProcessorRms::QcProcessorRms()
     : QcProcessor() {}
 
 bool QcProcessorRms::setState(const Record *record, const DoubleArray &data) {
-    _qcp->parameter = data.rms(data.mean());
+    _qcp->parameter = statistics(record, data).rms;
     return true;
 }
 
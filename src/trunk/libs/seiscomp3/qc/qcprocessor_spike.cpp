@@ -62,8 +62,9 @@ bool QcProcessorSpike::setState(const Record *rec, const DoubleArray &data) {
     Spikes spikes; 
 
     //! rms and mean from filtered data
-    double mean = data.mean();
-    double rms = data.rms(mean);
+    const QcRecordStatistics &stats = statistics(rec, data);
+    double mean = stats.mean;
+    double rms = stats.rms;
     
     double p1, p2;
     int last_i = (int)(-fsamp/2 - 1);
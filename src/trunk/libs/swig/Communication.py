@@ -120,6 +120,7 @@ class Protocol(_object):
     CONTENT_UNCOMPRESSED_BSON = _Communication.Protocol_CONTENT_UNCOMPRESSED_BSON
     CONTENT_JSON = _Communication.Protocol_CONTENT_JSON
     CONTENT_UNCOMPRESSED_JSON = _Communication.Protocol_CONTENT_UNCOMPRESSED_JSON
+    CONTENT_UNCOMPRESSED_BINARY = _Communication.Protocol_CONTENT_UNCOMPRESSED_BINARY
     MCT_QUANTITY = _Communication.Protocol_MCT_QUANTITY
     __swig_getmethods__["MsgTypeToString"] = lambda x: _Communication.Protocol_MsgTypeToString
     if _newclass:MsgTypeToString = staticmethod(_Communication.Protocol_MsgTypeToString)
@@ -673,6 +674,9 @@ SystemConnection_swigregister(SystemConnection)
 
 BINARY_ENCODING = _Communication.BINARY_ENCODING
 XML_ENCODING = _Communication.XML_ENCODING
+FAST_BINARY_ENCODING = _Communication.FAST_BINARY_ENCODING
+BEST_BINARY_ENCODING = _Communication.BEST_BINARY_ENCODING
+UNCOMPRESSED_BINARY_ENCODING = _Communication.UNCOMPRESSED_BINARY_ENCODING
 EMessageEncodingQuantity = _Communication.EMessageEncodingQuantity
 class EMessageEncodingNames(_object):
     __swig_setmethods__ = {}
@@ -14132,6 +14132,7 @@ SWIG_init(void) {
   SWIG_Python_SetConstant(d, "Protocol_CONTENT_UNCOMPRESSED_BSON",SWIG_From_int(static_cast< int >(Seiscomp::Communication::Protocol::CONTENT_UNCOMPRESSED_BSON)));
   SWIG_Python_SetConstant(d, "Protocol_CONTENT_JSON",SWIG_From_int(static_cast< int >(Seiscomp::Communication::Protocol::CONTENT_JSON)));
   SWIG_Python_SetConstant(d, "Protocol_CONTENT_UNCOMPRESSED_JSON",SWIG_From_int(static_cast< int >(Seiscomp::Communication::Protocol::CONTENT_UNCOMPRESSED_JSON)));
+  SWIG_Python_SetConstant(d, "Protocol_CONTENT_UNCOMPRESSED_BINARY",SWIG_From_int(static_cast< int >(Seiscomp::Communication::Protocol::CONTENT_UNCOMPRESSED_BINARY)));
   SWIG_Python_SetConstant(d, "Protocol_MCT_QUANTITY",SWIG_From_int(static_cast< int >(Seiscomp::Communication::Protocol::MCT_QUANTITY)));
   PyDict_SetItemString(md,(char*)"cvar", SWIG_globals());
   SWIG_addvarlink(SWIG_globals(),(char*)"Protocol_PROTOCOL_VERSION",Swig_var_Protocol_PROTOCOL_VERSION_get, Swig_var_Protocol_PROTOCOL_VERSION_set);
@@ -14156,6 +14157,9 @@ SWIG_init(void) {
   SWIG_Python_SetConstant(d, "SystemConnection_LM_QUANTITY",SWIG_From_int(static_cast< int >(Seiscomp::Communication::SystemConnection::LM_QUANTITY)));
   SWIG_Python_SetConstant(d, "BINARY_ENCODING",SWIG_From_int(static_cast< int >(Seiscomp::Communication::BINARY_ENCODING)));
   SWIG_Python_SetConstant(d, "XML_ENCODING",SWIG_From_int(static_cast< int >(Seiscomp::Communication::XML_ENCODING)));
+  SWIG_Python_SetConstant(d, "FAST_BINARY_ENCODING",SWIG_From_int(static_cast< int >(Seiscomp::Communication::FAST_BINARY_ENCODING)));
+  SWIG_Python_SetConstant(d, "BEST_BINARY_ENCODING",SWIG_From_int(static_cast< int >(Seiscomp::Communication::BEST_BINARY_ENCODING)));
+  SWIG_Python_SetConstant(d, "UNCOMPRESSED_BINARY_ENCODING",SWIG_From_int(static_cast< int >(Seiscomp::Communication::UNCOMPRESSED_BINARY_ENCODING)));
   SWIG_Python_SetConstant(d, "EMessageEncodingQuantity",SWIG_From_int(static_cast< int >(Seiscomp::Communication::EMessageEncodingQuantity)));
   SWIG_Python_SetConstant(d, "Connection_SKIP_UNKNOWN",SWIG_From_int(static_cast< int >(Seiscomp::Communication::Connection::SKIP_UNKNOWN)));
   SWIG_Python_SetConstant(d, "Connection_READ_ALL",SWIG_From_int(static_cast< int >(Seiscomp::Communication::Connection::READ_ALL)));
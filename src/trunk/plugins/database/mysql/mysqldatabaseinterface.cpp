@@ -16,11 +16,15 @@
 #include <seiscomp3/logging/log.h>
 #include <seiscomp3/core/plugin.h>
 #include <seiscomp3/core/system.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #if defined(WIN32)
 #include <errmsg.h>
+#include <mysqld_error.h>
 #else
 #include <mysql/errmsg.h>
+#include <mysql/mysqld_error.h>
 #endif
 
 
@@ -36,9 +40,578 @@ REGISTER_DB_INTERFACE(MySQLDatabase, "mysql");
 ADD_SC_PLUGIN("MySQL database driver", "GFZ Potsdam <seiscomp-devel@gfz-potsdam.de>", 0, 9, 2)
 
 
+MySQLStatement::MySQLStatement(MySQLDatabase *db, const char *statement)
+: _db(db), _statement(statement), _stmt(NULL) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+MySQLStatement::~MySQLStatement() {
+	if ( _db->_statementResult == this )
+		_db->endQuery();
+
+	if ( _stmt )
+		mysql_stmt_close(_stmt);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::prepare() {
+	if ( _stmt ) {
+		mysql_stmt_close(_stmt);
+		_stmt = NULL;
+	}
+
+	if ( _db->_handle == NULL ) return false;
+
+	_stmt = mysql_stmt_init(_db->_handle);
+	if ( _stmt == NULL ) {
+		SEISCOMP_ERROR("prepare(\"%s\"): out of memory", _statement.c_str());
+		return false;
+	}
+
+	if ( mysql_stmt_prepare(_stmt, _statement.c_str(), _statement.size()) ) {
+		SEISCOMP_ERROR("prepare(\"%s\") = %d (%s)", _statement.c_str(),
+		               mysql_stmt_errno(_stmt), mysql_stmt_error(_stmt));
+		mysql_stmt_close(_stmt);
+		_stmt = NULL;
+		return false;
+	}
+
+	// Keep the bindings when preparing again after a reconnect
+	size_t count = mysql_stmt_param_count(_stmt);
+	if ( _parameters.size() != count ) {
+		Parameter param;
+		param.type = MYSQL_TYPE_NULL;
+		param.intValue = 0;
+		param.doubleValue = 0;
+		param.length = 0;
+		memset(&param.timeValue, 0, sizeof(param.timeValue));
+
+		_parameters.assign(count, param);
+		_parameterBinds.resize(count);
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int MySQLStatement::parameterCount() const {
+	return (int)_parameters.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+MySQLStatement::Parameter *MySQLStatement::parameter(int index) {
+	if ( index < 0 || index >= (int)_parameters.size() ) {
+		SEISCOMP_ERROR("bind: invalid parameter index %d", index);
+		return NULL;
+	}
+
+	return &_parameters[index];
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::bindNull(int index) {
+	Parameter *param = parameter(index);
+	if ( param == NULL ) return false;
+	param->type = MYSQL_TYPE_NULL;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::bindInt(int index, long value) {
+	Parameter *param = parameter(index);
+	if ( param == NULL ) return false;
+	param->type = MYSQL_TYPE_LONGLONG;
+	param->intValue = value;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::bindDouble(int index, double value) {
+	Parameter *param = parameter(index);
+	if ( param == NULL ) return false;
+	param->type = MYSQL_TYPE_DOUBLE;
+	param->doubleValue = value;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::bindString(int index, const std::string &value) {
+	Parameter *param = parameter(index);
+	if ( param == NULL ) return false;
+	param->type = MYSQL_TYPE_STRING;
+	param->stringValue = value;
+	param->length = value.size();
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::bindTime(int index, const Seiscomp::Core::Time &value) {
+	Parameter *param = parameter(index);
+	if ( param == NULL ) return false;
+
+	int year, month, day, hour, min, sec;
+	value.get(&year, &month, &day, &hour, &min, &sec);
+
+	MYSQL_TIME &t = param->timeValue;
+	memset(&t, 0, sizeof(t));
+	t.year = year;
+	t.month = month;
+	t.day = day;
+	t.hour = hour;
+	t.minute = min;
+	t.second = sec;
+	// Fractional seconds are not passed like in timeToString. The
+	// server would round them when storing to a DATETIME column.
+	t.second_part = 0;
+	t.time_type = MYSQL_TIMESTAMP_DATETIME;
+
+	param->type = MYSQL_TYPE_DATETIME;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::run() {
+	if ( _stmt == NULL && !prepare() ) return false;
+
+	bool firstTry = true;
+
+	while ( true ) {
+		for ( size_t i = 0; i < _parameters.size(); ++i ) {
+			Parameter &param = _parameters[i];
+			MYSQL_BIND &bind = _parameterBinds[i];
+
+			memset(&bind, 0, sizeof(bind));
+			bind.buffer_type = param.type;
+
+			switch ( param.type ) {
+				case MYSQL_TYPE_LONGLONG:
+					bind.buffer = &param.intValue;
+					break;
+				case MYSQL_TYPE_DOUBLE:
+					bind.buffer = &param.doubleValue;
+					break;
+				case MYSQL_TYPE_STRING:
+					bind.buffer = const_cast<char*>(param.stringValue.data());
+					bind.buffer_length = param.length;
+					bind.length = &param.length;
+					break;
+				case MYSQL_TYPE_DATETIME:
+					bind.buffer = &param.timeValue;
+					break;
+				default:
+					break;
+			}
+		}
+
+		if ( _db->_debug )
+			SEISCOMP_DEBUG("[mysql-statement] %s", _statement.c_str());
+
+		if ( (_parameterBinds.empty() || !mysql_stmt_bind_param(_stmt, &_parameterBinds[0])) &&
+		     !mysql_stmt_execute(_stmt) )
+			return true;
+
+		unsigned int err = mysql_stmt_errno(_stmt);
+
+		// After a connection loss and an automatic reconnect the
+		// statement handle is invalid and must be prepared again
+		if ( firstTry && (err >= CR_UNKNOWN_ERROR || err == ER_UNKNOWN_STMT_HANDLER) ) {
+			SEISCOMP_WARNING("execute(\"%s\") = %d (%s) -> prepare again",
+			                 _statement.c_str(), err, mysql_stmt_error(_stmt));
+			firstTry = false;
+			if ( _db->ping() && prepare() ) continue;
+			return false;
+		}
+
+		SEISCOMP_ERROR("execute(\"%s\") = %d (%s)", _statement.c_str(),
+		               err, mysql_stmt_error(_stmt));
+		return false;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::execute() {
+	if ( _db->_result || _db->_statementResult ) {
+		SEISCOMP_ERROR("execute: statement cannot be executed while a query is active");
+		return false;
+	}
+
+	if ( !run() ) return false;
+
+	// Discard the result of a statement that returns rows
+	if ( mysql_stmt_field_count(_stmt) > 0 )
+		mysql_stmt_free_result(_stmt);
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::beginQuery() {
+	if ( _db->_result || _db->_statementResult ) {
+		SEISCOMP_ERROR("beginQuery: nested queries are not supported");
+		return false;
+	}
+
+	if ( !run() ) return false;
+
+	if ( !bindResult() ) {
+		mysql_stmt_free_result(_stmt);
+		return false;
+	}
+
+	_db->_statementResult = this;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::bindResult() {
+	MYSQL_RES *meta = mysql_stmt_result_metadata(_stmt);
+	if ( meta == NULL ) {
+		SEISCOMP_ERROR("beginQuery(\"%s\"): statement does not return rows",
+		               _statement.c_str());
+		return false;
+	}
+
+	unsigned int count = mysql_num_fields(meta);
+	MYSQL_FIELD *fields = mysql_fetch_fields(meta);
+
+	_columns.resize(count);
+	_resultBinds.resize(count);
+
+	for ( unsigned int i = 0; i < count; ++i ) {
+		Column &col = _columns[i];
+		MYSQL_BIND &bind = _resultBinds[i];
+
+		memset(&bind, 0, sizeof(bind));
+
+		col.name = fields[i].name;
+		col.isUnsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+		col.hasText = false;
+
+		switch ( fields[i].type ) {
+			case MYSQL_TYPE_TINY:
+			case MYSQL_TYPE_SHORT:
+			case MYSQL_TYPE_LONG:
+			case MYSQL_TYPE_INT24:
+			case MYSQL_TYPE_LONGLONG:
+			case MYSQL_TYPE_YEAR:
+				col.type = MYSQL_TYPE_LONGLONG;
+				bind.buffer = &col.intValue;
+				bind.is_unsigned = col.isUnsigned;
+				break;
+			case MYSQL_TYPE_FLOAT:
+			case MYSQL_TYPE_DOUBLE:
+				col.type = MYSQL_TYPE_DOUBLE;
+				bind.buffer = &col.doubleValue;
+				break;
+			case MYSQL_TYPE_DATE:
+			case MYSQL_TYPE_DATETIME:
+			case MYSQL_TYPE_TIMESTAMP:
+				col.type = MYSQL_TYPE_DATETIME;
+				bind.buffer = &col.timeValue;
+				break;
+			default:
+			{
+				// Start with a small buffer, fetch grows it if needed
+				size_t size = (fields[i].length < 255 ? fields[i].length : 255) + 1;
+				if ( col.buffer.size() < size )
+					col.buffer.resize(size);
+				col.type = MYSQL_TYPE_STRING;
+				bind.buffer = &col.buffer[0];
+				bind.buffer_length = col.buffer.size()-1;
+				break;
+			}
+		}
+
+		bind.buffer_type = col.type;
+		bind.length = &col.length;
+		bind.is_null = &col.isNull;
+		bind.error = &col.error;
+	}
+
+	mysql_free_result(meta);
+
+	if ( count > 0 && mysql_stmt_bind_result(_stmt, &_resultBinds[0]) ) {
+		SEISCOMP_ERROR("beginQuery(\"%s\") = %d (%s)", _statement.c_str(),
+		               mysql_stmt_errno(_stmt), mysql_stmt_error(_stmt));
+		return false;
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MySQLStatement::freeResult() {
+	// Also discards unfetched rows
+	mysql_stmt_free_result(_stmt);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::fetch() {
+	int res = mysql_stmt_fetch(_stmt);
+	if ( res == MYSQL_NO_DATA ) return false;
+	if ( res == 1 ) {
+		SEISCOMP_ERROR("fetch(\"%s\") = %d (%s)", _statement.c_str(),
+		               mysql_stmt_errno(_stmt), mysql_stmt_error(_stmt));
+		return false;
+	}
+
+	bool rebind = false;
+
+	for ( size_t i = 0; i < _columns.size(); ++i ) {
+		Column &col = _columns[i];
+		col.hasText = false;
+
+		if ( col.type != MYSQL_TYPE_STRING || col.isNull ) continue;
+
+		// Truncated, fetch the column again with a buffer that is
+		// large enough and keep that buffer for the following rows
+		if ( col.length >= col.buffer.size() ) {
+			MYSQL_BIND &bind = _resultBinds[i];
+			col.buffer.resize(col.length+1);
+			bind.buffer = &col.buffer[0];
+			bind.buffer_length = col.buffer.size()-1;
+			mysql_stmt_fetch_column(_stmt, &bind, (unsigned int)i, 0);
+			rebind = true;
+		}
+
+		col.buffer[col.length] = '\0';
+	}
+
+	if ( rebind )
+		mysql_stmt_bind_result(_stmt, &_resultBinds[0]);
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int MySQLStatement::findColumn(const char *name) const {
+	for ( size_t i = 0; i < _columns.size(); ++i )
+		if ( _columns[i].name == name )
+			return (int)i;
+
+	return -1;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int MySQLStatement::fieldCount() const {
+	return (int)_columns.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const char *MySQLStatement::fieldName(int index) const {
+	return _columns[index].name.c_str();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const void *MySQLStatement::field(int index) {
+	Column &col = _columns[index];
+	if ( col.isNull ) return NULL;
+	if ( col.type == MYSQL_TYPE_STRING ) return &col.buffer[0];
+
+	// Render the binary value the same way the server does in the
+	// text protocol
+	if ( !col.hasText ) {
+		char buf[64];
+		switch ( col.type ) {
+			case MYSQL_TYPE_LONGLONG:
+				if ( col.isUnsigned )
+					snprintf(buf, sizeof(buf), "%llu", (unsigned long long)col.intValue);
+				else
+					snprintf(buf, sizeof(buf), "%lld", col.intValue);
+				break;
+			case MYSQL_TYPE_DOUBLE:
+				snprintf(buf, sizeof(buf), "%.17g", col.doubleValue);
+				break;
+			default:
+				snprintf(buf, sizeof(buf), "%04u-%02u-%02u %02u:%02u:%02u",
+				         col.timeValue.year, col.timeValue.month, col.timeValue.day,
+				         col.timeValue.hour, col.timeValue.minute, col.timeValue.second);
+				break;
+		}
+
+		col.text = buf;
+		col.hasText = true;
+	}
+
+	return col.text.c_str();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t MySQLStatement::fieldSize(int index) {
+	Column &col = _columns[index];
+	if ( col.isNull ) return 0;
+	if ( col.type == MYSQL_TYPE_STRING ) return col.length;
+	field(index);
+	return col.text.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::fieldInt(int index, long &value) {
+	Column &col = _columns[index];
+	if ( col.isNull ) return false;
+
+	switch ( col.type ) {
+		case MYSQL_TYPE_LONGLONG:
+			value = (long)col.intValue;
+			return true;
+		case MYSQL_TYPE_DOUBLE:
+			value = (long)col.doubleValue;
+			return true;
+		case MYSQL_TYPE_STRING:
+		{
+			char *end;
+			value = strtol(&col.buffer[0], &end, 10);
+			return end != &col.buffer[0] && *end == '\0';
+		}
+		default:
+			return false;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::fieldDouble(int index, double &value) {
+	Column &col = _columns[index];
+	if ( col.isNull ) return false;
+
+	switch ( col.type ) {
+		case MYSQL_TYPE_LONGLONG:
+			value = col.isUnsigned ? (double)(unsigned long long)col.intValue : (double)col.intValue;
+			return true;
+		case MYSQL_TYPE_DOUBLE:
+			value = col.doubleValue;
+			return true;
+		case MYSQL_TYPE_STRING:
+		{
+			char *end;
+			value = strtod(&col.buffer[0], &end);
+			return end != &col.buffer[0] && *end == '\0';
+		}
+		default:
+			return false;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLStatement::fieldTime(int index, Seiscomp::Core::Time &value) {
+	Column &col = _columns[index];
+	if ( col.isNull ) return false;
+
+	switch ( col.type ) {
+		case MYSQL_TYPE_DATETIME:
+		{
+			const MYSQL_TIME &t = col.timeValue;
+			if ( t.year == 0 ) return false;
+			value.set(t.year, t.month, t.day, t.hour, t.minute, t.second,
+			          (int)t.second_part);
+			return true;
+		}
+		case MYSQL_TYPE_STRING:
+			value = _db->stringToTime(&col.buffer[0]);
+			return value.valid();
+		default:
+			return false;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 MySQLDatabase::MySQLDatabase()
 	: _handle(NULL), _result(NULL), _row(NULL), _debug(false)
-	, _fieldCount(0), _lengths(NULL)  {}
+	, _fieldCount(0), _lengths(NULL), _statementResult(NULL)  {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -135,6 +708,10 @@ bool MySQLDatabase::connect(const char *con) {
 void MySQLDatabase::disconnect() {
 	if ( _handle ) {
 		SEISCOMP_INFO("Disconnecting from database");
+		if ( _statementResult ) {
+			_statementResult->freeResult();
+			_statementResult = NULL;
+		}
 		if ( _result ) {
 			mysql_free_result(_result);
 			_result = NULL;
@@ -292,7 +869,7 @@ bool MySQLDatabase::execute(const char* command) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool MySQLDatabase::beginQuery(const char* q) {
-	if ( _result ) {
+	if ( _result || _statementResult ) {
 		SEISCOMP_ERROR("beginQuery: nested queries are not supported");
 		//SEISCOMP_DEBUG("last successfull query: %s", _lastQuery.c_str());
 		return false;
@@ -317,6 +894,11 @@ bool MySQLDatabase::beginQuery(const char* q) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void MySQLDatabase::endQuery() {
+	if ( _statementResult ) {
+		_statementResult->freeResult();
+		_statementResult = NULL;
+	}
+
 	if ( _result ) {
 		mysql_free_result(_result);
 		_result = NULL;
@@ -328,6 +910,23 @@ void MySQLDatabase::endQuery() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Seiscomp::IO::DatabaseStatement *MySQLDatabase::prepare(const char *statement) {
+	if ( _handle == NULL || statement == NULL ) return NULL;
+
+	MySQLStatement *stmt = new MySQLStatement(this, statement);
+	if ( !stmt->prepare() ) {
+		delete stmt;
+		return NULL;
+	}
+
+	return stmt;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 unsigned long MySQLDatabase::lastInsertId(const char*) {
 	return (unsigned long)mysql_insert_id(_handle);
@@ -339,6 +938,8 @@ unsigned long MySQLDatabase::lastInsertId(const char*) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool MySQLDatabase::fetchRow() {
+	if ( _statementResult ) return _statementResult->fetch();
+
 	_row = mysql_fetch_row(_result);
 	_lengths = mysql_fetch_lengths(_result);
 	return _row != NULL;
@@ -350,6 +951,8 @@ bool MySQLDatabase::fetchRow() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 int MySQLDatabase::findColumn(const char* name) {
+	if ( _statementResult ) return _statementResult->findColumn(name);
+
 	MYSQL_FIELD* field;
 	for ( int i = 0; i < _fieldCount; ++i ) {
 		field = mysql_fetch_field_direct(_result, i);
@@ -366,6 +969,7 @@ int MySQLDatabase::findColumn(const char* name) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 int MySQLDatabase::getRowFieldCount() const {
+	if ( _statementResult ) return _statementResult->fieldCount();
 	return _fieldCount;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -375,6 +979,8 @@ int MySQLDatabase::getRowFieldCount() const {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 const char *MySQLDatabase::getRowFieldName(int index) {
+	if ( _statementResult ) return _statementResult->fieldName(index);
+
 	MYSQL_FIELD* field = mysql_fetch_field_direct(_result, index);
 	return field != NULL ? field->name : NULL;
 }
@@ -385,6 +991,7 @@ const char *MySQLDatabase::getRowFieldName(int index) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 const void* MySQLDatabase::getRowField(int index) {
+	if ( _statementResult ) return _statementResult->field(index);
 	return _row[index];
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -394,6 +1001,7 @@ const void* MySQLDatabase::getRowField(int index) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 size_t MySQLDatabase::getRowFieldSize(int index) {
+	if ( _statementResult ) return _statementResult->fieldSize(index);
 	return _lengths[index];
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -401,6 +1009,36 @@ size_t MySQLDatabase::getRowFieldSize(int index) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLDatabase::getRowFieldInt(int index, long &value) {
+	if ( _statementResult ) return _statementResult->fieldInt(index, value);
+	return DatabaseInterface::getRowFieldInt(index, value);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLDatabase::getRowFieldDouble(int index, double &value) {
+	if ( _statementResult ) return _statementResult->fieldDouble(index, value);
+	return DatabaseInterface::getRowFieldDouble(index, value);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MySQLDatabase::getRowFieldTime(int index, Seiscomp::Core::Time &value) {
+	if ( _statementResult ) return _statementResult->fieldTime(index, value);
+	return DatabaseInterface::getRowFieldTime(index, value);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 }
 }
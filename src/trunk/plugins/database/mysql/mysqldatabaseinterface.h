@@ -21,12 +21,106 @@
 #else
 #include <mysql/mysql.h>
 #endif
+#include <vector>
 
 
 namespace Seiscomp {
 namespace Database {
 
 
+class MySQLDatabase;
+
+
+class MySQLStatement : public Seiscomp::IO::DatabaseStatement {
+	// ------------------------------------------------------------------
+	//  Xstruction
+	// ------------------------------------------------------------------
+	public:
+		MySQLStatement(MySQLDatabase *db, const char *statement);
+		~MySQLStatement();
+
+
+	// ------------------------------------------------------------------
+	//  Public interface
+	// ------------------------------------------------------------------
+	public:
+		//! Prepares the statement on the server
+		bool prepare();
+
+		int parameterCount() const;
+
+		bool bindNull(int index);
+		bool bindInt(int index, long value);
+		bool bindDouble(int index, double value);
+		bool bindString(int index, const std::string &value);
+		bool bindTime(int index, const Seiscomp::Core::Time &value);
+
+		bool execute();
+		bool beginQuery();
+
+
+	// ------------------------------------------------------------------
+	//  Implementation
+	// ------------------------------------------------------------------
+	private:
+		struct Parameter {
+			enum_field_types type;
+			long long        intValue;
+			double           doubleValue;
+			std::string      stringValue;
+			unsigned long    length;
+			MYSQL_TIME       timeValue;
+		};
+
+		// Result columns are fetched in binary form. Integers, floating
+		// point values and times are stored natively, everything else
+		// as string.
+		struct Column {
+			enum_field_types type;
+			std::string      name;
+			bool             isUnsigned;
+			long long        intValue;
+			double           doubleValue;
+			MYSQL_TIME       timeValue;
+			std::vector<char> buffer;
+			unsigned long    length;
+			my_bool          isNull;
+			my_bool          error;
+			// Text representation of a non string column, created
+			// on demand by field()
+			std::string      text;
+			bool             hasText;
+		};
+
+		Parameter *parameter(int index);
+		bool run();
+		bool bindResult();
+		void freeResult();
+
+		bool fetch();
+		int findColumn(const char *name) const;
+		int fieldCount() const;
+		const char *fieldName(int index) const;
+		const void *field(int index);
+		size_t fieldSize(int index);
+		bool fieldInt(int index, long &value);
+		bool fieldDouble(int index, double &value);
+		bool fieldTime(int index, Seiscomp::Core::Time &value);
+
+
+	private:
+		MySQLDatabase          *_db;
+		std::string             _statement;
+		MYSQL_STMT             *_stmt;
+		std::vector<Parameter>  _parameters;
+		std::vector<MYSQL_BIND> _parameterBinds;
+		std::vector<Column>     _columns;
+		std::vector<MYSQL_BIND> _resultBinds;
+
+	friend class MySQLDatabase;
+};
+
+
 class MySQLDatabase : public Seiscomp::IO::DatabaseInterface {
 	DECLARE_SC_CLASS(MySQLDatabase);
 
@@ -55,6 +149,8 @@ class MySQLDatabase : public Seiscomp::IO::DatabaseInterface {
 		bool beginQuery(const char* query);
 		void endQuery();
 
+		Seiscomp::IO::DatabaseStatement *prepare(const char *statement);
+
 		unsigned long lastInsertId(const char*);
 
 		bool fetchRow();
@@ -64,6 +160,10 @@ class MySQLDatabase : public Seiscomp::IO::DatabaseInterface {
 		const void* getRowField(int index);
 		size_t getRowFieldSize(int index);
 
+		bool getRowFieldInt(int index, long &value);
+		bool getRowFieldDouble(int index, double &value);
+		bool getRowFieldTime(int index, Seiscomp::Core::Time &value);
+
 
 	// ------------------------------------------------------------------
 	//  Protected interface
@@ -92,6 +192,10 @@ class MySQLDatabase : public Seiscomp::IO::DatabaseInterface {
 		//std::string _lastQuery;
 		mutable int            _fieldCount;
 		mutable unsigned long *_lengths;
+		// The prepared statement whose result is currently fetched
+		MySQLStatement        *_statementResult;
+
+	friend class MySQLStatement;
 };
 
 
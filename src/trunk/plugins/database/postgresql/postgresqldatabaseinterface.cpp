@@ -16,6 +16,8 @@
 #include <seiscomp3/core/plugin.h>
 #include "postgresqldatabaseinterface.h"
 
+#include <stdio.h>
+
 
 namespace Seiscomp {
 namespace Database {
@@ -28,8 +30,241 @@ IMPLEMENT_SC_CLASS_DERIVED(PostgreSQLDatabase,
 REGISTER_DB_INTERFACE(PostgreSQLDatabase, "postgresql");
 ADD_SC_PLUGIN("PostgreSQL database driver", "GFZ Potsdam <seiscomp-devel@gfz-potsdam.de>", 0, 9, 1)
 
+PostgreSQLStatement::PostgreSQLStatement(PostgreSQLDatabase *db,
+                                         const char *statement)
+: _db(db), _generation(0) {
+	std::stringstream ss;
+	ss << "sc_stmt_" << ++_db->_statementCount;
+	_name = ss.str();
+
+	// Replace the '?' placeholders outside of string literals
+	// with $1, $2, ...
+	bool quoted = false;
+	int count = 0;
+	for ( const char *c = statement; *c != '\0'; ++c ) {
+		if ( *c == '\'' )
+			quoted = !quoted;
+		else if ( *c == '?' && !quoted ) {
+			std::stringstream ss;
+			ss << '$' << ++count;
+			_statement += ss.str();
+			continue;
+		}
+
+		_statement += *c;
+	}
+
+	_values.resize(count);
+	_nulls.resize(count, 1);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+PostgreSQLStatement::~PostgreSQLStatement() {
+	if ( _db->_handle == NULL || _generation != _db->_generation ) return;
+
+	PGresult *result = PQexec(_db->_handle, ("deallocate " + _name).c_str());
+	if ( result ) PQclear(result);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::prepare() {
+	PGresult *result = PQprepare(_db->_handle, _name.c_str(), _statement.c_str(), 0, NULL);
+	if ( result == NULL ) {
+		SEISCOMP_ERROR("prepare(\"%s\"): %s", _statement.c_str(), PQerrorMessage(_db->_handle));
+		return false;
+	}
+
+	bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+	if ( !ok ) {
+		SEISCOMP_ERROR("PREPARE failed");
+		SEISCOMP_ERROR("  %s", _statement.c_str());
+		SEISCOMP_ERROR("  %s", PQerrorMessage(_db->_handle));
+	}
+	else
+		_generation = _db->_generation;
+
+	PQclear(result);
+	return ok;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int PostgreSQLStatement::parameterCount() const {
+	return (int)_values.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::bind(int index, const std::string &value) {
+	if ( index < 0 || index >= (int)_values.size() ) {
+		SEISCOMP_ERROR("bind: invalid parameter index %d", index);
+		return false;
+	}
+
+	_values[index] = value;
+	_nulls[index] = 0;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::bindNull(int index) {
+	if ( index < 0 || index >= (int)_values.size() ) {
+		SEISCOMP_ERROR("bind: invalid parameter index %d", index);
+		return false;
+	}
+
+	_nulls[index] = 1;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::bindInt(int index, long value) {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%ld", value);
+	return bind(index, buf);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::bindDouble(int index, double value) {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.17g", value);
+	return bind(index, buf);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::bindString(int index, const std::string &value) {
+	return bind(index, value);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::bindTime(int index, const Seiscomp::Core::Time &value) {
+	return bind(index, _db->timeToString(value));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+PGresult *PostgreSQLStatement::exec() {
+	if ( !_db->isConnected() ) return NULL;
+
+	// The session has been reset since the statement was prepared
+	if ( _generation != _db->_generation && !prepare() )
+		return NULL;
+
+	std::vector<const char*> values(_values.size());
+	for ( size_t i = 0; i < _values.size(); ++i )
+		values[i] = _nulls[i] ? NULL : _values[i].c_str();
+
+	PGresult *result = PQexecPrepared(_db->_handle, _name.c_str(), (int)values.size(),
+	                                  values.empty() ? NULL : &values[0],
+	                                  NULL, NULL, 0);
+
+	// The connection has been lost while executing: reset it, prepare the
+	// statement in the new session and try once more
+	if ( PQstatus(_db->_handle) != CONNECTION_OK ) {
+		if ( result != NULL ) PQclear(result);
+		result = NULL;
+
+		if ( _db->isConnected() && prepare() )
+			result = PQexecPrepared(_db->_handle, _name.c_str(), (int)values.size(),
+			                        values.empty() ? NULL : &values[0],
+			                        NULL, NULL, 0);
+	}
+
+	if ( result == NULL ) {
+		SEISCOMP_ERROR("execute(\"%s\"): %s", _statement.c_str(), PQerrorMessage(_db->_handle));
+		return NULL;
+	}
+
+	ExecStatusType stat = PQresultStatus(result);
+	if ( stat != PGRES_TUPLES_OK && stat != PGRES_COMMAND_OK ) {
+		SEISCOMP_ERROR("QUERY/COMMAND failed");
+		SEISCOMP_ERROR("  %s", _statement.c_str());
+		SEISCOMP_ERROR("  %s", PQerrorMessage(_db->_handle));
+		PQclear(result);
+		return NULL;
+	}
+
+	return result;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::execute() {
+	PGresult *result = exec();
+	if ( result == NULL ) return false;
+	PQclear(result);
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool PostgreSQLStatement::beginQuery() {
+	if ( _db->_result ) {
+		SEISCOMP_ERROR("beginQuery: nested queries are not supported");
+		return false;
+	}
+
+	PGresult *result = exec();
+	if ( result == NULL ) return false;
+
+	_db->_result = result;
+	_db->_row = -1;
+	_db->_nRows = PQntuples(result);
+	_db->_fieldCount = PQnfields(result);
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 PostgreSQLDatabase::PostgreSQLDatabase()
- : _handle(NULL), _result(NULL) {}
+ : _handle(NULL), _result(NULL), _generation(0), _statementCount(0) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -66,6 +301,8 @@ bool PostgreSQLDatabase::open() {
 		return false;
 	}
 
+	++_generation;
+
 	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -111,6 +348,7 @@ bool PostgreSQLDatabase::isConnected() const {
 
 	SEISCOMP_ERROR("connection bad (%d) -> reconnect", stat);
 	PQreset(_handle);
+	++_generation;
 	return PQstatus(_handle) == CONNECTION_OK;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -224,6 +462,23 @@ void PostgreSQLDatabase::endQuery() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Seiscomp::IO::DatabaseStatement *PostgreSQLDatabase::prepare(const char *statement) {
+	if ( !isConnected() || statement == NULL ) return NULL;
+
+	PostgreSQLStatement *stmt = new PostgreSQLStatement(this, statement);
+	if ( !stmt->prepare() ) {
+		delete stmt;
+		return NULL;
+	}
+
+	return stmt;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 unsigned long PostgreSQLDatabase::lastInsertId(const char* table) {
 	if ( !beginQuery((std::string("select currval('") + table + "_seq')").c_str()) )
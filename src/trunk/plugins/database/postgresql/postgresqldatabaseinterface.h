@@ -16,12 +16,62 @@
 
 #include <seiscomp3/io/database.h>
 #include <libpq-fe.h>
+#include <vector>
 
 
 namespace Seiscomp {
 namespace Database {
 
 
+class PostgreSQLDatabase;
+
+
+class PostgreSQLStatement : public Seiscomp::IO::DatabaseStatement {
+	// ------------------------------------------------------------------
+	//  Xstruction
+	// ------------------------------------------------------------------
+	public:
+		PostgreSQLStatement(PostgreSQLDatabase *db, const char *statement);
+		~PostgreSQLStatement();
+
+
+	// ------------------------------------------------------------------
+	//  Public interface
+	// ------------------------------------------------------------------
+	public:
+		//! Prepares the statement on the server
+		bool prepare();
+
+		int parameterCount() const;
+
+		bool bindNull(int index);
+		bool bindInt(int index, long value);
+		bool bindDouble(int index, double value);
+		bool bindString(int index, const std::string &value);
+		bool bindTime(int index, const Seiscomp::Core::Time &value);
+
+		bool execute();
+		bool beginQuery();
+
+
+	// ------------------------------------------------------------------
+	//  Implementation
+	// ------------------------------------------------------------------
+	private:
+		bool bind(int index, const std::string &value);
+		PGresult *exec();
+
+
+	private:
+		PostgreSQLDatabase       *_db;
+		std::string               _name;
+		std::string               _statement;
+		std::vector<std::string>  _values;
+		std::vector<char>         _nulls;
+		unsigned int              _generation;
+};
+
+
 class PostgreSQLDatabase : public Seiscomp::IO::DatabaseInterface {
 	DECLARE_SC_CLASS(PostgreSQLDatabase);
 
@@ -50,6 +100,8 @@ class PostgreSQLDatabase : public Seiscomp::IO::DatabaseInterface {
 		bool beginQuery(const char* query);
 		void endQuery();
 
+		Seiscomp::IO::DatabaseStatement *prepare(const char *statement);
+
 		unsigned long lastInsertId(const char* table);
 
 		bool fetchRow();
@@ -76,6 +128,13 @@ class PostgreSQLDatabase : public Seiscomp::IO::DatabaseInterface {
 		int _row;
 		int _nRows;
 		int _fieldCount;
+		// Server side prepared statements are bound to a session and
+		// are lost when the connection is reset. The generation is
+		// incremented with each new session.
+		mutable unsigned int _generation;
+		unsigned int _statementCount;
+
+	friend class PostgreSQLStatement;
 };
 
 
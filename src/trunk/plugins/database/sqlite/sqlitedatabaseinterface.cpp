@@ -31,8 +31,141 @@ IMPLEMENT_SC_CLASS_DERIVED(SQLiteDatabase,
 REGISTER_DB_INTERFACE(SQLiteDatabase, "sqlite3");
 ADD_SC_PLUGIN("SQLite3 database driver", "GFZ Potsdam <seiscomp-devel@gfz-potsdam.de>", 0, 9, 0)
 
+SQLiteStatement::SQLiteStatement(SQLiteDatabase *db, sqlite3_stmt *stmt)
+: _db(db), _stmt(stmt) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+SQLiteStatement::~SQLiteStatement() {
+	if ( _db->_stmt == _stmt )
+		_db->endQuery();
+
+	sqlite3_finalize(_stmt);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int SQLiteStatement::parameterCount() const {
+	return sqlite3_bind_parameter_count(_stmt);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteStatement::checkBind(int res, int index) const {
+	if ( res == SQLITE_OK ) return true;
+	SEISCOMP_ERROR("sqlite3 bind parameter %d: %s", index,
+	               sqlite3_errmsg(_db->_handle));
+	return false;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteStatement::bindNull(int index) {
+	return checkBind(sqlite3_bind_null(_stmt, index+1), index);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteStatement::bindInt(int index, long value) {
+	return checkBind(sqlite3_bind_int64(_stmt, index+1, value), index);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteStatement::bindDouble(int index, double value) {
+	return checkBind(sqlite3_bind_double(_stmt, index+1, value), index);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteStatement::bindString(int index, const std::string &value) {
+	return checkBind(sqlite3_bind_text(_stmt, index+1, value.data(), (int)value.size(),
+	                                   SQLITE_TRANSIENT), index);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteStatement::bindTime(int index, const Seiscomp::Core::Time &value) {
+	// Times are stored as text
+	return bindString(index, _db->timeToString(value));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteStatement::execute() {
+	if ( _db->_stmt != NULL ) {
+		SEISCOMP_ERROR("execute: statement cannot be executed while a query is active");
+		return false;
+	}
+
+	sqlite3_reset(_stmt);
+
+	int res;
+	while ( (res = sqlite3_step(_stmt)) == SQLITE_ROW );
+
+	if ( res != SQLITE_DONE )
+		SEISCOMP_ERROR("sqlite3 execute: %s", sqlite3_errmsg(_db->_handle));
+
+	// Release the locks held by the statement
+	sqlite3_reset(_stmt);
+
+	return res == SQLITE_DONE;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteStatement::beginQuery() {
+	if ( _db->_stmt != NULL ) {
+		SEISCOMP_ERROR("beginQuery: nested queries are not supported");
+		return false;
+	}
+
+	sqlite3_reset(_stmt);
+
+	_db->_stmt = _stmt;
+	_db->_preparedStmt = true;
+	_db->_columnCount = sqlite3_column_count(_stmt);
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 SQLiteDatabase::SQLiteDatabase()
-: _handle(NULL), _stmt(NULL), _columnCount(0) {}
+: _handle(NULL), _stmt(NULL), _preparedStmt(false), _columnCount(0) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -179,8 +312,12 @@ bool SQLiteDatabase::beginQuery(const char* query) {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void SQLiteDatabase::endQuery() {
 	if ( _stmt ) {
-		sqlite3_finalize(_stmt);
+		if ( _preparedStmt )
+			sqlite3_reset(_stmt);
+		else
+			sqlite3_finalize(_stmt);
 		_stmt = NULL;
+		_preparedStmt = false;
 		_columnCount = 0;
 	}
 }
@@ -189,6 +326,25 @@ void SQLiteDatabase::endQuery() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Seiscomp::IO::DatabaseStatement *SQLiteDatabase::prepare(const char *statement) {
+	if ( !isConnected() || statement == NULL ) return NULL;
+
+	sqlite3_stmt *stmt = NULL;
+	int res = sqlite3_prepare_v2(_handle, statement, -1, &stmt, NULL);
+	if ( res != SQLITE_OK || stmt == NULL ) {
+		SEISCOMP_ERROR("sqlite3 prepare(\"%s\"): %s", statement, sqlite3_errmsg(_handle));
+		if ( stmt != NULL ) sqlite3_finalize(stmt);
+		return NULL;
+	}
+
+	return new SQLiteStatement(this, stmt);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 const char* SQLiteDatabase::defaultValue() const {
 	return "null";
@@ -265,6 +421,44 @@ size_t SQLiteDatabase::getRowFieldSize(int index) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteDatabase::getRowFieldInt(int index, long &value) {
+	switch ( sqlite3_column_type(_stmt, index) ) {
+		case SQLITE_NULL:
+			return false;
+		case SQLITE_INTEGER:
+			value = (long)sqlite3_column_int64(_stmt, index);
+			return true;
+		case SQLITE_FLOAT:
+			value = (long)sqlite3_column_double(_stmt, index);
+			return true;
+		default:
+			return DatabaseInterface::getRowFieldInt(index, value);
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SQLiteDatabase::getRowFieldDouble(int index, double &value) {
+	switch ( sqlite3_column_type(_stmt, index) ) {
+		case SQLITE_NULL:
+			return false;
+		case SQLITE_INTEGER:
+		case SQLITE_FLOAT:
+			value = sqlite3_column_double(_stmt, index);
+			return true;
+		default:
+			return DatabaseInterface::getRowFieldDouble(index, value);
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 }
 }
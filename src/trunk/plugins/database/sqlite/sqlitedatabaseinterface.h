@@ -22,6 +22,47 @@ namespace Seiscomp {
 namespace Database {
 
 
+class SQLiteDatabase;
+
+
+class SQLiteStatement : public Seiscomp::IO::DatabaseStatement {
+	// ------------------------------------------------------------------
+	//  Xstruction
+	// ------------------------------------------------------------------
+	public:
+		SQLiteStatement(SQLiteDatabase *db, sqlite3_stmt *stmt);
+		~SQLiteStatement();
+
+
+	// ------------------------------------------------------------------
+	//  Public interface
+	// ------------------------------------------------------------------
+	public:
+		int parameterCount() const;
+
+		bool bindNull(int index);
+		bool bindInt(int index, long value);
+		bool bindDouble(int index, double value);
+		bool bindString(int index, const std::string &value);
+		bool bindTime(int index, const Seiscomp::Core::Time &value);
+
+		bool execute();
+		bool beginQuery();
+
+
+	// ------------------------------------------------------------------
+	//  Implementation
+	// ------------------------------------------------------------------
+	private:
+		bool checkBind(int res, int index) const;
+
+
+	private:
+		SQLiteDatabase *_db;
+		sqlite3_stmt   *_stmt;
+};
+
+
 class SQLiteDatabase : public Seiscomp::IO::DatabaseInterface {
 	DECLARE_SC_CLASS(SQLiteDatabase);
 
@@ -50,6 +91,8 @@ class SQLiteDatabase : public Seiscomp::IO::DatabaseInterface {
 		bool beginQuery(const char* query);
 		void endQuery();
 
+		Seiscomp::IO::DatabaseStatement *prepare(const char *statement);
+
 		const char* defaultValue() const;
 		unsigned long lastInsertId(const char*);
 
@@ -60,6 +103,9 @@ class SQLiteDatabase : public Seiscomp::IO::DatabaseInterface {
 		const void* getRowField(int index);
 		size_t getRowFieldSize(int index);
 
+		bool getRowFieldInt(int index, long &value);
+		bool getRowFieldDouble(int index, double &value);
+
 
 	// ------------------------------------------------------------------
 	//  Protected interface
@@ -74,7 +120,12 @@ class SQLiteDatabase : public Seiscomp::IO::DatabaseInterface {
 	private:
 		sqlite3* _handle;
 		sqlite3_stmt* _stmt;
+		// Whether _stmt belongs to a prepared statement and must
+		// be reset instead of finalized by endQuery
+		bool _preparedStmt;
 		int _columnCount;
+
+	friend class SQLiteStatement;
 };
 
 